@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Devices {
+// Правила оповещений над потоком замеров. Правило - одна строка:
+//
+//   [имя:] выражение сравнение порог[%] [for длительность]
+//
+// выражение - метрика или функция от неё: rate(m), ewma(m, 30s),
+// min(m, 5m), max(m, 5m). Примеры: "cpu_busy: cpu > 90 for 30s",
+// "mem_available < 5%", "rate(temperature) > 2".
+//
+// Состояние каждого правила фиксированного размера (скользящие min/max -
+// 8 корзин окна), замер проверяет только правила своей метрики, поэтому
+// тысячи правил обходятся в микросекунды без аллокаций.
+class AlertEngine {
+public:
+  enum class Aggregate : uint8_t { Value, Rate, Ewma, Min, Max };
+  enum class Comparison : uint8_t { Greater, GreaterEqual, Less, LessEqual };
+
+  struct Event {
+    uint32_t rule;
+    bool firing; // false - условие снова не выполняется
+    uint64_t timeNs;
+    double value;
+  };
+  using Listener = std::function<void(const Event &)>;
+
+  static constexpr size_t eventCapacity = 1024;
+  static constexpr size_t windowBuckets = 8;
+
+  AlertEngine();
+
+  // Метрики регистрирует поставщик замеров; индекс передаётся в Sample.
+  uint32_t RegisterMetric(std::string_view name);
+  size_t GetMetricCount() const;
+
+  // false и описание ошибки в error, если строку не удалось разобрать.
+  bool AddRule(std::string_view text, std::string &error);
+  // Файл правил: строка на правило, '#' - комментарий. Ошибки пишутся
+  // в errors с номером строки, остальные правила загружаются.
+  size_t LoadRules(const char *path, std::ostream &errors);
+  void ClearRules();
+
+  void Sample(uint32_t metric, uint64_t timeNs, double value);
+
+  size_t GetRuleCount() const;
+  const std::string &GetRuleName(uint32_t rule) const;
+  const std::string &GetRuleText(uint32_t rule) const;
+  bool IsFiring(uint32_t rule) const;
+  // Последнее вычисленное значение выражения правила.
+  double GetValue(uint32_t rule) const;
+  size_t GetFiringCount() const;
+
+  // Порядковый номер следующего события; события хранятся в кольце,
+  // EventsSince отдаёт ещё не вытесненные события начиная с sequence.
+  uint64_t GetEventSequence() const;
+  void EventsSince(uint64_t sequence, std::vector<Event> &out) const;
+
+  // Слушатели вызываются синхронно в потоке, подающем замеры.
+  size_t Subscribe(Listener listener);
+  void Unsubscribe(size_t id);
+  // Журнал срабатываний; nullptr - не писать.
+  void SetLog(std::ostream *log);
+
+private:
+  struct Rule {
+    std::string name;
+    std::string text;
+    uint32_t metric;
+    Aggregate aggregate;
+    Comparison comparison;
+    double threshold;
+    uint64_t forNs;
+    uint64_t windowNs;
+
+    double value;
+    double previous;
+    uint64_t previousNs;
+    bool hasValue;
+    bool hasPrevious;
+    bool pending;
+    bool firing;
+    uint64_t trueSinceNs;
+    std::array<float, windowBuckets> bucketMin;
+    std::array<float, windowBuckets> bucketMax;
+    std::array<uint64_t, windowBuckets> bucketEpoch;
+  };
+
+  std::vector<std::string> metrics;
+  std::vector<Rule> rules;
+  // Правила по метрикам: Sample обходит только свой список.
+  std::vector<std::vector<uint32_t>> rulesByMetric;
+  std::vector<Event> events;
+  uint64_t eventSequence;
+  size_t firingCount;
+  std::vector<std::pair<size_t, Listener>> listeners;
+  size_t nextListener;
+  std::ostream *log;
+
+  bool Evaluate(Rule &rule, uint64_t timeNs, double sample);
+  void Emit(uint32_t rule, bool firing, uint64_t timeNs);
+};
+} // namespace Devices
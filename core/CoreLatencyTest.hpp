@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Devices {
+// Задержка обмена между логическими процессорами: два потока,
+// закреплённые за парой CPU, перебрасывают значение в одной строке кэша
+// (ping-pong на атомике). Круговой обмен - две передачи строки между
+// ядрами, в матрицу пишется половина кругового времени. Перебираются все
+// пары в фоновом потоке; по каждой берётся лучшая из нескольких серий,
+// чтобы прерывания не искажали результат.
+class CoreLatencyTest {
+public:
+  static constexpr unsigned roundTripsPerBatch = 100;
+  static constexpr unsigned batches = 5;
+
+  CoreLatencyTest() = default;
+  ~CoreLatencyTest();
+  CoreLatencyTest(const CoreLatencyTest &) = delete;
+  CoreLatencyTest &operator=(const CoreLatencyTest &) = delete;
+
+  // cpus пусто - все процессоры, доступные процессу.
+  bool Start(const std::vector<unsigned> &cpus, std::string &error);
+  void Stop();
+  bool IsRunning() const;
+  unsigned GetProgress() const; // проценты
+
+  // Матрица n x n по порядку cpus, наносекунды в одну сторону;
+  // отрицательное значение - пара ещё не измерена или CPU недоступен.
+  void GetMatrix(std::vector<unsigned> &cpus, std::vector<float> &matrix) const;
+
+private:
+  std::thread thread;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> running{false};
+  std::atomic<unsigned> progress{0};
+  mutable std::mutex mutex;
+  std::vector<unsigned> measuredCpus;
+  std::vector<float> latencies;
+
+  void Run();
+};
+} // namespace Devices
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "StringPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Devices {
+// Кэш одного уровня и типа: размер экземпляра и число экземпляров.
+struct CacheLevel {
+  uint32_t level = 0;
+  char type = 'U'; // 'D' - данные, 'I' - инструкции, 'U' - общий
+  uint64_t size = 0; // байты, один экземпляр
+  uint32_t lineSize = 0;
+  uint32_t ways = 0;
+  uint32_t cpusPerInstance = 0;
+  uint32_t instances = 0;
+};
+
+// Место логического процессора в топологии и пределы его частоты.
+// llc - номер группы общего последнего кэша (CCX у AMD), равен номеру
+// первого процессора группы.
+struct CpuPlacement {
+  int32_t package = -1;
+  int32_t die = -1;
+  int32_t node = -1;
+  int32_t core = -1;
+  int32_t llc = -1;
+  uint32_t minFrequencyMHz = 0;
+  uint32_t maxFrequencyMHz = 0;
+  InternedString governor;
+};
+
+// Сводка по физическому процессору для статической пробы CPU.
+struct PackageSummary {
+  int32_t package = 0;
+  uint32_t cores = 0;
+  uint32_t threads = 0;
+  uint32_t maxFrequencyMHz = 0;
+  uint64_t l1Cache = 0; // данные L1 одного ядра
+  uint64_t l2Cache = 0;
+  uint64_t l3Cache = 0; // один экземпляр L3
+};
+
+// Топология из sysfs (cpuN/topology, cpuN/cache/index*, узлы NUMA,
+// cpufreq). Дерево строится целиком в Load и перестраивается, только
+// когда меняется список включённых процессоров (hotplug): IsStale
+// сверяет его одним pread по открытому дескриптору. Текущие частоты
+// читаются тоже через открытые дескрипторы scaling_cur_freq - на 512
+// потоков один проход pread без open/close.
+class CpuTopology {
+public:
+  CpuTopology() = default;
+  ~CpuTopology();
+  CpuTopology(const CpuTopology &) = delete;
+  CpuTopology &operator=(const CpuTopology &) = delete;
+
+  void Load(const char *root, size_t cpuCount);
+  bool IsStale();
+  // Текущая частота в МГц; 0 - выключен или без cpufreq.
+  uint32_t ReadFrequencyMHz(size_t cpu) const;
+
+  size_t GetCpuCount() const;
+  const CpuPlacement &GetPlacement(size_t cpu) const;
+  const std::vector<CacheLevel> &GetCaches() const;
+
+  // Без загрузки дерева и дескрипторов: для пробы, идущей в своём потоке.
+  static void ReadPackages(const char *root, std::vector<PackageSummary> &out);
+
+private:
+  std::vector<CpuPlacement> placements;
+  std::vector<int> frequencyFds;
+  std::vector<CacheLevel> caches;
+  int onlineFd = -1;
+  char online[256] = {};
+
+  void CloseFds();
+};
+} // namespace Devices
@@ -0,0 +1,111 @@
+#include "Dmi.hpp"
+#include "PrivilegedHelper.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+
+namespace Devices {
+DmiStructure::DmiStructure(const uint8_t *data, const char *strings, const char *end)
+    : data(data), strings(strings), end(end) {}
+
+uint8_t DmiStructure::GetType() const { return data[0]; }
+
+uint8_t DmiStructure::GetByte(size_t offset) const {
+    return offset < data[1] ? data[offset] : 0;
+}
+
+uint16_t DmiStructure::GetWord(size_t offset) const {
+    if (offset + 2 > data[1]) {
+        return 0;
+    }
+    uint16_t value;
+    memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+uint32_t DmiStructure::GetDword(size_t offset) const {
+    if (offset + 4 > data[1]) {
+        return 0;
+    }
+    uint32_t value;
+    memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+std::string_view DmiStructure::GetString(size_t offset) const {
+    uint8_t number = GetByte(offset);
+    if (number == 0) {
+        return {};
+    }
+    const char *cursor = strings;
+    for (uint8_t i = 1; cursor < end; ++i) {
+        size_t length = strnlen(cursor, static_cast<size_t>(end - cursor));
+        if (i == number) {
+            std::string_view value(cursor, length);
+            // Производители дополняют строки пробелами
+            while (!value.empty() && value.back() == ' ') {
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+        cursor += length + 1;
+    }
+    return {};
+}
+
+const std::vector<uint8_t> &GetDmiTable(const char *sysfsRoot) {
+    static std::vector<uint8_t> table;
+    static std::once_flag loaded;
+    std::call_once(loaded, [sysfsRoot]() {
+        // Снимок дерева (ULSM_SYSFS_ROOT) читается напрямую: помощник
+        // с правами root чужих путей не принимает
+        std::string path = std::string(sysfsRoot) + "/firmware/dmi/tables/DMI";
+        if (strcmp(sysfsRoot, "/sys") == 0) {
+            std::string error;
+            if (PrivilegedHelper::GetInstance().Call(PrivilegedHelper::Request::DmiTable,
+                                                     table, error)) {
+                return;
+            }
+            std::cerr << "DMI table from privileged helper: " << error << std::endl;
+        }
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        uint8_t buffer[16384];
+        ssize_t got;
+        while ((got = read(fd, buffer, sizeof(buffer))) > 0) {
+            table.insert(table.end(), buffer, buffer + got);
+        }
+        close(fd);
+    });
+    return table;
+}
+
+const char *GetDmiMemoryType(uint8_t type) {
+    // DSP0134, 7.18.2
+    static const char *const names[] = {
+        nullptr, "Other", "Unknown", "DRAM", "EDRAM", "VRAM", "SRAM", "RAM", "ROM",
+        "Flash", "EEPROM", "FEPROM", "EPROM", "CDRAM", "3DRAM", "SDRAM", "SGRAM",
+        "RDRAM", "DDR", "DDR2", "DDR2 FB-DIMM", nullptr, nullptr, nullptr, "DDR3",
+        "FBD2", "DDR4", "LPDDR", "LPDDR2", "LPDDR3", "LPDDR4", "Logical non-volatile device",
+        "HBM", "HBM2", "DDR5", "LPDDR5", "HBM3"};
+    const char *name = type < sizeof(names) / sizeof(names[0]) ? names[type] : nullptr;
+    return name ? name : "Unknown";
+}
+
+const char *GetDmiFormFactor(uint8_t formFactor) {
+    // DSP0134, 7.18.1
+    static const char *const names[] = {
+        nullptr, "Other", "Unknown", "SIMM", "SIP", "Chip", "DIP", "ZIP",
+        "Proprietary Card", "DIMM", "TSOP", "Row Of Chips", "RIMM", "SODIMM", "SRIMM",
+        "FB-DIMM", "Die"};
+    const char *name =
+        formFactor < sizeof(names) / sizeof(names[0]) ? names[formFactor] : nullptr;
+    return name ? name : "Unknown";
+}
+} // namespace Devices
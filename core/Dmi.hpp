@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Devices {
+// Одна структура SMBIOS: форматированная часть и следующий за ней
+// набор строк. Поля читаются по смещениям из спецификации DMTF DSP0134;
+// поле за пределами length (старая версия SMBIOS) читается как 0.
+class DmiStructure {
+public:
+  DmiStructure(const uint8_t *data, const char *strings, const char *end);
+
+  uint8_t GetType() const;
+  uint8_t GetByte(size_t offset) const;
+  uint16_t GetWord(size_t offset) const;
+  uint32_t GetDword(size_t offset) const;
+  // Строка по номеру из байта offset; пусто, если номер 0.
+  std::string_view GetString(size_t offset) const;
+
+private:
+  const uint8_t *data;
+  const char *strings;
+  const char *end;
+};
+
+// Обходит структуры сырой таблицы (/sys/firmware/dmi/tables/DMI) до
+// типа 127 или конца буфера, вызывая visit для структур типа type.
+template <typename Visit>
+void ForEachDmiStructure(const std::vector<uint8_t> &table, uint8_t type, Visit visit);
+
+// Таблица SMBIOS, полученная через привилегированного помощника.
+// Читается один раз за процесс и дальше отдаётся из памяти: пробы CPU
+// и RAM идут параллельно и разбирают одну копию. Пусто - таблицы нет
+// или нет прав.
+const std::vector<uint8_t> &GetDmiTable(const char *sysfsRoot);
+
+const char *GetDmiMemoryType(uint8_t type);
+const char *GetDmiFormFactor(uint8_t formFactor);
+
+template <typename Visit>
+void ForEachDmiStructure(const std::vector<uint8_t> &table, uint8_t type, Visit visit) {
+  const uint8_t *cursor = table.data();
+  const uint8_t *tableEnd = table.data() + table.size();
+  while (tableEnd - cursor >= 4) {
+    uint8_t length = cursor[1];
+    if (length < 4 || tableEnd - cursor < length) {
+      return;
+    }
+    // Набор строк заканчивается двумя нулями подряд
+    const uint8_t *strings = cursor + length;
+    const uint8_t *next = strings;
+    while (tableEnd - next >= 2 && (next[0] != 0 || next[1] != 0)) {
+      ++next;
+    }
+    if (tableEnd - next < 2) {
+      return;
+    }
+    if (cursor[0] == type) {
+      visit(DmiStructure(cursor, reinterpret_cast<const char *>(strings),
+                         reinterpret_cast<const char *>(next)));
+    }
+    if (cursor[0] == 127) {
+      return;
+    }
+    cursor = next + 2;
+  }
+}
+} // namespace Devices
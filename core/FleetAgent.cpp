@@ -0,0 +1,183 @@
+#include "FleetAgent.hpp"
+#include "SnapshotExport.hpp"
+#include "SysMonCore.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+bool AppendToFrame(void *context, const char *data, size_t size) {
+    std::vector<char> &frame = *static_cast<std::vector<char> *>(context);
+    frame.insert(frame.end(), data, data + size);
+    return true;
+}
+} // namespace
+
+namespace Devices {
+bool SplitHostPort(std::string_view address, std::string &host, std::string &port,
+                   std::string &error) {
+    size_t colon = address.rfind(':');
+    if (!address.empty() && address.front() == '[') {
+        size_t bracket = address.find(']');
+        if (bracket == std::string_view::npos) {
+            error = std::string(address) + ": unterminated '['";
+            return false;
+        }
+        if (bracket + 1 < address.size() && address[bracket + 1] == ':') {
+            port = address.substr(bracket + 2);
+        }
+        host = address.substr(1, bracket - 1);
+    } else if (colon != std::string_view::npos && address.find(':') == colon) {
+        port = address.substr(colon + 1);
+        host = address.substr(0, colon);
+    } else {
+        host = address;
+    }
+    return true;
+}
+
+FleetAgent::~FleetAgent() {
+    for (Client &client : clients) {
+        close(client.fd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+}
+
+bool FleetAgent::Listen(std::string_view address, std::string &error) {
+    std::string host = fleetAgentHost;
+    std::string port = std::to_string(fleetAgentPort);
+    if (address.find_first_not_of("0123456789") == std::string_view::npos) {
+        // Пусто или только порт (прежняя форма --agent=порт) - loopback
+        if (!address.empty()) {
+            port = address;
+        }
+    } else if (!SplitHostPort(address, host, port, error)) {
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo *result = nullptr;
+    // Пустой host ("[]:порт") - все адреса, как и явный 0.0.0.0
+    int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints,
+                             &result);
+    if (status != 0) {
+        error = host + ":" + port + ": " + gai_strerror(status);
+        return false;
+    }
+    listenFd = socket(result->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        error = std::string("socket: ") + strerror(errno);
+        freeaddrinfo(result);
+        return false;
+    }
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(listenFd, result->ai_addr, result->ai_addrlen) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        error = host + ":" + port + ": " + strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        freeaddrinfo(result);
+        return false;
+    }
+    freeaddrinfo(result);
+    return true;
+}
+
+int FleetAgent::GetFd() const { return listenFd; }
+
+void FleetAgent::Accept() {
+    int fd;
+    while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        // Кадры маленькие и редкие: Nagle только задержал бы их
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        Client client;
+        client.fd = fd;
+        clients.push_back(std::move(client));
+    }
+}
+
+bool FleetAgent::Send(Client &client) {
+    if (client.offset < client.pending.size()) {
+        ssize_t sent = send(client.fd, client.pending.data() + client.offset,
+                            client.pending.size() - client.offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.offset += static_cast<size_t>(sent);
+        if (client.offset < client.pending.size()) {
+            // Предыдущий кадр ещё в пути - этот такт пропускается
+            return true;
+        }
+    }
+    client.pending.clear();
+    client.offset = 0;
+    ssize_t sent = send(client.fd, frame.data(), frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return false;
+        }
+        sent = 0;
+    }
+    if (static_cast<size_t>(sent) < frame.size()) {
+        client.pending.assign(frame.begin() + sent, frame.end());
+    }
+    return true;
+}
+
+void FleetAgent::Publish(PC &pc) {
+    Accept();
+    if (clients.empty()) {
+        return;
+    }
+
+    frame.assign(4, 0);
+    {
+        ExportWriter writer(ExportFormat::Cbor, &AppendToFrame, &frame);
+        writer.BeginObject();
+        writer.Key("host");
+        writer.String(pc.GetHostname());
+        writer.Key("generation");
+        writer.Uint(pc.GetGeneration());
+        writer.Key("alerts");
+        writer.Uint(pc.GetAlerts().GetFiringCount());
+        for (size_t series = 0; series < static_cast<size_t>(PC::Series::Count); ++series) {
+            const History &history = pc.GetHistory(static_cast<PC::Series>(series));
+            if (history.IsEmpty()) {
+                continue;
+            }
+            writer.Key(PC::GetSeriesName(static_cast<PC::Series>(series)));
+            writer.Double(history.GetLatest());
+        }
+        writer.EndObject();
+        writer.Flush();
+    }
+    uint32_t length = static_cast<uint32_t>(frame.size() - 4);
+    for (size_t i = 0; i < 4; ++i) {
+        frame[i] = static_cast<char>(length >> (24 - 8 * i));
+    }
+
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [this](Client &client) {
+                                     if (Send(client)) {
+                                         return false;
+                                     }
+                                     close(client.fd);
+                                     return true;
+                                 }),
+                  clients.end());
+}
+
+size_t FleetAgent::GetClientCount() const { return clients.size(); }
+} // namespace Devices
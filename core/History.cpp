@@ -0,0 +1,136 @@
+#include "History.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace Devices {
+History::History(size_t capacity) : times(capacity), values(capacity) {}
+
+void History::Push(uint64_t timeNs, float value) {
+    if (times.empty()) {
+        return;
+    }
+    if (pushed == 0) {
+        originNs = timeNs;
+    }
+    // Замеры приходят от монотонных часов; на всякий случай время не
+    // уменьшается, иначе сломается двоичный поиск по кольцу.
+    uint64_t offsetMs = timeNs > originNs ? (timeNs - originNs) / 1000000ull : 0;
+    if (size != 0) {
+        offsetMs = std::max<uint64_t>(offsetMs, times[Slot(size - 1)]);
+    }
+    if (offsetMs > std::numeric_limits<uint32_t>::max()) {
+        Rebase(offsetMs);
+        offsetMs = (timeNs - originNs) / 1000000ull;
+    }
+
+    size_t slot = (head + size) % times.size();
+    times[slot] = static_cast<uint32_t>(offsetMs);
+    values[slot] = value;
+    if (size < times.size()) {
+        ++size;
+    } else {
+        head = (head + 1) % times.size();
+    }
+    ++pushed;
+}
+
+void History::Clear() {
+    head = 0;
+    size = 0;
+    pushed = 0;
+}
+
+// Раз в 24 дня: линейный проход по кольцу вместо 64-битного времени
+// в каждой точке.
+void History::Rebase(uint64_t offsetMs) {
+    uint64_t shift = offsetMs - std::numeric_limits<uint32_t>::max() / 2;
+    while (size != 0 && times[head] < shift) {
+        head = (head + 1) % times.size();
+        --size;
+    }
+    for (size_t index = 0; index < size; ++index) {
+        times[Slot(index)] -= static_cast<uint32_t>(shift);
+    }
+    originNs += shift * 1000000ull;
+}
+
+size_t History::GetSize() const { return size; }
+size_t History::GetCapacity() const { return times.size(); }
+uint64_t History::GetPushCount() const { return pushed; }
+bool History::IsEmpty() const { return size == 0; }
+uint64_t History::GetOldestTime() const { return size == 0 ? 0 : TimeAt(0); }
+uint64_t History::GetLatestTime() const {
+    return size == 0 ? 0 : TimeAt(size - 1);
+}
+float History::GetLatest() const {
+    return size == 0 ? 0.0f : values[Slot(size - 1)];
+}
+
+size_t History::Slot(size_t index) const {
+    return (head + index) % times.size();
+}
+
+uint64_t History::TimeAt(size_t index) const {
+    return originNs + static_cast<uint64_t>(times[Slot(index)]) * 1000000ull;
+}
+
+size_t History::LowerBound(uint64_t timeNs) const {
+    size_t first = 0;
+    size_t count = size;
+    while (count > 0) {
+        size_t step = count / 2;
+        if (TimeAt(first + step) < timeNs) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void History::Decimate(uint64_t fromNs, uint64_t toNs,
+                       std::vector<Bucket> &out) const {
+    for (Bucket &bucket : out) {
+        bucket.valid = false;
+    }
+    if (out.empty() || size == 0 || toNs <= fromNs) {
+        return;
+    }
+
+    const uint64_t span = toNs - fromNs;
+    const uint64_t columns = out.size();
+    // Кольцо разбивается на два непрерывных куска, чтобы во внутреннем
+    // цикле не было деления по модулю.
+    size_t first = LowerBound(fromNs);
+    if (first == size) {
+        return;
+    }
+    size_t begin = Slot(first);
+    size_t end = Slot(size - 1) + 1;
+    auto scan = [&](size_t from, size_t to) {
+        for (size_t slot = from; slot < to; ++slot) {
+            uint64_t timeNs = originNs + static_cast<uint64_t>(times[slot]) * 1000000ull;
+            if (timeNs >= toNs) {
+                return false;
+            }
+            Bucket &bucket = out[(timeNs - fromNs) * columns / span];
+            float value = values[slot];
+            if (!bucket.valid) {
+                bucket.min = value;
+                bucket.max = value;
+                bucket.valid = true;
+            } else {
+                bucket.min = std::min(bucket.min, value);
+                bucket.max = std::max(bucket.max, value);
+            }
+        }
+        return true;
+    };
+    if (begin < end) {
+        scan(begin, end);
+    } else if (scan(begin, times.size())) {
+        scan(0, end);
+    }
+}
+} // namespace Devices
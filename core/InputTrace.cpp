@@ -0,0 +1,321 @@
+#include "InputTrace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char traceMagic[8] = {'U', 'L', 'S', 'M', 'T', 'R', 'C', '1'};
+constexpr uint8_t sourceRecord = 1;
+constexpr uint8_t runRecord = 2;
+constexpr uint8_t readRecord = 3;
+// Буфер записи сбрасывается по объёму или раз в секунду времени замеров
+constexpr size_t flushBytes = 64 * 1024;
+constexpr uint64_t flushNs = 1000000000ull;
+
+void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool GetVarint(const std::vector<uint8_t> &in, size_t &cursor, uint64_t &value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && cursor < in.size(); shift += 7) {
+        uint8_t byte = in[cursor++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+namespace Devices {
+thread_local bool InputTrace::tracing = false;
+
+InputTrace::~InputTrace() { StopRecording(); }
+
+bool InputTrace::StartRecording(const char *path, std::string &error) {
+    if (fd >= 0 || replaying) {
+        error = "trace is already open";
+        return false;
+    }
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    output.assign(traceMagic, traceMagic + sizeof(traceMagic));
+    output.reserve(flushBytes * 2);
+    this->error.clear();
+    lastRunNs = 0;
+    lastFlushNs = 0;
+    return true;
+}
+
+bool InputTrace::StopRecording() {
+    if (fd >= 0) {
+        Flush();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    return error.empty();
+}
+
+bool InputTrace::IsRecording() const { return fd >= 0; }
+
+const std::string &InputTrace::GetError() const { return error; }
+
+bool InputTrace::OpenReplay(const char *path, std::string &error) {
+    if (fd >= 0 || replaying) {
+        error = "trace is already open";
+        return false;
+    }
+    int input = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (input < 0 || fstat(input, &status) != 0) {
+        error = std::string(path) + ": " + strerror(errno);
+        if (input >= 0) {
+            close(input);
+        }
+        return false;
+    }
+    file.resize(static_cast<size_t>(status.st_size));
+    size_t done = 0;
+    while (done < file.size()) {
+        ssize_t got = read(input, file.data() + done, file.size() - done);
+        if (got <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(got);
+    }
+    close(input);
+    if (done != file.size() || file.size() < sizeof(traceMagic) ||
+        memcmp(file.data(), traceMagic, sizeof(traceMagic)) != 0) {
+        error = std::string(path) + ": not an input trace";
+        file.clear();
+        return false;
+    }
+    cursor = sizeof(traceMagic);
+    lastRunNs = 0;
+    replaying = true;
+    return true;
+}
+
+bool InputTrace::IsReplaying() const { return replaying; }
+
+uint64_t InputTrace::GetFileBytes() const { return file.size(); }
+
+void InputTrace::BeginRun(uint32_t collector, uint64_t timeNs) {
+    // Замеры разных сборщиков одного такта идут с одним временем
+    uint64_t delta = timeNs > lastRunNs ? timeNs - lastRunNs : 0;
+    lastRunNs += delta;
+    output.push_back(runRecord);
+    PutVarint(output, collector);
+    PutVarint(output, delta);
+    tracing = true;
+}
+
+void InputTrace::BeginReplayRun() { tracing = true; }
+
+void InputTrace::EndRun() {
+    tracing = false;
+    if (fd >= 0 && (output.size() >= flushBytes || lastRunNs - lastFlushNs >= flushNs)) {
+        Flush();
+        lastFlushNs = lastRunNs;
+    }
+}
+
+uint32_t InputTrace::GetSourceId(std::string_view source, bool &added) {
+    auto found = sourceIds.find(source);
+    added = found == sourceIds.end();
+    if (!added) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(sourceNames.size());
+    sourceNames.emplace_back(source);
+    sourceIds.emplace(sourceNames.back(), id);
+    lastContent.emplace_back();
+    return id;
+}
+
+void InputTrace::Record(std::string_view source, const char *data, ssize_t got) {
+    bool added;
+    uint32_t id = GetSourceId(source, added);
+    if (added) {
+        output.push_back(sourceRecord);
+        PutVarint(output, source.size());
+        output.insert(output.end(), source.begin(), source.end());
+    }
+    output.push_back(readRecord);
+    PutVarint(output, id);
+    if (got < 0) {
+        PutVarint(output, 0);
+        return;
+    }
+    size_t length = static_cast<size_t>(got);
+    std::string &last = lastContent[id];
+    size_t limit = std::min(length, last.size());
+    size_t prefix = 0;
+    while (prefix < limit && data[prefix] == last[prefix]) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           data[length - 1 - suffix] == last[last.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    PutVarint(output, length + 1);
+    PutVarint(output, prefix);
+    PutVarint(output, suffix);
+    output.insert(output.end(), data + prefix, data + length - suffix);
+    last.assign(data, length);
+}
+
+void InputTrace::Flush() {
+    size_t done = 0;
+    while (done < output.size()) {
+        ssize_t written = write(fd, output.data() + done, output.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Диск полон или файл недоступен - запись трассы прекращается,
+            // а не молча теряет замеры
+            error = std::string("write failed: ") + strerror(errno);
+            std::cerr << "Input trace: " << error << "; recording stopped" << std::endl;
+            close(fd);
+            fd = -1;
+            break;
+        }
+        done += static_cast<size_t>(written);
+    }
+    output.clear();
+}
+
+bool InputTrace::PeekRun(uint64_t &timeNs) {
+    while (!runPending && cursor < file.size()) {
+        uint8_t tag = file[cursor++];
+        uint64_t first, second;
+        if (tag == sourceRecord) {
+            if (!GetVarint(file, cursor, first) || first > file.size() - cursor) {
+                break;
+            }
+            bool added;
+            GetSourceId(std::string_view(reinterpret_cast<const char *>(file.data() + cursor),
+                                         static_cast<size_t>(first)),
+                        added);
+            cursor += static_cast<size_t>(first);
+        } else if (tag == runRecord && GetVarint(file, cursor, first) &&
+                   GetVarint(file, cursor, second)) {
+            pendingCollector = static_cast<uint32_t>(first);
+            pendingTimeNs = lastRunNs + second;
+            runPending = true;
+        } else {
+            break;
+        }
+    }
+    if (!runPending) {
+        cursor = file.size();
+        return false;
+    }
+    timeNs = pendingTimeNs;
+    return true;
+}
+
+bool InputTrace::NextRun(uint32_t &collector, uint64_t &timeNs) {
+    if (!PeekRun(timeNs)) {
+        return false;
+    }
+    runPending = false;
+    collector = pendingCollector;
+    lastRunNs = pendingTimeNs;
+    entries.clear();
+    arena.clear();
+    nextEntry = 0;
+
+    // Чтения замера - до следующей записи замера; источники, впервые
+    // встреченные внутри замера, объявляются перед своим чтением
+    while (cursor < file.size() && file[cursor] != runRecord) {
+        uint8_t tag = file[cursor++];
+        uint64_t id, length;
+        if (!GetVarint(file, cursor, id)) {
+            return false;
+        }
+        if (tag == sourceRecord) {
+            if (id > file.size() - cursor) {
+                return false;
+            }
+            bool added;
+            GetSourceId(std::string_view(reinterpret_cast<const char *>(file.data() + cursor),
+                                         static_cast<size_t>(id)),
+                        added);
+            cursor += static_cast<size_t>(id);
+            continue;
+        }
+        if (tag != readRecord || id >= lastContent.size() || !GetVarint(file, cursor, length)) {
+            return false;
+        }
+        if (length == 0) {
+            entries.push_back({static_cast<uint32_t>(id), -1, 0, false});
+            continue;
+        }
+        --length;
+        uint64_t prefix, suffix;
+        std::string &last = lastContent[id];
+        if (!GetVarint(file, cursor, prefix) || !GetVarint(file, cursor, suffix) ||
+            prefix + suffix > std::min<uint64_t>(length, last.size()) ||
+            length - prefix - suffix > file.size() - cursor) {
+            return false;
+        }
+        size_t middle = static_cast<size_t>(length - prefix - suffix);
+        size_t offset = arena.size();
+        arena.insert(arena.end(), last.begin(), last.begin() + static_cast<ptrdiff_t>(prefix));
+        arena.insert(arena.end(), file.begin() + static_cast<ptrdiff_t>(cursor),
+                     file.begin() + static_cast<ptrdiff_t>(cursor + middle));
+        arena.insert(arena.end(), last.end() - static_cast<ptrdiff_t>(suffix), last.end());
+        cursor += middle;
+        last.assign(arena.data() + offset, static_cast<size_t>(length));
+        entries.push_back({static_cast<uint32_t>(id), static_cast<ssize_t>(length), offset, false});
+    }
+    timeNs = lastRunNs;
+    return true;
+}
+
+ssize_t InputTrace::Replay(std::string_view source, char *buffer, size_t size) {
+    auto found = sourceIds.find(source);
+    if (found == sourceIds.end()) {
+        errno = ENOENT;
+        return -1;
+    }
+    // Обычно чтения идут в том же порядке, что при записи: поиск
+    // начинается с позиции после предыдущего совпадения
+    size_t count = entries.size();
+    for (size_t step = 0; step < count; ++step) {
+        Entry &entry = entries[(nextEntry + step) % count];
+        if (entry.used || entry.source != found->second) {
+            continue;
+        }
+        entry.used = true;
+        nextEntry = (nextEntry + step + 1) % count;
+        if (entry.length < 0) {
+            errno = EIO;
+            return -1;
+        }
+        size_t length = std::min(static_cast<size_t>(entry.length), size);
+        memcpy(buffer, arena.data() + entry.offset, length);
+        return static_cast<ssize_t>(length);
+    }
+    errno = ENOENT;
+    return -1;
+}
+} // namespace Devices
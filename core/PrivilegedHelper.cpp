@@ -0,0 +1,203 @@
+#include "PrivilegedHelper.hpp"
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+// Таблица без точки входа: структуры подряд, как их разбирает Dmi.cpp.
+const char *const dmiTablePath = "/sys/firmware/dmi/tables/DMI";
+// SMBIOS 3 ограничивает таблицу 4 ГиБ, реальные - десятки КиБ
+const uint32_t maximumReply = 16u << 20;
+
+bool ReadAll(int fd, void *buffer, size_t size) {
+    char *cursor = static_cast<char *>(buffer);
+    while (size > 0) {
+        ssize_t got = read(fd, cursor, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        cursor += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const void *buffer, size_t size) {
+    const char *cursor = static_cast<const char *>(buffer);
+    while (size > 0) {
+        // MSG_NOSIGNAL: закрытый сокет - ошибка, а не SIGPIPE
+        ssize_t sent = send(fd, cursor, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        cursor += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+int ReadWholeFile(const char *path, std::vector<uint8_t> &out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+    out.clear();
+    uint8_t buffer[16384];
+    ssize_t got;
+    while ((got = read(fd, buffer, sizeof(buffer))) > 0 && out.size() < maximumReply) {
+        out.insert(out.end(), buffer, buffer + got);
+    }
+    int error = got < 0 ? errno : 0;
+    close(fd);
+    return error;
+}
+
+std::string FindHelper() {
+    if (const char *path = getenv("ULSM_HELPER")) {
+        return path;
+    }
+    char self[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (length <= 0) {
+        return "ulsm-helper";
+    }
+    std::string path(self, static_cast<size_t>(length));
+    return path.substr(0, path.rfind('/') + 1) + "ulsm-helper";
+}
+} // namespace
+
+namespace Devices {
+PrivilegedHelper::~PrivilegedHelper() { Stop(); }
+
+bool PrivilegedHelper::Start(std::string &error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        return true;
+    }
+    std::string path = FindHelper();
+    if (access(path.c_str(), X_OK) != 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+        error = std::string("socketpair: ") + strerror(errno);
+        return false;
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        error = std::string("fork: ") + strerror(errno);
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+    if (child == 0) {
+        // Сокет помощника - его stdin: sudo закрывает остальные
+        // дескрипторы, а пароль читает с терминала, не со stdin
+        dup2(sockets[1], STDIN_FILENO);
+        if (geteuid() == 0) {
+            execl(path.c_str(), path.c_str(), static_cast<char *>(nullptr));
+        } else {
+            execlp("sudo", "sudo", "--", path.c_str(), static_cast<char *>(nullptr));
+        }
+        _exit(127);
+    }
+    close(sockets[1]);
+    fd = sockets[0];
+    pid = child;
+    return true;
+}
+
+void PrivilegedHelper::Stop() {
+    // Call может висеть в read, пока sudo ждёт пароль: shutdown будит
+    // его без мьютекса, а помощник видит конец потока и выходит
+    int socket = fd.load();
+    if (socket >= 0) {
+        shutdown(socket, SHUT_RDWR);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (pid > 0) {
+        // Пароль так и не введён - sudo сам не завершится
+        bool exited = false;
+        for (int attempt = 0; attempt < 10 && !exited; ++attempt) {
+            exited = waitpid(pid, nullptr, WNOHANG) == pid;
+            if (!exited) {
+                usleep(10000);
+            }
+        }
+        if (!exited && kill(pid, SIGTERM) == 0) {
+            waitpid(pid, nullptr, 0);
+        }
+        pid = -1;
+    }
+}
+
+bool PrivilegedHelper::Call(Request request, std::vector<uint8_t> &reply, std::string &error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) {
+        error = "privileged helper is not running";
+        return false;
+    }
+    Header header{static_cast<uint32_t>(request), 0, 0};
+    // До ответа на первый запрос sudo может ждать пароль
+    if (!WriteAll(fd, &header, sizeof(header)) || !ReadAll(fd, &header, sizeof(header)) ||
+        header.length > maximumReply) {
+        error = "privileged helper exited";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    reply.resize(header.length);
+    if (!ReadAll(fd, reply.data(), reply.size())) {
+        error = "privileged helper exited";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    if (header.status != 0) {
+        error = strerror(header.status);
+        return false;
+    }
+    return true;
+}
+
+int PrivilegedHelper::Serve(int fd) {
+    Header header;
+    std::vector<uint8_t> reply;
+    while (ReadAll(fd, &header, sizeof(header))) {
+        reply.clear();
+        switch (static_cast<Request>(header.request)) {
+        case Request::DmiTable:
+            header.status = ReadWholeFile(dmiTablePath, reply);
+            break;
+        default:
+            header.status = EINVAL;
+            break;
+        }
+        if (header.status != 0) {
+            reply.clear();
+        }
+        header.length = static_cast<uint32_t>(reply.size());
+        if (!WriteAll(fd, &header, sizeof(header)) || !WriteAll(fd, reply.data(), reply.size())) {
+            break;
+        }
+    }
+    return 0;
+}
+} // namespace Devices
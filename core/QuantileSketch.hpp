@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Devices {
+// DDSketch: логарифмические корзины с относительной погрешностью 4%,
+// счётчики в плотном массиве от младшего до старшего занятого индекса,
+// не больше maxBuckets (2 КиБ). Они покрывают отношение max/min около
+// 10^8 - от простоя до всплеска скорости интерфейса; если значения
+// расходятся сильнее, младшие корзины сливаются в одну (collapsing
+// lowest, как в DDSketch), и квантиль ниже границы возвращается как
+// сама граница. Память - 8 байт на корзину занятого диапазона.
+// Скетчи сливаются сложением счётчиков - так объединяются ядра, окна и
+// хосты.
+class QuantileSketch {
+public:
+  static constexpr double relativeAccuracy = 0.04;
+  static constexpr size_t maxBuckets = 256;
+  // Меньшие значения (и отрицательные) считаются нулём. Счётчики корзин
+  // 64-битные: слияние ядер и хостов парка складывает их без предела.
+  static constexpr double minIndexable = 1e-3;
+
+  void Add(double value, uint64_t count = 1);
+  void Merge(const QuantileSketch &other);
+  // Сбрасывает счётчики, сохраняя выделенную память.
+  void Clear();
+
+  uint64_t GetCount() const;
+  double GetMin() const;
+  double GetMax() const;
+  // q в [0, 1]; 0 для пустого скетча.
+  double GetQuantile(double q) const;
+  size_t GetMemoryBytes() const;
+
+private:
+  std::vector<uint64_t> counts;
+  int32_t offset = 0; // индекс корзины counts[0]
+  uint64_t zeroCount = 0;
+  uint64_t bucketTotal = 0; // сумма counts
+  uint64_t total = 0;
+  double min = 0;
+  double max = 0;
+
+  static int32_t Index(double value);
+  static double Value(int32_t index);
+  void AddToBucket(int32_t index, uint64_t count);
+};
+
+// Квантили за скользящие 1 минуту, 1 час и 24 часа. Каждое окно - кольцо
+// из шести скетчей-срезов (10 с, 10 мин, 4 ч); устаревший срез
+// очищается при первом замере нового периода. Окно сдвигается с шагом
+// среза, то есть на шестую часть, сырые замеры не хранятся.
+// Память на метрику - 18 срезов по 72 байта плюс корзины занятого
+// диапазона, предел около 38 КиБ. Сутки при 10 Гц (GetMemoryBytes на
+// синтетических рядах): температура - 2.5 КиБ, загрузка ядра - 6 КиБ,
+// загрузка CPU от 2 до 90% - 8 КиБ, скорость интерфейса от сотен Б/с
+// в простое до 100 МБ/с во всплесках - 35 КиБ.
+class SlidingQuantiles {
+public:
+  enum class Window { Minute, Hour, Day, Count };
+  void Add(uint64_t timeNs, double value);
+  // Добавляет к out актуальные срезы окна; out не очищается, поэтому
+  // несколько метрик (ядер, хостов) сливаются в один скетч.
+  void MergeInto(Window window, uint64_t nowNs, QuantileSketch &out) const;
+  size_t GetMemoryBytes() const;
+
+  static uint64_t GetWindowNs(Window window);
+
+private:
+  struct Ring {
+    std::vector<QuantileSketch> slices;
+    std::vector<uint64_t> epochs;
+  };
+  std::array<Ring, static_cast<size_t>(Window::Count)> rings;
+
+  static uint64_t SliceNs(size_t window);
+  static size_t SliceCount(size_t window);
+};
+} // namespace Devices
@@ -0,0 +1,148 @@
+#include "RaplPower.hpp"
+#include "InputTrace.hpp"
+#include "SysfsUtil.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+Devices::PowerDomain::Kind GetKind(const char *name) {
+    using Kind = Devices::PowerDomain::Kind;
+    if (strncmp(name, "package", 7) == 0) {
+        return Kind::Package;
+    }
+    if (strcmp(name, "core") == 0) {
+        return Kind::Core;
+    }
+    if (strcmp(name, "uncore") == 0) {
+        return Kind::Uncore;
+    }
+    if (strcmp(name, "dram") == 0) {
+        return Kind::Dram;
+    }
+    if (strcmp(name, "psys") == 0) {
+        return Kind::Platform;
+    }
+    return Kind::Other;
+}
+
+bool ReadCounter(size_t domain, int fd, uint64_t &value) {
+    char buffer[32];
+    ssize_t got = Devices::TracedRead("rapl", domain, buffer, sizeof(buffer) - 1,
+                                      [fd, &buffer]() { return pread(fd, buffer, sizeof(buffer) - 1, 0); });
+    if (got <= 0) {
+        return false;
+    }
+    buffer[got] = '\0';
+    value = strtoull(buffer, nullptr, 10);
+    return true;
+}
+} // namespace
+
+namespace Devices {
+RaplPower::~RaplPower() { CloseFds(); }
+
+void RaplPower::CloseFds() {
+    for (Counter &counter : counters) {
+        if (counter.fd >= 0) {
+            close(counter.fd);
+        }
+    }
+    counters.clear();
+}
+
+void RaplPower::Load(const char *root) {
+    CloseFds();
+    domains.clear();
+    lastReadNs = 0;
+
+    // Зоны и подзоны лежат плоским списком: intel-rapl:0, intel-rapl:0:0.
+    // intel-rapl-mmio дублирует пакет через MMIO и пропускается.
+    char path[512];
+    snprintf(path, sizeof(path), "%s/class/powercap", root);
+    std::vector<std::string> zones;
+    if (DIR *directory = opendir(path)) {
+        while (dirent *entry = readdir(directory)) {
+            if (strncmp(entry->d_name, "intel-rapl:", 11) == 0) {
+                zones.emplace_back(entry->d_name);
+            }
+        }
+        closedir(directory);
+    }
+    std::sort(zones.begin(), zones.end());
+
+    char buffer[64];
+    for (const std::string &zone : zones) {
+        snprintf(path, sizeof(path), "%s/class/powercap/%s/name", root, zone.c_str());
+        if (ReadSysfsValue(path, buffer, sizeof(buffer)) <= 0) {
+            continue;
+        }
+        PowerDomain domain;
+        domain.name = InternedString(buffer);
+        domain.kind = GetKind(buffer);
+        // psys - отдельная зона верхнего уровня, не пакет
+        if (domain.kind != PowerDomain::Kind::Platform) {
+            domain.package = static_cast<int32_t>(strtol(zone.c_str() + 11, nullptr, 10));
+        }
+
+        Counter counter;
+        snprintf(path, sizeof(path), "%s/class/powercap/%s/max_energy_range_uj", root,
+                 zone.c_str());
+        if (ReadSysfsValue(path, buffer, sizeof(buffer)) > 0) {
+            counter.range = strtoull(buffer, nullptr, 10);
+        }
+        snprintf(path, sizeof(path), "%s/class/powercap/%s/energy_uj", root, zone.c_str());
+        counter.fd = open(path, O_RDONLY | O_CLOEXEC);
+        domain.readable = counter.fd >= 0 && ReadCounter(domains.size(), counter.fd, counter.last);
+        domains.push_back(domain);
+        counters.push_back(counter);
+    }
+}
+
+void RaplPower::Read(uint64_t nowNs) {
+    double seconds = lastReadNs != 0 && nowNs > lastReadNs ? (nowNs - lastReadNs) / 1e9 : 0;
+    lastReadNs = nowNs;
+    for (size_t i = 0; i < domains.size(); ++i) {
+        Counter &counter = counters[i];
+        uint64_t energy = 0;
+        if (!domains[i].readable || !ReadCounter(i, counter.fd, energy)) {
+            domains[i].watts = 0;
+            continue;
+        }
+        uint64_t last = counter.last;
+        counter.last = energy;
+        if (energy < last && counter.range < last) {
+            // Счётчик пошёл с нуля, а max_energy_range_uj не прочитан (или
+            // меньше прошлого значения): прирост не восстановить, замер
+            // пропускается с прежней мощностью вместо огромного числа
+            continue;
+        }
+        // Переход через max_energy_range_uj: счётчик начал с нуля
+        uint64_t delta = energy >= last ? energy - last : counter.range - last + energy;
+        domains[i].watts = seconds > 0 ? static_cast<float>(delta / 1e6 / seconds) : 0;
+    }
+}
+
+void RaplPower::ResetRate() { lastReadNs = 0; }
+
+const std::vector<PowerDomain> &RaplPower::GetDomains() const { return domains; }
+
+float RaplPower::GetPackageWatts() const {
+    float total = 0;
+    for (const PowerDomain &domain : domains) {
+        if (domain.kind == PowerDomain::Kind::Package) {
+            total += domain.watts;
+        }
+    }
+    return total;
+}
+
+bool RaplPower::IsReadable() const {
+    return std::any_of(domains.begin(), domains.end(),
+                       [](const PowerDomain &domain) { return domain.readable; });
+}
+} // namespace Devices
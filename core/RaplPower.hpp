@@ -0,0 +1,59 @@
+#pragma once
+
+#include "StringPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Devices {
+// Домен RAPL: пакет целиком, ядра, uncore (встроенная графика), DRAM
+// или вся платформа (psys).
+struct PowerDomain {
+  enum class Kind { Package, Core, Uncore, Dram, Platform, Other };
+
+  InternedString name; // как в sysfs: package-0, core, dram
+  Kind kind = Kind::Other;
+  int32_t package = -1; // N из intel-rapl:N
+  float watts = 0;      // средняя мощность за последний интервал
+  bool readable = false;
+};
+
+// Мощность по счётчикам энергии powercap (class/powercap/intel-rapl:*;
+// тот же драйвер на AMD). energy_uj растёт до max_energy_range_uj и
+// переходит через ноль - на ватт-часовой нагрузке за минуты, поэтому
+// разница считается по модулю диапазона. Дескрипторы energy_uj открыты
+// постоянно, замер - pread на домен. На ядрах с CVE-2020-8694 energy_uj
+// читает только root: домены остаются в списке с readable == false.
+class RaplPower {
+public:
+  RaplPower() = default;
+  ~RaplPower();
+  RaplPower(const RaplPower &) = delete;
+  RaplPower &operator=(const RaplPower &) = delete;
+
+  // Пустой список - RAPL нет (виртуальная машина, старый процессор).
+  void Load(const char *root);
+  void Read(uint64_t nowNs);
+  // Следующий Read только запоминает счётчики, мощность с него не
+  // считается.
+  void ResetRate();
+
+  const std::vector<PowerDomain> &GetDomains() const;
+  // Сумма доменов Package, Вт; 0 - нечего читать.
+  float GetPackageWatts() const;
+  bool IsReadable() const;
+
+private:
+  struct Counter {
+    int fd = -1;
+    uint64_t range = 0; // max_energy_range_uj
+    uint64_t last = 0;
+  };
+  std::vector<PowerDomain> domains;
+  std::vector<Counter> counters;
+  uint64_t lastReadNs = 0;
+
+  void CloseFds();
+};
+} // namespace Devices
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Devices {
+class LatencyHistogram;
+
+// Планировщик сборщиков на timerfd (CLOCK_MONOTONIC, абсолютные дедлайны).
+// У каждой задачи свой интервал и приоритет; таймер взводится на ближайший
+// дедлайн, так что между срабатываниями процесс спит. Дескриптор можно
+// отдать в любой event loop (QSocketNotifier, epoll) или ждать через Wait().
+// Если timerfd недоступен (GetError() != 0), дескриптор не срабатывает:
+// event loop ждёт GetTimeoutMs() своим таймером, Wait() делает это сам.
+class Scheduler {
+public:
+  using TaskId = size_t;
+  using Callback = std::function<void(uint64_t nowNs)>;
+
+  Scheduler();
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+  ~Scheduler();
+
+  // idleIntervalNs - предел, до которого интервал удваивается, пока
+  // данные задачи никто не смотрит (0 - не замедлять).
+  TaskId AddTask(const std::string &name, uint64_t intervalNs, int priority,
+                 Callback callback, uint64_t idleIntervalNs = 0);
+
+  void SetInterval(TaskId id, uint64_t intervalNs);
+  void SetViewed(TaskId id, bool viewed);
+  bool IsViewed(TaskId id) const;
+  uint64_t GetInterval(TaskId id) const;
+  uint64_t GetCurrentInterval(TaskId id) const;
+  uint64_t GetLastRun(TaskId id) const;
+  // Фактическое время между двумя последними запусками (с учётом джиттера).
+  uint64_t GetLastElapsed(TaskId id) const;
+  const std::string &GetName(TaskId id) const;
+  size_t GetTaskCount() const;
+
+  int GetFd() const;
+  // errno сбоя timerfd_create или timerfd_settime; 0 - таймер работает.
+  int GetError() const;
+  // Миллисекунды до ближайшего дедлайна (с округлением вверх); -1 - задач нет.
+  int GetTimeoutMs() const;
+  // Выполняет просроченные задачи в порядке приоритета и перевзводит таймер.
+  // Возвращает число выполненных задач.
+  size_t RunDue();
+  // Выполняет все задачи немедленно, независимо от дедлайнов.
+  void RunAll();
+  // Ждёт срабатывания таймера не дольше timeoutMs (-1 - бесконечно).
+  bool Wait(int timeoutMs) const;
+
+  static uint64_t Now();
+
+private:
+  struct Task {
+    std::string name;
+    uint64_t intervalNs;
+    uint64_t idleIntervalNs;
+    uint64_t currentIntervalNs;
+    uint64_t nextDueNs;
+    uint64_t lastRunNs;
+    uint64_t lastElapsedNs;
+    int priority;
+    bool viewed;
+    Callback callback;
+    LatencyHistogram *histogram;
+  };
+
+  int timerFd;
+  int error;
+  std::vector<Task> tasks;
+  std::vector<TaskId> due;
+
+  void Run(Task &task, uint64_t nowNs);
+  uint64_t GetNextDue() const;
+  void Arm();
+};
+} // namespace Devices
@@ -0,0 +1,692 @@
+#include "StorageBenchmark.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/aio_abi.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+const size_t alignment = 4096;
+const size_t prefillChunk = 1 << 20;
+
+struct Completion {
+    unsigned slot;
+    int64_t result; // байты или -errno
+};
+
+// Движок ввода-вывода: запросы копятся в Queue, отправляются и
+// собираются одним вызовом Reap - так на круг очереди приходится один
+// системный вызов.
+class IoEngine {
+public:
+    virtual ~IoEngine() = default;
+    virtual void Queue(unsigned slot, bool write, uint64_t offset) = 0;
+    // Число завершений в out или -errno; wait - ждать хотя бы одно.
+    virtual int Reap(bool wait, Completion *out, unsigned max) = 0;
+};
+
+class UringEngine : public IoEngine {
+public:
+    ~UringEngine() override {
+        if (sqes) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqRing && cqRing != sqRing) {
+            munmap(cqRing, cqRingSize);
+        }
+        if (sqRing) {
+            munmap(sqRing, sqRingSize);
+        }
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+    }
+
+    bool Init(int fd, unsigned depth, char *buffers, uint32_t blockSize, std::string &error) {
+        this->fd = fd;
+        this->buffers = buffers;
+        this->blockSize = blockSize;
+
+        io_uring_params params{};
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+        if (ringFd < 0) {
+            error = std::string("io_uring_setup: ") + strerror(errno);
+            return false;
+        }
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+        sqRing = MapRing(sqRingSize, IORING_OFF_SQ_RING);
+        cqRing = single ? sqRing : MapRing(cqRingSize, IORING_OFF_CQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(MapRing(sqesSize, IORING_OFF_SQES));
+        if (!sqRing || !cqRing || !sqes) {
+            error = std::string("io_uring mmap: ") + strerror(errno);
+            return false;
+        }
+
+        char *sq = static_cast<char *>(sqRing);
+        sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        char *cq = static_cast<char *>(cqRing);
+        cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        // Зарегистрированные буферы ядро не отображает на каждый запрос;
+        // без RLIMIT_MEMLOCK регистрация не проходит - тогда обычные readv
+        iovecs.resize(depth);
+        for (unsigned slot = 0; slot < depth; ++slot) {
+            iovecs[slot].iov_base = buffers + static_cast<size_t>(slot) * blockSize;
+            iovecs[slot].iov_len = blockSize;
+        }
+        registered = syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS,
+                             iovecs.data(), depth) == 0;
+        return true;
+    }
+
+    bool IsRegistered() const { return registered; }
+
+    void Queue(unsigned slot, bool write, uint64_t offset) override {
+        unsigned tail = *sqTail;
+        unsigned index = tail & sqMask;
+        io_uring_sqe &sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.fd = fd;
+        sqe.off = offset;
+        sqe.user_data = slot;
+        if (registered) {
+            sqe.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe.addr = reinterpret_cast<uintptr_t>(iovecs[slot].iov_base);
+            sqe.len = blockSize;
+            sqe.buf_index = static_cast<uint16_t>(slot);
+        } else {
+            sqe.opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe.addr = reinterpret_cast<uintptr_t>(&iovecs[slot]);
+            sqe.len = 1;
+        }
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++pending;
+    }
+
+    int Reap(bool wait, Completion *out, unsigned max) override {
+        unsigned head = *cqHead;
+        if (pending > 0 || (wait && head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))) {
+            long submitted = syscall(__NR_io_uring_enter, ringFd, pending, wait ? 1 : 0,
+                                     wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) {
+                    return 0;
+                }
+                return -errno;
+            }
+            pending -= static_cast<unsigned>(submitted);
+        }
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail && count < max; ++head, ++count) {
+            const io_uring_cqe &cqe = cqes[head & cqMask];
+            out[count] = {static_cast<unsigned>(cqe.user_data), cqe.res};
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        return static_cast<int>(count);
+    }
+
+private:
+    int ringFd = -1;
+    int fd = -1;
+    char *buffers = nullptr;
+    uint32_t blockSize = 0;
+    void *sqRing = nullptr;
+    void *cqRing = nullptr;
+    io_uring_sqe *sqes = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+    unsigned *sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe *cqes = nullptr;
+    std::vector<iovec> iovecs;
+    unsigned pending = 0;
+    bool registered = false;
+
+    void *MapRing(size_t size, uint64_t offset) {
+        void *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringFd, static_cast<off_t>(offset));
+        return ring == MAP_FAILED ? nullptr : ring;
+    }
+};
+
+// Нативный AIO ядра (io_setup/io_submit/io_getevents) - то, что
+// оборачивает libaio. Асинхронен только для O_DIRECT.
+class AioEngine : public IoEngine {
+public:
+    ~AioEngine() override {
+        if (context) {
+            syscall(__NR_io_destroy, context);
+        }
+    }
+
+    bool Init(int fd, unsigned depth, char *buffers, uint32_t blockSize, std::string &error) {
+        this->fd = fd;
+        this->buffers = buffers;
+        this->blockSize = blockSize;
+        if (syscall(__NR_io_setup, depth, &context) != 0) {
+            context = 0;
+            error = std::string("io_setup: ") + strerror(errno);
+            return false;
+        }
+        blocks.resize(depth);
+        queued.reserve(depth);
+        events.resize(depth);
+        return true;
+    }
+
+    void Queue(unsigned slot, bool write, uint64_t offset) override {
+        iocb &block = blocks[slot];
+        memset(&block, 0, sizeof(block));
+        block.aio_data = slot;
+        block.aio_lio_opcode = write ? IOCB_CMD_PWRITE : IOCB_CMD_PREAD;
+        block.aio_fildes = static_cast<uint32_t>(fd);
+        block.aio_buf = reinterpret_cast<uintptr_t>(buffers + static_cast<size_t>(slot) * blockSize);
+        block.aio_nbytes = blockSize;
+        block.aio_offset = static_cast<int64_t>(offset);
+        queued.push_back(&block);
+    }
+
+    int Reap(bool wait, Completion *out, unsigned max) override {
+        size_t sent = 0;
+        while (sent < queued.size()) {
+            long result = syscall(__NR_io_submit, context, queued.size() - sent, queued.data() + sent);
+            if (result < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                return -errno;
+            }
+            sent += static_cast<size_t>(result);
+        }
+        queued.clear();
+
+        max = std::min(max, static_cast<unsigned>(events.size()));
+        long got = syscall(__NR_io_getevents, context, wait ? 1 : 0, max, events.data(), nullptr);
+        if (got < 0) {
+            return errno == EINTR ? 0 : -errno;
+        }
+        for (long i = 0; i < got; ++i) {
+            out[i] = {static_cast<unsigned>(events[i].data), events[i].res};
+        }
+        return static_cast<int>(got);
+    }
+
+private:
+    aio_context_t context = 0;
+    int fd = -1;
+    char *buffers = nullptr;
+    uint32_t blockSize = 0;
+    std::vector<iocb> blocks;
+    std::vector<iocb *> queued;
+    std::vector<io_event> events;
+};
+
+// pread/pwrite: глубина очереди 1, запрос выполняется в Reap.
+class SyncEngine : public IoEngine {
+public:
+    SyncEngine(int fd, char *buffer, uint32_t blockSize)
+        : fd(fd), buffer(buffer), blockSize(blockSize) {}
+
+    void Queue(unsigned slot, bool write, uint64_t offset) override {
+        this->slot = slot;
+        this->write = write;
+        this->offset = offset;
+        queued = true;
+    }
+
+    int Reap(bool, Completion *out, unsigned max) override {
+        if (!queued || max == 0) {
+            return 0;
+        }
+        queued = false;
+        ssize_t result = write ? pwrite(fd, buffer, blockSize, static_cast<off_t>(offset))
+                               : pread(fd, buffer, blockSize, static_cast<off_t>(offset));
+        out[0] = {slot, result < 0 ? -errno : result};
+        return 1;
+    }
+
+private:
+    int fd;
+    char *buffer;
+    uint32_t blockSize;
+    unsigned slot = 0;
+    bool write = false;
+    uint64_t offset = 0;
+    bool queued = false;
+};
+
+struct AlignedFree {
+    void operator()(char *memory) const { free(memory); }
+};
+
+uint64_t NextRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+} // namespace
+
+namespace Devices {
+StorageBenchmark::~StorageBenchmark() {
+    Stop();
+    CloseTarget();
+    if (diskStatsFd >= 0) {
+        close(diskStatsFd);
+    }
+}
+
+const char *StorageBenchmark::GetPatternName(Pattern pattern) {
+    switch (pattern) {
+    case Pattern::SequentialRead:
+        return "Sequential read";
+    case Pattern::SequentialWrite:
+        return "Sequential write";
+    case Pattern::RandomRead:
+        return "Random read";
+    default:
+        return "Random write";
+    }
+}
+
+const char *StorageBenchmark::GetEngineName(Engine engine) {
+    switch (engine) {
+    case Engine::Auto:
+        return "Auto";
+    case Engine::IoUring:
+        return "io_uring";
+    case Engine::Aio:
+        return "Linux AIO";
+    default:
+        return "pread/pwrite";
+    }
+}
+
+void StorageBenchmark::CloseTarget() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool StorageBenchmark::Start(const Options &options, std::string &error) {
+    if (IsRunning()) {
+        error = "storage benchmark is already running";
+        return false;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    CloseTarget();
+    if (options.blockSize < 512 || (options.blockSize & (options.blockSize - 1)) != 0) {
+        error = "block size must be a power of two, at least 512 bytes";
+        return false;
+    }
+    if (options.queueDepth == 0 || options.queueDepth > 1024) {
+        error = "queue depth must be 1..1024";
+        return false;
+    }
+
+    bool write = options.pattern == Pattern::SequentialWrite ||
+                 options.pattern == Pattern::RandomWrite;
+    struct stat info{};
+    bool exists = stat(options.path.c_str(), &info) == 0;
+    bool device = exists && S_ISBLK(info.st_mode);
+    bool directory = exists && S_ISDIR(info.st_mode);
+    bool existingFile = exists && S_ISREG(info.st_mode);
+    if (exists && !device && !directory && !existingFile) {
+        error = "target must be a directory, a new file, a regular file or a block device";
+        return false;
+    }
+    if (device && write && !options.allowDeviceWrites) {
+        error = "writing to a block device destroys its data; not allowed";
+        return false;
+    }
+    // Чужой файл только читается, в нём ничего не дописывается
+    if (existingFile && write) {
+        error = options.path + " exists; write tests need a directory or a new file";
+        return false;
+    }
+
+    // Каталог или несуществующий путь - собственный файл теста: он
+    // удаляется сразу после создания и исчезает вместе с дескриптором,
+    // даже если процесс завершится посреди замера
+    bool created = !device && !existingFile;
+    bool direct = true;
+    auto openTarget = [&](const char *path, int flags) {
+        fd = open(path, flags | O_DIRECT, 0600);
+        if (fd < 0 && errno == EINVAL) {
+            // tmpfs и часть FUSE не поддерживают O_DIRECT
+            direct = false;
+            fd = open(path, flags, 0600);
+        }
+    };
+    std::string createdPath;
+    if (device) {
+        openTarget(options.path.c_str(), O_CLOEXEC | (write ? O_RDWR : O_RDONLY));
+    } else if (existingFile) {
+        openTarget(options.path.c_str(), O_CLOEXEC | O_RDONLY);
+    } else if (directory) {
+        openTarget(options.path.c_str(), O_CLOEXEC | O_RDWR | O_TMPFILE);
+        if (fd < 0 && (errno == EOPNOTSUPP || errno == EISDIR)) {
+            // Файловая система без O_TMPFILE: файл с уникальным именем
+            direct = true;
+            createdPath = options.path + "/.ulsm-storage-" + std::to_string(getpid());
+            openTarget(createdPath.c_str(), O_CLOEXEC | O_RDWR | O_CREAT | O_EXCL);
+        }
+    } else {
+        createdPath = options.path;
+        openTarget(createdPath.c_str(), O_CLOEXEC | O_RDWR | O_CREAT | O_EXCL);
+    }
+    if (fd < 0) {
+        error = (createdPath.empty() ? options.path : createdPath) + ": " + strerror(errno);
+        return false;
+    }
+    if (!createdPath.empty()) {
+        unlink(createdPath.c_str());
+    }
+    if (fstat(fd, &info) != 0) {
+        error = options.path + ": " + strerror(errno);
+        CloseTarget();
+        return false;
+    }
+
+    uint64_t span = options.fileSize;
+    if (device) {
+        uint64_t size = 0;
+        if (ioctl(fd, BLKGETSIZE64, &size) != 0) {
+            error = options.path + ": cannot get device size";
+            CloseTarget();
+            return false;
+        }
+        span = size;
+    } else if (existingFile) {
+        span = std::min<uint64_t>(span, static_cast<uint64_t>(info.st_size));
+    }
+    span -= span % options.blockSize;
+    if (span < options.blockSize) {
+        error = "test area is smaller than one block";
+        CloseTarget();
+        return false;
+    }
+
+    dev_t target = device ? info.st_rdev : info.st_dev;
+    deviceMajor = major(target);
+    deviceMinor = minor(target);
+    if (diskStatsFd < 0) {
+        diskStatsFd = open("/proc/diskstats", O_RDONLY | O_CLOEXEC);
+        diskStatsBuffer.resize(64 * 1024);
+    }
+
+    histogram.Reset();
+    iops.Clear();
+    bandwidth.Clear();
+    operations = 0;
+    bytes = 0;
+    errors = 0;
+    elapsedNs = 0;
+    lastOperations = 0;
+    lastBytes = 0;
+    lastSampleNs = Diagnostics::MonotonicNs();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        status = Status();
+        status.direct = direct;
+    }
+    stopRequested = false;
+    running = true;
+    thread = std::thread(&StorageBenchmark::Run, this, options, span, created);
+    return true;
+}
+
+void StorageBenchmark::Stop() {
+    stopRequested = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool StorageBenchmark::IsRunning() const { return running.load(); }
+
+void StorageBenchmark::GetStatus(Status &out) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.engine = status.engine;
+        out.registeredBuffers = status.registeredBuffers;
+        out.direct = status.direct;
+        out.error = status.error;
+    }
+    out.running = IsRunning();
+    out.operations = operations.load(std::memory_order_relaxed);
+    out.bytes = bytes.load(std::memory_order_relaxed);
+    out.errors = errors.load(std::memory_order_relaxed);
+    out.elapsedNs = elapsedNs.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram &StorageBenchmark::GetHistogram() const { return histogram; }
+const History &StorageBenchmark::GetIopsHistory() const { return iops; }
+const History &StorageBenchmark::GetBandwidthHistory() const { return bandwidth; }
+
+void StorageBenchmark::Fail(const std::string &error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    status.error = error;
+}
+
+void StorageBenchmark::Sample(uint64_t nowNs) {
+    if (!IsRunning() || nowNs <= lastSampleNs) {
+        return;
+    }
+    uint64_t currentOperations = operations.load(std::memory_order_relaxed);
+    uint64_t currentBytes = bytes.load(std::memory_order_relaxed);
+    double seconds = (nowNs - lastSampleNs) / 1e9;
+    iops.Push(nowNs, static_cast<float>((currentOperations - lastOperations) / seconds));
+    bandwidth.Push(nowNs, static_cast<float>((currentBytes - lastBytes) / seconds));
+    lastSampleNs = nowNs;
+    lastOperations = currentOperations;
+    lastBytes = currentBytes;
+}
+
+bool StorageBenchmark::GetDiskStats(DiskStats &out) {
+    if (diskStatsFd < 0 || deviceMajor == 0) {
+        return false;
+    }
+    ssize_t got = pread(diskStatsFd, diskStatsBuffer.data(), diskStatsBuffer.size() - 1, 0);
+    if (got <= 0) {
+        return false;
+    }
+    diskStatsBuffer[static_cast<size_t>(got)] = '\0';
+
+    // major minor name reads merged sectors ms writes merged sectors ms
+    // in_flight io_ticks ...
+    char *line = diskStatsBuffer.data();
+    while (*line) {
+        char *end = strchr(line, '\n');
+        if (end) {
+            *end = '\0';
+        }
+        unsigned lineMajor = 0;
+        unsigned lineMinor = 0;
+        char name[sizeof(out.name)] = {};
+        unsigned long long values[11] = {};
+        int fields = sscanf(line, "%u %u %31s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                            &lineMajor, &lineMinor, name, &values[0], &values[1], &values[2],
+                            &values[3], &values[4], &values[5], &values[6], &values[7],
+                            &values[8], &values[9]);
+        if (fields >= 13 && lineMajor == deviceMajor && lineMinor == deviceMinor) {
+            memcpy(out.name, name, sizeof(out.name));
+            out.reads = values[0];
+            out.readSectors = values[2];
+            out.writes = values[4];
+            out.writeSectors = values[6];
+            out.inFlight = values[8];
+            out.ioTicksMs = values[9];
+            return true;
+        }
+        if (!end) {
+            break;
+        }
+        line = end + 1;
+    }
+    return false;
+}
+
+void StorageBenchmark::Run(Options options, uint64_t span, bool prefill) {
+    const bool write = options.pattern == Pattern::SequentialWrite ||
+                       options.pattern == Pattern::RandomWrite;
+    const bool random = options.pattern == Pattern::RandomRead ||
+                        options.pattern == Pattern::RandomWrite;
+    const uint32_t blockSize = options.blockSize;
+    unsigned depth = options.queueDepth;
+
+    // Несжимаемое содержимое: контроллер не должен выигрывать на нулях
+    size_t bufferBytes = std::max<size_t>(static_cast<size_t>(blockSize) * depth, prefillChunk);
+    void *memory = nullptr;
+    if (posix_memalign(&memory, alignment, bufferBytes) != 0) {
+        Fail("cannot allocate I/O buffers");
+        running = false;
+        return;
+    }
+    std::unique_ptr<char, AlignedFree> buffers(static_cast<char *>(memory));
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (size_t i = 0; i + sizeof(uint64_t) <= bufferBytes; i += sizeof(uint64_t)) {
+        uint64_t value = NextRandom(seed);
+        memcpy(buffers.get() + i, &value, sizeof(value));
+    }
+
+    // Собственный файл теста заполняется до тестового размера, иначе
+    // чтения попадали бы в дыры и не доходили до накопителя
+    if (prefill) {
+        for (uint64_t offset = 0; offset < span && !stopRequested; offset += prefillChunk) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(prefillChunk, span - offset));
+            chunk = (chunk + alignment - 1) / alignment * alignment;
+            if (pwrite(fd, buffers.get(), chunk, static_cast<off_t>(offset)) < 0) {
+                Fail(std::string("cannot prepare test file: ") + strerror(errno));
+                running = false;
+                return;
+            }
+        }
+        fdatasync(fd);
+    }
+
+    std::unique_ptr<IoEngine> engine;
+    Engine selected = options.engine;
+    std::string error;
+    bool registered = false;
+    if (selected == Engine::Auto || selected == Engine::IoUring) {
+        auto uring = std::make_unique<UringEngine>();
+        if (uring->Init(fd, depth, buffers.get(), blockSize, error)) {
+            registered = uring->IsRegistered();
+            engine = std::move(uring);
+            selected = Engine::IoUring;
+        }
+    }
+    if (!engine && (selected == Engine::Auto || selected == Engine::Aio)) {
+        auto aio = std::make_unique<AioEngine>();
+        if (aio->Init(fd, depth, buffers.get(), blockSize, error)) {
+            engine = std::move(aio);
+            selected = Engine::Aio;
+        }
+    }
+    if (!engine && (selected == Engine::Auto || selected == Engine::Sync)) {
+        engine = std::make_unique<SyncEngine>(fd, buffers.get(), blockSize);
+        selected = Engine::Sync;
+        depth = 1;
+    }
+    if (!engine) {
+        Fail(error);
+        running = false;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        status.engine = selected;
+        status.registeredBuffers = registered;
+    }
+
+    const uint64_t blocks = span / blockSize;
+    uint64_t sequential = 0;
+    auto nextOffset = [&]() {
+        uint64_t block = random ? NextRandom(seed) % blocks : sequential++ % blocks;
+        return block * blockSize;
+    };
+
+    std::vector<uint64_t> issued(depth);
+    std::vector<Completion> completions(depth);
+    const uint64_t start = Diagnostics::MonotonicNs();
+    const uint64_t end = start + options.durationNs;
+    for (unsigned slot = 0; slot < depth; ++slot) {
+        engine->Queue(slot, write, nextOffset());
+        issued[slot] = start;
+    }
+    unsigned inFlight = depth;
+    bool failed = false;
+    while (inFlight > 0) {
+        int count = engine->Reap(true, completions.data(), depth);
+        if (count == -EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            if (failed) {
+                // Отправленные запросы не удалось дождаться: ядро может
+                // ещё писать в буферы, поэтому они не освобождаются
+                buffers.release();
+                break;
+            }
+            // Новые запросы не отправляются, уже отправленные дожидаются:
+            // буферы освобождаются только после их завершения
+            Fail(std::string("I/O failed: ") + strerror(-count));
+            failed = true;
+            continue;
+        }
+        uint64_t now = Diagnostics::MonotonicNs();
+        bool more = !failed && now < end && !stopRequested.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i) {
+            const Completion &done = completions[i];
+            --inFlight;
+            histogram.Record(now - issued[done.slot]);
+            if (done.result == static_cast<int64_t>(blockSize)) {
+                operations.fetch_add(1, std::memory_order_relaxed);
+                bytes.fetch_add(blockSize, std::memory_order_relaxed);
+            } else {
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (more) {
+                engine->Queue(done.slot, write, nextOffset());
+                issued[done.slot] = now;
+                ++inFlight;
+            }
+        }
+        elapsedNs.store(now - start, std::memory_order_relaxed);
+    }
+    running = false;
+}
+} // namespace Devices
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "History.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Devices {
+// Нагрузочный тест CPU: по рабочему потоку на каждый выбранный
+// логический процессор, поток закреплён за ним через affinity. Ядро
+// вычислений (скалярное, SSE, AVX2, AVX-512) выбирается при запуске по
+// возможностям процессора. Уровень нагрузки - скважность в периодах по
+// 100 мс: поток считает loadPercent периода и спит остаток.
+class StressTest {
+public:
+  enum class Kernel { Auto, Scalar, SSE, AVX2, AVX512 };
+  // Float - цепочки FMA (FLOPS), Integer - сложения/сдвиги (IOPS).
+  enum class Workload { Float, Integer };
+
+  struct Options {
+    Kernel kernel = Kernel::Auto;
+    Workload workload = Workload::Float;
+    unsigned loadPercent = 100;
+    uint64_t durationNs = 60ull * 1000000000ull;
+    // Пусто - все процессоры, доступные процессу.
+    std::vector<unsigned> cpus;
+  };
+
+  struct WorkerResult {
+    unsigned cpu;
+    uint64_t operations; // FLOP или целочисленные операции
+    uint64_t busyNs;     // время счёта без пауз скважности
+    // 0 или код ошибки pthread_setaffinity_np: поток не закреплён за
+    // cpu и мог считать на другом ядре.
+    int affinityError;
+    // Производительность потока в активной части периода.
+    double GetGigaOpsPerSecond() const;
+  };
+
+  static constexpr size_t historyCapacity = 1 << 14;
+
+  StressTest();
+  ~StressTest();
+  StressTest(const StressTest &) = delete;
+  StressTest &operator=(const StressTest &) = delete;
+
+  static bool IsSupported(Kernel kernel);
+  static Kernel GetBestKernel();
+  static const char *GetKernelName(Kernel kernel);
+
+  // false и причина в error, если тест уже идёт или ядро недоступно.
+  bool Start(const Options &options, std::string &error);
+  void Stop();
+  // Тест завершается сам по истечении durationNs; IsRunning это видит.
+  bool IsRunning() const;
+  Kernel GetKernel() const;
+  Workload GetWorkload() const;
+
+  // Вызывается владельцем на каждом замере, пока идёт тест: пишет
+  // суммарную производительность с прошлого вызова и переданные
+  // частоту, температуру и мощность пакетов в кривые прогона.
+  void Sample(uint64_t nowNs, double frequencyMHz, double temperatureC, double watts);
+  void GetResults(std::vector<WorkerResult> &out) const;
+  const History &GetThroughputHistory() const; // GOPS всех потоков
+  const History &GetFrequencyHistory() const;  // МГц, среднее по потокам
+  const History &GetTemperatureHistory() const;
+  const History &GetPowerHistory() const; // Вт, сумма пакетов
+  // Операций на джоуль за прогон; 0 - мощность не измерялась (нет RAPL).
+  double GetOpsPerJoule() const;
+
+private:
+  struct Worker {
+    unsigned cpu = 0;
+    std::thread thread;
+    std::atomic<uint64_t> operations{0};
+    std::atomic<uint64_t> busyNs{0};
+    std::atomic<int> affinityError{0};
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<bool> stopRequested;
+  std::atomic<unsigned> activeWorkers;
+  Kernel kernel;
+  Workload workload;
+  uint64_t lastSampleNs;
+  uint64_t lastOperations;
+  History throughput;
+  History frequency;
+  History temperature;
+  History power;
+  double energyJoules;
+  uint64_t measuredOperations; // операции за интервалы с известной мощностью
+
+  void Join();
+  static void Run(Worker &worker, Kernel kernel, Workload workload,
+                  unsigned loadPercent, uint64_t endNs,
+                  const std::atomic<bool> &stop, std::atomic<unsigned> &active);
+};
+} // namespace Devices
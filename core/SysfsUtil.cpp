@@ -0,0 +1,32 @@
+#include "SysfsUtil.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Devices {
+ssize_t ReadSmallFile(const char *path, char *buffer, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    size_t total = 0;
+    ssize_t got = 0;
+    // Файлы /proc отдаются кусками, read повторяется до конца файла
+    while (total + 1 < size && (got = read(fd, buffer + total, size - 1 - total)) > 0) {
+        total += static_cast<size_t>(got);
+    }
+    close(fd);
+    if (got < 0 && total == 0) {
+        return -1;
+    }
+    buffer[total] = '\0';
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t ReadSysfsValue(const char *path, char *buffer, size_t size) {
+    ssize_t got = ReadSmallFile(path, buffer, size);
+    while (got > 0 && (buffer[got - 1] == '\n' || buffer[got - 1] == ' ')) {
+        buffer[--got] = '\0';
+    }
+    return got;
+}
+} // namespace Devices
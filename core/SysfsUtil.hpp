@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <sys/types.h>
+
+namespace Devices {
+// Читает файл целиком (до size - 1 байт) в буфер вызывающего без
+// аллокаций и дописывает '\0'; -1 - файл не открылся или ничего не
+// прочиталось из-за ошибки. Трассу входов не ведёт: замеры сборщиков
+// оборачивают чтение в TracedRead сами (ReadFile в SysMonCore).
+ssize_t ReadSmallFile(const char *path, char *buffer, size_t size);
+// Одно значение sysfs ("48K\n", "0-7\n"): как ReadSmallFile, но без
+// перевода строки и пробелов в конце.
+ssize_t ReadSysfsValue(const char *path, char *buffer, size_t size);
+} // namespace Devices
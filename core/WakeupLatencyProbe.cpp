@@ -0,0 +1,146 @@
+#include "WakeupLatencyProbe.hpp"
+#include <cerrno>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+
+namespace Devices {
+WakeupLatencyProbe::~WakeupLatencyProbe() { Stop(); }
+
+bool WakeupLatencyProbe::Start(const Options &options, std::string &error) {
+    if (IsRunning()) {
+        error = "wake-up latency probe is already running";
+        return false;
+    }
+    if (options.intervalNs < 10000) {
+        error = "interval must be at least 10 us";
+        return false;
+    }
+
+    std::vector<unsigned> cpus = options.cpus;
+    if (cpus.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    }
+    if (cpus.empty()) {
+        error = "no CPUs available";
+        return false;
+    }
+
+    workers.clear();
+    stopRequested = false;
+    realtimeFailures = 0;
+    realtimeRequested = options.priority > 0;
+    running = true;
+    for (unsigned cpu : cpus) {
+        workers.push_back(std::make_unique<Worker>());
+        Worker &worker = *workers.back();
+        worker.cpu = cpu;
+        worker.thread = std::thread(Run, std::ref(worker), options.intervalNs, options.priority,
+                                    std::cref(stopRequested), std::ref(realtimeFailures));
+    }
+    return true;
+}
+
+void WakeupLatencyProbe::Stop() {
+    stopRequested = true;
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    running = false;
+}
+
+bool WakeupLatencyProbe::IsRunning() const { return running.load(); }
+
+bool WakeupLatencyProbe::IsRealtime() const {
+    return realtimeRequested && realtimeFailures.load() == 0;
+}
+
+size_t WakeupLatencyProbe::GetCpuCount() const { return workers.size(); }
+unsigned WakeupLatencyProbe::GetCpu(size_t index) const { return workers[index]->cpu; }
+int WakeupLatencyProbe::GetAffinityError(size_t index) const {
+    return workers[index]->affinityError.load(std::memory_order_relaxed);
+}
+int WakeupLatencyProbe::GetSleepError(size_t index) const {
+    return workers[index]->sleepError.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram &WakeupLatencyProbe::GetHistogram(size_t index) const {
+    return workers[index]->histogram;
+}
+
+const History &WakeupLatencyProbe::GetHistory(size_t index) const {
+    return workers[index]->history;
+}
+
+void WakeupLatencyProbe::Sample(uint64_t nowNs) {
+    if (!IsRunning()) {
+        return;
+    }
+    for (auto &worker : workers) {
+        uint64_t maximum = worker->intervalMax.exchange(0, std::memory_order_relaxed);
+        worker->history.Push(nowNs, static_cast<float>(maximum / 1000.0));
+    }
+}
+
+void WakeupLatencyProbe::Run(Worker &worker, uint64_t intervalNs, int priority,
+                             const std::atomic<bool> &stop,
+                             std::atomic<unsigned> &realtimeFailures) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker.cpu, &set);
+    worker.affinityError.store(pthread_setaffinity_np(pthread_self(), sizeof(set), &set),
+                               std::memory_order_relaxed);
+    if (priority > 0) {
+        sched_param param{};
+        param.sched_priority = priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+            realtimeFailures.fetch_add(1);
+        }
+    }
+
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t deadline = static_cast<uint64_t>(now.tv_sec) * 1000000000ull +
+                        static_cast<uint64_t>(now.tv_nsec) + intervalNs;
+    while (!stop.load(std::memory_order_relaxed)) {
+        timespec target{};
+        target.tv_sec = static_cast<time_t>(deadline / 1000000000ull);
+        target.tv_nsec = static_cast<long>(deadline % 1000000000ull);
+        int result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr);
+        if (result == EINTR) {
+            continue; // прерван сигналом: срок тот же
+        }
+        if (result != 0) {
+            // Повтор без сна - вечный цикл, под SCHED_FIFO занимающий ядро
+            worker.sleepError.store(result, std::memory_order_relaxed);
+            return;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t woke = static_cast<uint64_t>(now.tv_sec) * 1000000000ull +
+                        static_cast<uint64_t>(now.tv_nsec);
+        uint64_t latency = woke > deadline ? woke - deadline : 0;
+        worker.histogram.Record(latency);
+        uint64_t maximum = worker.intervalMax.load(std::memory_order_relaxed);
+        while (latency > maximum &&
+               !worker.intervalMax.compare_exchange_weak(maximum, latency,
+                                                         std::memory_order_relaxed)) {
+        }
+
+        // После долгой задержки пропущенные сроки не догоняются пачкой
+        deadline += intervalNs;
+        if (deadline <= woke) {
+            deadline = woke - (woke - deadline) % intervalNs + intervalNs;
+        }
+    }
+}
+} // namespace Devices
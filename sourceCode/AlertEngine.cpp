@@ -0,0 +1,377 @@
+#include "AlertEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+                             text.back() == '\r' || text.back() == '\n')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool IsNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '.';
+}
+
+std::string_view TakeName(std::string_view &text) {
+    text = Trim(text);
+    size_t length = 0;
+    while (length < text.size() && IsNameChar(text[length])) {
+        ++length;
+    }
+    std::string_view name = text.substr(0, length);
+    text.remove_prefix(length);
+    return name;
+}
+
+bool TakeChar(std::string_view &text, char c) {
+    text = Trim(text);
+    if (text.empty() || text.front() != c) {
+        return false;
+    }
+    text.remove_prefix(1);
+    return true;
+}
+
+bool TakeNumber(std::string_view &text, double &number) {
+    text = Trim(text);
+    std::string buffer(text.substr(0, 64));
+    char *end = nullptr;
+    number = strtod(buffer.c_str(), &end);
+    if (end == buffer.c_str()) {
+        return false;
+    }
+    text.remove_prefix(static_cast<size_t>(end - buffer.c_str()));
+    return true;
+}
+
+// "500ms", "30s", "5m", "1h"; без единицы - секунды.
+bool TakeDuration(std::string_view &text, uint64_t &ns) {
+    double number = 0;
+    if (!TakeNumber(text, number) || number < 0) {
+        return false;
+    }
+    double scale = 1e9;
+    if (text.substr(0, 2) == "ms") {
+        scale = 1e6;
+        text.remove_prefix(2);
+    } else if (!text.empty() && text.front() == 's') {
+        text.remove_prefix(1);
+    } else if (!text.empty() && text.front() == 'm') {
+        scale = 60e9;
+        text.remove_prefix(1);
+    } else if (!text.empty() && text.front() == 'h') {
+        scale = 3600e9;
+        text.remove_prefix(1);
+    }
+    ns = static_cast<uint64_t>(number * scale);
+    return true;
+}
+} // namespace
+
+namespace Devices {
+AlertEngine::AlertEngine()
+    : events(eventCapacity), eventSequence(0), firingCount(0), nextListener(1),
+      log(nullptr) {}
+
+uint32_t AlertEngine::RegisterMetric(std::string_view name) {
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        if (metrics[i] == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    metrics.emplace_back(name);
+    rulesByMetric.emplace_back();
+    return static_cast<uint32_t>(metrics.size() - 1);
+}
+
+size_t AlertEngine::GetMetricCount() const { return metrics.size(); }
+
+bool AlertEngine::AddRule(std::string_view text, std::string &error) {
+    Rule rule{};
+    rule.text = std::string(Trim(text));
+    std::string_view rest = rule.text;
+
+    // Необязательное имя перед двоеточием
+    size_t colon = rest.find(':');
+    if (colon != std::string_view::npos) {
+        std::string_view name = Trim(rest.substr(0, colon));
+        if (name.empty() || !std::all_of(name.begin(), name.end(), IsNameChar)) {
+            error = "invalid rule name";
+            return false;
+        }
+        rule.name = std::string(name);
+        rest.remove_prefix(colon + 1);
+    }
+
+    std::string_view word = TakeName(rest);
+    std::string_view metric = word;
+    rule.aggregate = Aggregate::Value;
+    if (TakeChar(rest, '(')) {
+        if (word == "rate") {
+            rule.aggregate = Aggregate::Rate;
+        } else if (word == "ewma") {
+            rule.aggregate = Aggregate::Ewma;
+        } else if (word == "min") {
+            rule.aggregate = Aggregate::Min;
+        } else if (word == "max") {
+            rule.aggregate = Aggregate::Max;
+        } else {
+            error = "unknown function '" + std::string(word) + "'";
+            return false;
+        }
+        metric = TakeName(rest);
+        if (rule.aggregate != Aggregate::Value && rule.aggregate != Aggregate::Rate) {
+            if (!TakeChar(rest, ',') || !TakeDuration(rest, rule.windowNs) ||
+                rule.windowNs == 0) {
+                error = "expected window duration, e.g. " + std::string(word) +
+                        "(" + std::string(metric) + ", 30s)";
+                return false;
+            }
+        }
+        if (!TakeChar(rest, ')')) {
+            error = "expected ')'";
+            return false;
+        }
+    }
+
+    auto found = std::find(metrics.begin(), metrics.end(), metric);
+    if (metric.empty() || found == metrics.end()) {
+        error = "unknown metric '" + std::string(metric) + "'";
+        return false;
+    }
+    rule.metric = static_cast<uint32_t>(found - metrics.begin());
+
+    rest = Trim(rest);
+    if (rest.substr(0, 2) == ">=") {
+        rule.comparison = Comparison::GreaterEqual;
+        rest.remove_prefix(2);
+    } else if (rest.substr(0, 2) == "<=") {
+        rule.comparison = Comparison::LessEqual;
+        rest.remove_prefix(2);
+    } else if (TakeChar(rest, '>')) {
+        rule.comparison = Comparison::Greater;
+    } else if (TakeChar(rest, '<')) {
+        rule.comparison = Comparison::Less;
+    } else {
+        error = "expected comparison (>, >=, <, <=)";
+        return false;
+    }
+    if (!TakeNumber(rest, rule.threshold)) {
+        error = "expected threshold";
+        return false;
+    }
+    // Процентные метрики уже в процентах, знак допускается для читаемости
+    TakeChar(rest, '%');
+
+    std::string_view keyword = TakeName(rest);
+    if (!keyword.empty()) {
+        if (keyword != "for" || !TakeDuration(rest, rule.forNs)) {
+            error = "expected duration after 'for'";
+            return false;
+        }
+    }
+    if (!Trim(rest).empty()) {
+        error = "unexpected '" + std::string(Trim(rest)) + "'";
+        return false;
+    }
+
+    if (rule.name.empty()) {
+        rule.name = "rule" + std::to_string(rules.size() + 1);
+    }
+    uint32_t id = static_cast<uint32_t>(rules.size());
+    rulesByMetric[rule.metric].push_back(id);
+    rules.push_back(std::move(rule));
+    return true;
+}
+
+size_t AlertEngine::LoadRules(const char *path, std::ostream &errors) {
+    std::ifstream file(path);
+    size_t loaded = 0;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); ++number) {
+        std::string_view text = Trim(line);
+        size_t comment = text.find('#');
+        if (comment != std::string_view::npos) {
+            text = Trim(text.substr(0, comment));
+        }
+        if (text.empty()) {
+            continue;
+        }
+        std::string error;
+        if (AddRule(text, error)) {
+            ++loaded;
+        } else {
+            errors << path << ":" << number << ": " << error << "\n";
+        }
+    }
+    return loaded;
+}
+
+void AlertEngine::ClearRules() {
+    rules.clear();
+    for (auto &list : rulesByMetric) {
+        list.clear();
+    }
+    firingCount = 0;
+}
+
+bool AlertEngine::Evaluate(Rule &rule, uint64_t timeNs, double sample) {
+    switch (rule.aggregate) {
+    case Aggregate::Value:
+        rule.value = sample;
+        rule.hasValue = true;
+        break;
+    case Aggregate::Rate:
+        // Изменение в единицах метрики за секунду
+        if (rule.hasPrevious && timeNs > rule.previousNs) {
+            rule.value = (sample - rule.previous) / ((timeNs - rule.previousNs) / 1e9);
+            rule.hasValue = true;
+        }
+        break;
+    case Aggregate::Ewma:
+        // Постоянная времени - окно правила, так что неравномерные
+        // интервалы (планировщик замедляет невидимые сборщики) учтены
+        if (!rule.hasValue) {
+            rule.value = sample;
+        } else if (timeNs > rule.previousNs) {
+            double alpha = 1 - std::exp(-static_cast<double>(timeNs - rule.previousNs) /
+                                        rule.windowNs);
+            rule.value += alpha * (sample - rule.value);
+        }
+        rule.hasValue = true;
+        break;
+    case Aggregate::Min:
+    case Aggregate::Max: {
+        // Окно из windowBuckets корзин: устаревшая корзина затирается
+        // первым попавшим в неё замером, память не зависит от частоты
+        uint64_t width = std::max<uint64_t>(1, rule.windowNs / windowBuckets);
+        uint64_t epoch = timeNs / width + 1;
+        size_t slot = epoch % windowBuckets;
+        float value = static_cast<float>(sample);
+        if (rule.bucketEpoch[slot] != epoch) {
+            rule.bucketEpoch[slot] = epoch;
+            rule.bucketMin[slot] = value;
+            rule.bucketMax[slot] = value;
+        } else {
+            rule.bucketMin[slot] = std::min(rule.bucketMin[slot], value);
+            rule.bucketMax[slot] = std::max(rule.bucketMax[slot], value);
+        }
+        bool minimum = rule.aggregate == Aggregate::Min;
+        double result = value;
+        for (size_t i = 0; i < windowBuckets; ++i) {
+            if (rule.bucketEpoch[i] != 0 && rule.bucketEpoch[i] + windowBuckets > epoch) {
+                result = minimum ? std::min<double>(result, rule.bucketMin[i])
+                                 : std::max<double>(result, rule.bucketMax[i]);
+            }
+        }
+        rule.value = result;
+        rule.hasValue = true;
+        break;
+    }
+    }
+    rule.previous = sample;
+    rule.previousNs = timeNs;
+    rule.hasPrevious = true;
+
+    if (!rule.hasValue) {
+        return false;
+    }
+    switch (rule.comparison) {
+    case Comparison::Greater:
+        return rule.value > rule.threshold;
+    case Comparison::GreaterEqual:
+        return rule.value >= rule.threshold;
+    case Comparison::Less:
+        return rule.value < rule.threshold;
+    case Comparison::LessEqual:
+        return rule.value <= rule.threshold;
+    }
+    return false;
+}
+
+void AlertEngine::Sample(uint32_t metric, uint64_t timeNs, double value) {
+    if (metric >= rulesByMetric.size()) {
+        return;
+    }
+    for (uint32_t id : rulesByMetric[metric]) {
+        Rule &rule = rules[id];
+        bool holds = Evaluate(rule, timeNs, value);
+        if (!holds) {
+            rule.pending = false;
+            if (rule.firing) {
+                rule.firing = false;
+                --firingCount;
+                Emit(id, false, timeNs);
+            }
+            continue;
+        }
+        if (!rule.pending) {
+            rule.pending = true;
+            rule.trueSinceNs = timeNs;
+        }
+        if (!rule.firing && timeNs - rule.trueSinceNs >= rule.forNs) {
+            rule.firing = true;
+            ++firingCount;
+            Emit(id, true, timeNs);
+        }
+    }
+}
+
+void AlertEngine::Emit(uint32_t rule, bool firing, uint64_t timeNs) {
+    Event event{rule, firing, timeNs, rules[rule].value};
+    events[eventSequence % eventCapacity] = event;
+    ++eventSequence;
+
+    if (log) {
+        *log << "ULSM alert " << (firing ? "FIRING " : "resolved ")
+             << rules[rule].text
+             << " (value " << event.value << ")" << std::endl;
+    }
+    for (const auto &listener : listeners) {
+        listener.second(event);
+    }
+}
+
+size_t AlertEngine::GetRuleCount() const { return rules.size(); }
+const std::string &AlertEngine::GetRuleName(uint32_t rule) const {
+    return rules[rule].name;
+}
+const std::string &AlertEngine::GetRuleText(uint32_t rule) const {
+    return rules[rule].text;
+}
+bool AlertEngine::IsFiring(uint32_t rule) const { return rules[rule].firing; }
+double AlertEngine::GetValue(uint32_t rule) const { return rules[rule].value; }
+size_t AlertEngine::GetFiringCount() const { return firingCount; }
+
+uint64_t AlertEngine::GetEventSequence() const { return eventSequence; }
+
+void AlertEngine::EventsSince(uint64_t sequence, std::vector<Event> &out) const {
+    out.clear();
+    uint64_t oldest = eventSequence > eventCapacity ? eventSequence - eventCapacity : 0;
+    for (uint64_t i = std::max(sequence, oldest); i < eventSequence; ++i) {
+        out.push_back(events[i % eventCapacity]);
+    }
+}
+
+size_t AlertEngine::Subscribe(Listener listener) {
+    listeners.emplace_back(nextListener, std::move(listener));
+    return nextListener++;
+}
+
+void AlertEngine::Unsubscribe(size_t id) {
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [id](const auto &entry) { return entry.first == id; }),
+                    listeners.end());
+}
+
+void AlertEngine::SetLog(std::ostream *log) { this->log = log; }
+} // namespace Devices
@@ -0,0 +1,186 @@
+#include "CoreLatencyTest.hpp"
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ULSM_X86 1
+#endif
+
+namespace {
+// Флаг и команда ответному потоку в разных строках кэша: в замер
+// попадает перенос только одной строки.
+struct alignas(64) Line {
+    std::atomic<uint64_t> value{0};
+};
+
+struct Shared {
+    Line flag;
+    Line command; // номер задания, UINT64_MAX - завершение
+    Line ready;
+    unsigned cpu = 0;
+    uint64_t roundTrips = 0;
+};
+
+inline void Pause() {
+#ifdef ULSM_X86
+    _mm_pause();
+#endif
+}
+
+bool PinToCpu(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Ответный поток: закрепляется за заданным CPU и на каждое нечётное
+// значение флага отвечает следующим чётным.
+void Pong(Shared &shared) {
+    uint64_t seen = 0;
+    for (;;) {
+        uint64_t job;
+        while ((job = shared.command.value.load(std::memory_order_acquire)) == seen) {
+            std::this_thread::yield();
+        }
+        seen = job;
+        if (job == UINT64_MAX) {
+            return;
+        }
+        bool pinned = PinToCpu(shared.cpu);
+        shared.ready.value.store(pinned ? job : UINT64_MAX, std::memory_order_release);
+        if (!pinned) {
+            continue;
+        }
+        uint64_t expected = 1;
+        for (uint64_t round = 0; round < shared.roundTrips; ++round) {
+            while (shared.flag.value.load(std::memory_order_acquire) != expected) {
+                Pause();
+            }
+            shared.flag.value.store(expected + 1, std::memory_order_release);
+            expected += 2;
+        }
+    }
+}
+} // namespace
+
+namespace Devices {
+CoreLatencyTest::~CoreLatencyTest() { Stop(); }
+
+bool CoreLatencyTest::Start(const std::vector<unsigned> &cpus, std::string &error) {
+    if (IsRunning()) {
+        error = "core latency test is already running";
+        return false;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::vector<unsigned> selected = cpus;
+    if (selected.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    selected.push_back(cpu);
+                }
+            }
+        }
+    }
+    if (selected.size() < 2) {
+        error = "at least two CPUs are required";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        measuredCpus = std::move(selected);
+        latencies.assign(measuredCpus.size() * measuredCpus.size(), -1.0f);
+    }
+    stopRequested = false;
+    progress = 0;
+    running = true;
+    thread = std::thread(&CoreLatencyTest::Run, this);
+    return true;
+}
+
+void CoreLatencyTest::Stop() {
+    stopRequested = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool CoreLatencyTest::IsRunning() const { return running.load(); }
+unsigned CoreLatencyTest::GetProgress() const { return progress.load(); }
+
+void CoreLatencyTest::GetMatrix(std::vector<unsigned> &cpus, std::vector<float> &matrix) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    cpus.assign(measuredCpus.begin(), measuredCpus.end());
+    matrix.assign(latencies.begin(), latencies.end());
+}
+
+void CoreLatencyTest::Run() {
+    // Список меняется только в Start, пока поток не запущен
+    const std::vector<unsigned> cpus = measuredCpus;
+    const size_t count = cpus.size();
+    const size_t pairs = count * (count - 1) / 2;
+
+    Shared shared;
+    shared.roundTrips = static_cast<uint64_t>(roundTripsPerBatch) * batches;
+    std::thread responder(Pong, std::ref(shared));
+
+    size_t done = 0;
+    uint64_t job = 0;
+    for (size_t first = 0; first < count && !stopRequested; ++first) {
+        bool pinned = PinToCpu(cpus[first]);
+        for (size_t second = first + 1; second < count && !stopRequested; ++second) {
+            progress = static_cast<unsigned>(done++ * 100 / pairs);
+            if (!pinned) {
+                continue;
+            }
+            shared.flag.value.store(0, std::memory_order_relaxed);
+            shared.cpu = cpus[second];
+            shared.command.value.store(++job, std::memory_order_release);
+            uint64_t answer;
+            while ((answer = shared.ready.value.load(std::memory_order_acquire)) != job &&
+                   answer != UINT64_MAX) {
+                std::this_thread::yield();
+            }
+            if (answer == UINT64_MAX) {
+                shared.ready.value.store(0, std::memory_order_relaxed);
+                continue;
+            }
+
+            uint64_t value = 1;
+            uint64_t best = UINT64_MAX;
+            for (unsigned batch = 0; batch < batches; ++batch) {
+                uint64_t start = Diagnostics::MonotonicNs();
+                for (unsigned round = 0; round < roundTripsPerBatch; ++round) {
+                    shared.flag.value.store(value, std::memory_order_release);
+                    while (shared.flag.value.load(std::memory_order_acquire) != value + 1) {
+                        Pause();
+                    }
+                    value += 2;
+                }
+                best = std::min(best, Diagnostics::MonotonicNs() - start);
+            }
+            float oneWay = static_cast<float>(best) / (2.0f * roundTripsPerBatch);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies[first * count + second] = oneWay;
+                latencies[second * count + first] = oneWay;
+            }
+        }
+    }
+
+    shared.command.value.store(UINT64_MAX, std::memory_order_release);
+    responder.join();
+    progress = 100;
+    running = false;
+}
+} // namespace Devices
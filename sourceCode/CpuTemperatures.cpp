@@ -0,0 +1,232 @@
+#include "CpuTemperatures.hpp"
+#include "InputTrace.hpp"
+#include "SysfsUtil.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+// Датчики одного hwmon-устройства процессора.
+struct Chip {
+    std::string directory;
+    std::string device; // PCI-адрес из ссылки device, для порядка k10temp
+    bool amd = false;
+    int32_t package = -1;
+    int packageSensor = -1;
+    int tctlSensor = -1;
+    std::vector<std::pair<int32_t, int>> cores; // core_id -> датчик
+    std::vector<std::pair<int32_t, int>> ccds;  // номер TccdN -> датчик
+};
+} // namespace
+
+namespace Devices {
+CpuTemperatures::~CpuTemperatures() { CloseFds(); }
+
+void CpuTemperatures::CloseFds() {
+    for (Sensor &sensor : sensors) {
+        if (sensor.fd >= 0) {
+            close(sensor.fd);
+        }
+    }
+    sensors.clear();
+}
+
+void CpuTemperatures::Load(const char *root, const CpuTopology &topology) {
+    CloseFds();
+    packageSensors.clear();
+    cpuSensors.assign(topology.GetCpuCount(), -1);
+
+    char path[512];
+    char buffer[64];
+    snprintf(path, sizeof(path), "%s/class/hwmon", root);
+    std::vector<Chip> chips;
+    if (DIR *directory = opendir(path)) {
+        while (dirent *entry = readdir(directory)) {
+            if (strncmp(entry->d_name, "hwmon", 5) != 0) {
+                continue;
+            }
+            Chip chip;
+            chip.directory = std::string(path) + "/" + entry->d_name;
+            if (ReadSysfsValue((chip.directory + "/name").c_str(), buffer, sizeof(buffer)) <= 0) {
+                continue;
+            }
+            if (strcmp(buffer, "k10temp") == 0 || strcmp(buffer, "zenpower") == 0) {
+                chip.amd = true;
+            } else if (strcmp(buffer, "coretemp") != 0) {
+                continue;
+            }
+            char link[256];
+            ssize_t length = readlink((chip.directory + "/device").c_str(), link, sizeof(link) - 1);
+            if (length > 0) {
+                link[length] = '\0';
+                const char *slash = strrchr(link, '/');
+                chip.device = slash ? slash + 1 : link;
+            }
+            chips.push_back(std::move(chip));
+        }
+        closedir(directory);
+    }
+    std::sort(chips.begin(), chips.end(), [](const Chip &a, const Chip &b) {
+        return a.device != b.device ? a.device < b.device : a.directory < b.directory;
+    });
+
+    auto openSensor = [this](const std::string &input) {
+        int fd = open(input.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        Sensor sensor;
+        sensor.fd = fd;
+        sensors.push_back(sensor);
+        return static_cast<int>(sensors.size() - 1);
+    };
+
+    for (Chip &chip : chips) {
+        DIR *directory = opendir(chip.directory.c_str());
+        if (!directory) {
+            continue;
+        }
+        bool labelled = false;
+        while (dirent *entry = readdir(directory)) {
+            unsigned index = 0;
+            char suffix[8] = {};
+            if (sscanf(entry->d_name, "temp%u_%7s", &index, suffix) != 2 ||
+                strcmp(suffix, "label") != 0) {
+                continue;
+            }
+            std::string prefix = chip.directory + "/temp" + std::to_string(index);
+            if (ReadSysfsValue((prefix + "_label").c_str(), buffer, sizeof(buffer)) <= 0) {
+                continue;
+            }
+            labelled = true;
+            int number = 0;
+            if (sscanf(buffer, "Package id %d", &number) == 1) {
+                chip.package = number;
+                chip.packageSensor = openSensor(prefix + "_input");
+            } else if (sscanf(buffer, "Core %d", &number) == 1) {
+                int sensor = openSensor(prefix + "_input");
+                if (sensor >= 0) {
+                    chip.cores.emplace_back(number, sensor);
+                }
+            } else if (sscanf(buffer, "Tccd%d", &number) == 1) {
+                int sensor = openSensor(prefix + "_input");
+                if (sensor >= 0) {
+                    chip.ccds.emplace_back(number, sensor);
+                }
+            } else if (strcmp(buffer, "Tdie") == 0) {
+                // Tctl у части моделей смещён для вентиляторов, Tdie - нет
+                chip.packageSensor = openSensor(prefix + "_input");
+            } else if (strcmp(buffer, "Tctl") == 0) {
+                chip.tctlSensor = openSensor(prefix + "_input");
+            }
+        }
+        closedir(directory);
+        if (chip.packageSensor < 0) {
+            chip.packageSensor = chip.tctlSensor;
+        }
+        // Старые k10temp отдают единственный temp1 без метки
+        if (!labelled && chip.amd) {
+            chip.packageSensor = openSensor(chip.directory + "/temp1_input");
+        }
+        std::sort(chip.ccds.begin(), chip.ccds.end());
+    }
+
+    // Пакеты без "Package id" в метке раздаются по порядку PCI-адресов
+    std::vector<int32_t> packages;
+    for (size_t cpu = 0; cpu < topology.GetCpuCount(); ++cpu) {
+        packages.push_back(topology.GetPlacement(cpu).package);
+    }
+    std::sort(packages.begin(), packages.end());
+    packages.erase(std::unique(packages.begin(), packages.end()), packages.end());
+    for (const Chip &chip : chips) {
+        packages.erase(std::remove(packages.begin(), packages.end(), chip.package), packages.end());
+    }
+    size_t next = 0;
+    for (Chip &chip : chips) {
+        if (chip.package < 0 && next < packages.size()) {
+            chip.package = packages[next++];
+        }
+        if (chip.package < 0) {
+            continue;
+        }
+        if (packageSensors.size() <= static_cast<size_t>(chip.package)) {
+            packageSensors.resize(static_cast<size_t>(chip.package) + 1, -1);
+        }
+        packageSensors[static_cast<size_t>(chip.package)] = chip.packageSensor;
+    }
+
+    for (const Chip &chip : chips) {
+        if (chip.package < 0) {
+            continue;
+        }
+        // Группы L3 пакета по возрастанию: i-я соответствует Tccd(i+1)
+        std::vector<int32_t> groups;
+        for (size_t cpu = 0; cpu < topology.GetCpuCount(); ++cpu) {
+            const CpuPlacement &placement = topology.GetPlacement(cpu);
+            if (placement.package == chip.package) {
+                groups.push_back(placement.llc);
+            }
+        }
+        std::sort(groups.begin(), groups.end());
+        groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+        bool perGroup = !chip.ccds.empty() && chip.ccds.size() == groups.size();
+
+        for (size_t cpu = 0; cpu < topology.GetCpuCount(); ++cpu) {
+            const CpuPlacement &placement = topology.GetPlacement(cpu);
+            if (placement.package != chip.package) {
+                continue;
+            }
+            int sensor = chip.packageSensor;
+            for (const std::pair<int32_t, int> &core : chip.cores) {
+                if (core.first == placement.core) {
+                    sensor = core.second;
+                    break;
+                }
+            }
+            if (perGroup) {
+                size_t group = static_cast<size_t>(
+                    std::lower_bound(groups.begin(), groups.end(), placement.llc) - groups.begin());
+                sensor = chip.ccds[group].second;
+            }
+            cpuSensors[cpu] = sensor;
+        }
+    }
+}
+
+void CpuTemperatures::Read() {
+    char buffer[24];
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        Sensor &sensor = sensors[i];
+        ssize_t got = TracedRead("temp", i, buffer, sizeof(buffer) - 1, [&sensor, &buffer]() {
+            return pread(sensor.fd, buffer, sizeof(buffer) - 1, 0);
+        });
+        if (got <= 0) {
+            sensor.value = 0;
+            continue;
+        }
+        buffer[got] = '\0';
+        sensor.value = static_cast<int32_t>(strtol(buffer, nullptr, 10));
+    }
+}
+
+int32_t CpuTemperatures::GetPackage(int32_t package) const {
+    if (package < 0 || static_cast<size_t>(package) >= packageSensors.size()) {
+        return 0;
+    }
+    int sensor = packageSensors[static_cast<size_t>(package)];
+    return sensor >= 0 ? sensors[static_cast<size_t>(sensor)].value : 0;
+}
+
+int32_t CpuTemperatures::GetCpu(size_t cpu) const {
+    int sensor = cpu < cpuSensors.size() ? cpuSensors[cpu] : -1;
+    return sensor >= 0 ? sensors[static_cast<size_t>(sensor)].value : 0;
+}
+
+size_t CpuTemperatures::GetPackageCount() const { return packageSensors.size(); }
+} // namespace Devices
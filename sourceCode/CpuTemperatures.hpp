@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CpuTopology.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Devices {
+// Температуры процессоров из hwmon (class/hwmon/hwmonN) без libsensors.
+// Датчики привязываются к топологии по меткам: у coretemp -
+// "Package id N" и "Core N" (N - core_id), у k10temp/zenpower - Tdie или
+// Tctl на пакет и TccdN на группу L3, если их число совпадает с числом
+// групп. Ядро без своего датчика получает температуру пакета.
+// Привязка строится в Load, замер - один pread на датчик по открытому
+// дескриптору.
+class CpuTemperatures {
+public:
+  CpuTemperatures() = default;
+  ~CpuTemperatures();
+  CpuTemperatures(const CpuTemperatures &) = delete;
+  CpuTemperatures &operator=(const CpuTemperatures &) = delete;
+
+  void Load(const char *root, const CpuTopology &topology);
+  void Read();
+
+  // Миллиградусы Цельсия; 0 - датчика нет.
+  int32_t GetPackage(int32_t package) const;
+  int32_t GetCpu(size_t cpu) const;
+  size_t GetPackageCount() const;
+
+private:
+  struct Sensor {
+    int fd = -1;
+    int32_t value = 0;
+  };
+  std::vector<Sensor> sensors;
+  std::vector<int> packageSensors; // индекс в sensors по номеру пакета
+  std::vector<int> cpuSensors;     // по номеру cpuN
+
+  void CloseFds();
+};
+} // namespace Devices
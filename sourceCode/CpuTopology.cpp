@@ -0,0 +1,305 @@
+#include "CpuTopology.hpp"
+#include "InputTrace.hpp"
+#include "SysfsUtil.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <set>
+#include <tuple>
+#include <unistd.h>
+
+namespace {
+long long ReadNumber(const char *path, long long fallback) {
+    char buffer[32];
+    if (Devices::ReadSysfsValue(path, buffer, sizeof(buffer)) <= 0) {
+        return fallback;
+    }
+    return strtoll(buffer, nullptr, 10);
+}
+
+// "48K", "1280K", "32M" из cache/indexN/size.
+uint64_t ParseCacheSize(const char *text) {
+    char *end = nullptr;
+    uint64_t value = strtoull(text, &end, 10);
+    switch (end ? *end : '\0') {
+    case 'K':
+        return value << 10;
+    case 'M':
+        return value << 20;
+    case 'G':
+        return value << 30;
+    default:
+        return value;
+    }
+}
+
+// Список вида "0-3,8,10-11": первый процессор и их число.
+void ParseCpuList(const char *list, int &first, unsigned &count) {
+    first = -1;
+    count = 0;
+    const char *cursor = list;
+    while (*cursor >= '0' && *cursor <= '9') {
+        char *end = nullptr;
+        long from = strtol(cursor, &end, 10);
+        long to = from;
+        if (*end == '-') {
+            to = strtol(end + 1, &end, 10);
+        }
+        if (first < 0 || from < first) {
+            first = static_cast<int>(from);
+        }
+        count += static_cast<unsigned>(to - from + 1);
+        cursor = *end == ',' ? end + 1 : end;
+    }
+}
+
+struct CacheIndex {
+    uint32_t level = 0;
+    char type = 'U';
+    uint64_t size = 0;
+    uint32_t lineSize = 0;
+    uint32_t ways = 0;
+    int firstCpu = -1;
+    unsigned sharedCpus = 0;
+};
+
+// Читает cache/indexN; false, когда индексы кончились.
+bool ReadCacheIndex(const char *root, unsigned cpu, unsigned index, CacheIndex &out) {
+    char path[512];
+    char buffer[256];
+    int prefix = snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cache/index%u/",
+                          root, cpu, index);
+    if (prefix <= 0 || static_cast<size_t>(prefix) >= sizeof(path) - 32) {
+        return false;
+    }
+    char *name = path + prefix;
+    strcpy(name, "level");
+    long long level = ReadNumber(path, -1);
+    if (level < 0) {
+        return false;
+    }
+    out.level = static_cast<uint32_t>(level);
+    strcpy(name, "type");
+    out.type = Devices::ReadSysfsValue(path, buffer, sizeof(buffer)) > 0 ? buffer[0] : 'U';
+    strcpy(name, "size");
+    out.size = Devices::ReadSysfsValue(path, buffer, sizeof(buffer)) > 0 ? ParseCacheSize(buffer) : 0;
+    strcpy(name, "coherency_line_size");
+    out.lineSize = static_cast<uint32_t>(ReadNumber(path, 0));
+    strcpy(name, "ways_of_associativity");
+    out.ways = static_cast<uint32_t>(ReadNumber(path, 0));
+    strcpy(name, "shared_cpu_list");
+    if (Devices::ReadSysfsValue(path, buffer, sizeof(buffer)) > 0) {
+        ParseCpuList(buffer, out.firstCpu, out.sharedCpus);
+    } else {
+        out.firstCpu = static_cast<int>(cpu);
+        out.sharedCpus = 1;
+    }
+    return true;
+}
+
+int32_t ReadNode(const char *root, unsigned cpu) {
+    // Узел NUMA виден как ссылка nodeX в каталоге процессора
+    char path[512];
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u", root, cpu);
+    int32_t node = 0;
+    if (DIR *directory = opendir(path)) {
+        while (dirent *entry = readdir(directory)) {
+            if (strncmp(entry->d_name, "node", 4) == 0 &&
+                entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = static_cast<int32_t>(strtol(entry->d_name + 4, nullptr, 10));
+                break;
+            }
+        }
+        closedir(directory);
+    }
+    return node;
+}
+} // namespace
+
+namespace Devices {
+CpuTopology::~CpuTopology() { CloseFds(); }
+
+void CpuTopology::CloseFds() {
+    for (int fd : frequencyFds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    frequencyFds.clear();
+    if (onlineFd >= 0) {
+        close(onlineFd);
+        onlineFd = -1;
+    }
+}
+
+void CpuTopology::Load(const char *root, size_t cpuCount) {
+    CloseFds();
+    placements.assign(cpuCount, CpuPlacement());
+    frequencyFds.assign(cpuCount, -1);
+    caches.clear();
+
+    char path[512];
+    char buffer[64];
+    std::set<std::tuple<uint32_t, char, int>> instances;
+    for (unsigned cpu = 0; cpu < cpuCount; ++cpu) {
+        CpuPlacement &placement = placements[cpu];
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/topology/physical_package_id",
+                 root, cpu);
+        placement.package = static_cast<int32_t>(ReadNumber(path, 0));
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/topology/die_id", root, cpu);
+        placement.die = static_cast<int32_t>(ReadNumber(path, placement.package));
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/topology/core_id", root, cpu);
+        placement.core = static_cast<int32_t>(ReadNumber(path, cpu));
+        placement.node = ReadNode(root, cpu);
+
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cpufreq/cpuinfo_min_freq",
+                 root, cpu);
+        placement.minFrequencyMHz = static_cast<uint32_t>(ReadNumber(path, 0) / 1000);
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq",
+                 root, cpu);
+        placement.maxFrequencyMHz = static_cast<uint32_t>(ReadNumber(path, 0) / 1000);
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cpufreq/scaling_governor",
+                 root, cpu);
+        if (ReadSysfsValue(path, buffer, sizeof(buffer)) > 0) {
+            placement.governor = InternedString(buffer);
+        }
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cpufreq/scaling_cur_freq",
+                 root, cpu);
+        frequencyFds[cpu] = open(path, O_RDONLY | O_CLOEXEC);
+
+        // Каждый экземпляр кэша учитывается один раз - по первому
+        // процессору из тех, кто его делит
+        CacheIndex index;
+        uint32_t highest = 0;
+        for (unsigned number = 0; ReadCacheIndex(root, cpu, number, index); ++number) {
+            if (index.level >= highest) {
+                highest = index.level;
+                placement.llc = index.firstCpu;
+            }
+            auto found = std::find_if(caches.begin(), caches.end(), [&index](const CacheLevel &cache) {
+                return cache.level == index.level && cache.type == index.type;
+            });
+            if (found == caches.end()) {
+                CacheLevel cache;
+                cache.level = index.level;
+                cache.type = index.type;
+                cache.size = index.size;
+                cache.lineSize = index.lineSize;
+                cache.ways = index.ways;
+                cache.cpusPerInstance = index.sharedCpus;
+                caches.push_back(cache);
+                found = caches.end() - 1;
+            }
+            if (instances.emplace(index.level, index.type, index.firstCpu).second) {
+                ++found->instances;
+            }
+        }
+    }
+    std::sort(caches.begin(), caches.end(), [](const CacheLevel &a, const CacheLevel &b) {
+        return a.level != b.level ? a.level < b.level : a.type < b.type;
+    });
+
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/online", root);
+    onlineFd = open(path, O_RDONLY | O_CLOEXEC);
+    online[0] = '\0';
+    if (onlineFd >= 0) {
+        ssize_t got = pread(onlineFd, online, sizeof(online) - 1, 0);
+        online[got > 0 ? got : 0] = '\0';
+    }
+}
+
+bool CpuTopology::IsStale() {
+    if (onlineFd < 0) {
+        return false;
+    }
+    char current[sizeof(online)];
+    ssize_t got = pread(onlineFd, current, sizeof(current) - 1, 0);
+    if (got < 0) {
+        return false;
+    }
+    current[got] = '\0';
+    return strcmp(current, online) != 0;
+}
+
+uint32_t CpuTopology::ReadFrequencyMHz(size_t cpu) const {
+    int fd = cpu < frequencyFds.size() ? frequencyFds[cpu] : -1;
+    if (fd < 0) {
+        return 0;
+    }
+    char buffer[24];
+    ssize_t got = TracedRead("freq", cpu, buffer, sizeof(buffer) - 1,
+                             [fd, &buffer]() { return pread(fd, buffer, sizeof(buffer) - 1, 0); });
+    if (got <= 0) {
+        return 0;
+    }
+    buffer[got] = '\0';
+    return static_cast<uint32_t>(strtoul(buffer, nullptr, 10) / 1000);
+}
+
+size_t CpuTopology::GetCpuCount() const { return placements.size(); }
+const CpuPlacement &CpuTopology::GetPlacement(size_t cpu) const { return placements[cpu]; }
+const std::vector<CacheLevel> &CpuTopology::GetCaches() const { return caches; }
+
+void CpuTopology::ReadPackages(const char *root, std::vector<PackageSummary> &out) {
+    out.clear();
+    char path[512];
+    snprintf(path, sizeof(path), "%s/devices/system/cpu", root);
+    DIR *directory = opendir(path);
+    if (!directory) {
+        return;
+    }
+    std::vector<unsigned> cpus;
+    while (dirent *entry = readdir(directory)) {
+        if (strncmp(entry->d_name, "cpu", 3) == 0 && entry->d_name[3] >= '0' &&
+            entry->d_name[3] <= '9') {
+            cpus.push_back(static_cast<unsigned>(strtoul(entry->d_name + 3, nullptr, 10)));
+        }
+    }
+    closedir(directory);
+    std::sort(cpus.begin(), cpus.end());
+
+    std::set<std::pair<int32_t, long long>> cores;
+    for (unsigned cpu : cpus) {
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/topology/physical_package_id",
+                 root, cpu);
+        long long package = ReadNumber(path, -1);
+        if (package < 0) {
+            continue; // выключен: топология не видна
+        }
+        auto found = std::find_if(out.begin(), out.end(), [package](const PackageSummary &summary) {
+            return summary.package == package;
+        });
+        if (found == out.end()) {
+            PackageSummary summary;
+            summary.package = static_cast<int32_t>(package);
+            CacheIndex index;
+            for (unsigned number = 0; ReadCacheIndex(root, cpu, number, index); ++number) {
+                if (index.level == 1 && index.type != 'I') {
+                    summary.l1Cache = index.size;
+                } else if (index.level == 2) {
+                    summary.l2Cache = index.size;
+                } else if (index.level == 3) {
+                    summary.l3Cache = index.size;
+                }
+            }
+            out.push_back(summary);
+            found = out.end() - 1;
+        }
+        ++found->threads;
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/topology/core_id", root, cpu);
+        if (cores.emplace(found->package, ReadNumber(path, cpu)).second) {
+            ++found->cores;
+        }
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq",
+                 root, cpu);
+        found->maxFrequencyMHz = std::max(found->maxFrequencyMHz,
+                                          static_cast<uint32_t>(ReadNumber(path, 0) / 1000));
+    }
+    std::sort(out.begin(), out.end(), [](const PackageSummary &a, const PackageSummary &b) {
+        return a.package < b.package;
+    });
+}
+} // namespace Devices
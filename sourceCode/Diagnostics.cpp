@@ -0,0 +1,334 @@
+#include "Diagnostics.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <iomanip>
+#include <malloc.h>
+#include <new>
+#include <tuple>
+#include <unistd.h>
+
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> deallocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<uint64_t> samplingAllocationCount{0};
+thread_local uint64_t threadAllocationCount = 0;
+
+void *CountedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    ++threadAllocationCount;
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *CountedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    ++threadAllocationCount;
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void *)) {
+        align = sizeof(void *);
+    }
+    void *memory = nullptr;
+    if (posix_memalign(&memory, align, size == 0 ? 1 : size) != 0) {
+        return nullptr;
+    }
+    return memory;
+}
+
+void CountedFree(void *memory) {
+    if (memory) {
+        deallocationCount.fetch_add(1, std::memory_order_relaxed);
+        std::free(memory);
+    }
+}
+
+uint64_t ClockNs(clockid_t clock) {
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+} // namespace
+
+// Глобальная замена operator new/delete: считаем аллокации всего процесса,
+// включая Qt, чтобы видеть цену каждого тика в панели диагностики.
+void *operator new(std::size_t size) {
+    void *memory = CountedAllocate(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return CountedAllocate(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return CountedAllocate(size);
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    void *memory = CountedAllocateAligned(size, alignment);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+void operator delete(void *memory) noexcept { CountedFree(memory); }
+void operator delete[](void *memory) noexcept { CountedFree(memory); }
+void operator delete(void *memory, std::size_t) noexcept { CountedFree(memory); }
+void operator delete[](void *memory, std::size_t) noexcept {
+    CountedFree(memory);
+}
+void operator delete(void *memory, std::align_val_t) noexcept {
+    CountedFree(memory);
+}
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    CountedFree(memory);
+}
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    CountedFree(memory);
+}
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+    CountedFree(memory);
+}
+
+namespace Devices {
+LatencyHistogram::LatencyHistogram() { Reset(); }
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+    if (ns < 4) {
+        return static_cast<size_t>(ns);
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    size_t sub = (ns >> (msb - 2)) & 3;
+    return static_cast<size_t>(msb - 1) * 4 + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t index) {
+    if (index < 4) {
+        return index;
+    }
+    int msb = static_cast<int>(index / 4) + 1;
+    uint64_t sub = index % 4;
+    return (4 + sub) << (msb - 2);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < 4) {
+        return index;
+    }
+    int msb = static_cast<int>(index / 4) + 1;
+    return BucketLowerBound(index) + (1ull << (msb - 2)) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+    buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t current = min.load(std::memory_order_relaxed);
+    while (ns < current &&
+           !min.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+    current = max.load(std::memory_order_relaxed);
+    while (ns > current &&
+           !max.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    min.store(UINT64_MAX, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+uint64_t LatencyHistogram::GetSum() const {
+    return sum.load(std::memory_order_relaxed);
+}
+uint64_t LatencyHistogram::GetMin() const {
+    return GetCount() == 0 ? 0 : min.load(std::memory_order_relaxed);
+}
+uint64_t LatencyHistogram::GetMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+double LatencyHistogram::GetMean() const {
+    uint64_t total = GetCount();
+    return total == 0 ? 0.0 : static_cast<double>(GetSum()) / total;
+}
+uint64_t LatencyHistogram::GetBucket(size_t index) const {
+    return buckets[index].load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+    uint64_t total = GetCount();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t upper = BucketUpperBound(i);
+            uint64_t highest = GetMax();
+            return upper < highest ? upper : highest;
+        }
+    }
+    return GetMax();
+}
+
+ScopedTimer::ScopedTimer(LatencyHistogram &histogram)
+    : histogram(histogram), start(Diagnostics::MonotonicNs()) {}
+ScopedTimer::~ScopedTimer() {
+    histogram.Record(Diagnostics::MonotonicNs() - start);
+}
+
+Diagnostics::Diagnostics()
+    : lastWallNs(MonotonicNs()), lastCpuNs(ClockNs(CLOCK_PROCESS_CPUTIME_ID)),
+    lastAllocations(GetAllocationCount()), lastSamplingAllocations(0), lastHeapInUse(GetHeapInUse()),
+    lastCpuPercent(0),
+    statmFd(open("/proc/self/statm", O_RDONLY | O_CLOEXEC)) {}
+
+LatencyHistogram &Diagnostics::GetHistogram(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &entry : histograms) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    histograms.emplace_back(std::piecewise_construct, std::forward_as_tuple(name),
+                            std::forward_as_tuple());
+    return histograms.back().second;
+}
+
+std::vector<std::pair<std::string, const LatencyHistogram *>>
+Diagnostics::GetHistograms() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, const LatencyHistogram *>> result;
+    result.reserve(histograms.size());
+    for (const auto &entry : histograms) {
+        result.emplace_back(entry.first, &entry.second);
+    }
+    return result;
+}
+
+ProcessUsage Diagnostics::SampleProcessUsage() {
+    uint64_t wallNs = MonotonicNs();
+    uint64_t cpuNs = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+    uint64_t allocations = GetAllocationCount();
+
+    ProcessUsage current;
+    current.cpuSeconds = cpuNs / 1e9;
+    if (wallNs > lastWallNs) {
+        current.cpuPercent =
+            static_cast<double>(cpuNs - lastCpuNs) / (wallNs - lastWallNs) * 100.0;
+    } else {
+        current.cpuPercent = lastCpuPercent;
+    }
+    current.allocations = allocations;
+    current.deallocations = GetDeallocationCount();
+    current.allocatedBytes = GetAllocatedBytes();
+    current.allocationsPerTick = allocations - lastAllocations;
+    current.samplingAllocations = GetSamplingAllocationCount();
+    current.samplingAllocationsPerTick = current.samplingAllocations - lastSamplingAllocations;
+    // Один обход арен malloc за тик, вне замеров сборщиков
+    current.heapInUse = GetHeapInUse();
+    current.heapGrowthPerTick = current.heapInUse - lastHeapInUse;
+
+    // Дескриптор statm открыт заранее: замер сам не должен аллоцировать
+    char statm[128];
+    ssize_t got = statmFd >= 0 ? pread(statmFd, statm, sizeof(statm) - 1, 0) : -1;
+    if (got > 0) {
+        statm[got] = '\0';
+        char *end = nullptr;
+        strtoull(statm, &end, 10); // размер, страницы
+        uint64_t residentPages = strtoull(end, nullptr, 10);
+        current.rssBytes = residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastWallNs = wallNs;
+    lastCpuNs = cpuNs;
+    lastAllocations = GetAllocationCount();
+    lastSamplingAllocations = current.samplingAllocations;
+    lastHeapInUse = current.heapInUse;
+    lastCpuPercent = current.cpuPercent;
+    usage = current;
+    return current;
+}
+
+ProcessUsage Diagnostics::GetProcessUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usage;
+}
+
+bool Diagnostics::IsWithinBudget() const {
+    return GetProcessUsage().cpuPercent <= cpuBudgetPercent;
+}
+
+void Diagnostics::Report(std::ostream &out) const {
+    ProcessUsage current = GetProcessUsage();
+    out << "cpu_percent " << std::fixed << std::setprecision(3)
+        << current.cpuPercent << "\n"
+        << "cpu_seconds " << current.cpuSeconds << "\n"
+        << "rss_bytes " << current.rssBytes << "\n"
+        << "allocations " << current.allocations << "\n"
+        << "deallocations " << current.deallocations << "\n"
+        << "allocated_bytes " << current.allocatedBytes << "\n"
+        << "allocations_per_tick " << current.allocationsPerTick << "\n"
+        << "sampling_allocations " << current.samplingAllocations << "\n"
+        << "sampling_allocations_per_tick " << current.samplingAllocationsPerTick << "\n"
+        << "heap_in_use_bytes " << current.heapInUse << "\n"
+        << "heap_growth_per_tick " << current.heapGrowthPerTick << "\n";
+    for (const auto &entry : GetHistograms()) {
+        const LatencyHistogram &histogram = *entry.second;
+        out << entry.first << " count=" << histogram.GetCount()
+            << " mean_ns=" << static_cast<uint64_t>(histogram.GetMean())
+            << " p50_ns=" << histogram.GetPercentile(50)
+            << " p99_ns=" << histogram.GetPercentile(99)
+            << " max_ns=" << histogram.GetMax() << "\n";
+    }
+}
+
+uint64_t Diagnostics::GetAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+uint64_t Diagnostics::GetThreadAllocationCount() { return threadAllocationCount; }
+void Diagnostics::AddSamplingAllocations(uint64_t count) {
+    samplingAllocationCount.fetch_add(count, std::memory_order_relaxed);
+}
+uint64_t Diagnostics::GetSamplingAllocationCount() {
+    return samplingAllocationCount.load(std::memory_order_relaxed);
+}
+int64_t Diagnostics::GetHeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    // Обход арен malloc под их блокировками - единицы микросекунд
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+uint64_t Diagnostics::GetDeallocationCount() {
+    return deallocationCount.load(std::memory_order_relaxed);
+}
+uint64_t Diagnostics::GetAllocatedBytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+uint64_t Diagnostics::MonotonicNs() { return ClockNs(CLOCK_MONOTONIC); }
+} // namespace Devices
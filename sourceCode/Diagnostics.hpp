@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Devices {
+// Гистограмма задержек в наносекундах: логарифмические корзины по степеням
+// двойки, каждая поделена на 4 линейные подкорзины (погрешность <= 25%).
+// Запись - несколько relaxed-атомиков, без блокировок и аллокаций.
+class LatencyHistogram {
+public:
+  static constexpr size_t bucketCount = 252;
+
+  LatencyHistogram();
+
+  void Record(uint64_t ns);
+  void Reset();
+
+  uint64_t GetCount() const;
+  uint64_t GetSum() const;
+  uint64_t GetMin() const;
+  uint64_t GetMax() const;
+  double GetMean() const;
+  uint64_t GetPercentile(double percentile) const;
+  uint64_t GetBucket(size_t index) const;
+
+  static size_t BucketIndex(uint64_t ns);
+  static uint64_t BucketLowerBound(size_t index);
+  static uint64_t BucketUpperBound(size_t index);
+
+private:
+  std::array<std::atomic<uint64_t>, bucketCount> buckets;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> min;
+  std::atomic<uint64_t> max;
+};
+
+class ScopedTimer {
+private:
+  LatencyHistogram &histogram;
+  uint64_t start;
+
+public:
+  explicit ScopedTimer(LatencyHistogram &histogram);
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ~ScopedTimer();
+};
+
+struct ProcessUsage {
+  double cpuSeconds = 0;     // user + system время процесса
+  double cpuPercent = 0;     // доля одного ядра с прошлого замера
+  uint64_t rssBytes = 0;
+  uint64_t allocations = 0;  // всего вызовов operator new, без malloc
+  uint64_t deallocations = 0;
+  uint64_t allocatedBytes = 0;
+  uint64_t allocationsPerTick = 0;
+  // Из них внутри замеров сборщиков (PC::RunCollector). В установившемся
+  // режиме 0, кроме редкого роста срезов квантилей, когда значение
+  // выходит за уже занятый диапазон корзин.
+  uint64_t samplingAllocations = 0;
+  uint64_t samplingAllocationsPerTick = 0;
+  // operator new не видит malloc из C-библиотек (popen, getifaddrs,
+  // getaddrinfo): для них видна занятая куча malloc и её прирост с
+  // прошлого тика. Утечка даёт стабильно положительный прирост. Куча
+  // общая для процесса, поэтому сюда попадают и фоновые потоки.
+  int64_t heapInUse = 0; // байт
+  int64_t heapGrowthPerTick = 0;
+};
+
+class Diagnostics {
+private:
+  Diagnostics();
+
+  mutable std::mutex mutex;
+  std::deque<std::pair<std::string, LatencyHistogram>> histograms;
+
+  uint64_t lastWallNs;
+  uint64_t lastCpuNs;
+  uint64_t lastAllocations;
+  uint64_t lastSamplingAllocations;
+  int64_t lastHeapInUse;
+  double lastCpuPercent;
+  int statmFd;
+  ProcessUsage usage;
+
+public:
+  static constexpr double cpuBudgetPercent = 1.0;
+
+  Diagnostics(const Diagnostics &) = delete;
+  Diagnostics &operator=(const Diagnostics &) = delete;
+  static Diagnostics &GetInstance() {
+    static Diagnostics diagnostics;
+    return diagnostics;
+  }
+
+  // Ссылка стабильна на всё время жизни процесса, её можно кэшировать.
+  LatencyHistogram &GetHistogram(const std::string &name);
+  std::vector<std::pair<std::string, const LatencyHistogram *>>
+  GetHistograms() const;
+  // Обход без копирования имён - для выгрузки снимка без аллокаций.
+  template <typename Visit> void ForEachHistogram(Visit visit) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &entry : histograms) {
+      visit(entry.first, entry.second);
+    }
+  }
+
+  // Снимает CPU-время, RSS и счётчики аллокаций; cpuPercent и
+  // allocationsPerTick считаются относительно предыдущего вызова.
+  ProcessUsage SampleProcessUsage();
+  ProcessUsage GetProcessUsage() const;
+  bool IsWithinBudget() const;
+
+  void Report(std::ostream &out) const;
+
+  static uint64_t GetAllocationCount();
+  // Аллокации вызывающего потока: замер одного участка кода не
+  // путается с аллокациями фоновых потоков.
+  static uint64_t GetThreadAllocationCount();
+  static void AddSamplingAllocations(uint64_t count);
+  static uint64_t GetSamplingAllocationCount();
+  // Байты, занятые в куче malloc (mallinfo2); 0 без glibc 2.33. Обходит
+  // арены под их блокировками (единицы микросекунд), поэтому вызывается
+  // раз за тик из SampleProcessUsage, а не в замерах сборщиков.
+  static int64_t GetHeapInUse();
+  static uint64_t GetDeallocationCount();
+  static uint64_t GetAllocatedBytes();
+  static uint64_t MonotonicNs();
+};
+} // namespace Devices
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Devices {
+class PC;
+
+// Порт агента по умолчанию (ULSM --agent).
+constexpr uint16_t fleetAgentPort = 9870;
+// Адрес агента по умолчанию. Аутентификации нет, поэтому сводка
+// доступна только с этого хоста, пока адрес не задан явно
+// (--agent=0.0.0.0:9870).
+constexpr const char *fleetAgentHost = "127.0.0.1";
+// Предел кадра: заголовок агрегатора рассчитан на сводку, а не снимок.
+constexpr uint32_t fleetFrameLimit = 64 * 1024;
+
+// Агент парка: раз в такт рассылает подключившимся агрегаторам сводку
+// хоста. Кадр - длина (4 байта, big-endian) и карта CBOR, записанная
+// ExportWriter: host, generation, alerts (число сработавших правил) и
+// последнее значение каждого ряда истории под именем PC::GetSeriesName.
+// Сокеты неблокирующие; медленный агрегатор пропускает такты, а не
+// копит очередь - важна последняя сводка.
+
+// Разбирает host, host:port и [v6]:port; host и port меняются только
+// на заданные в адресе части.
+bool SplitHostPort(std::string_view address, std::string &host, std::string &port,
+                   std::string &error);
+
+class FleetAgent {
+public:
+  FleetAgent() = default;
+  FleetAgent(const FleetAgent &) = delete;
+  FleetAgent &operator=(const FleetAgent &) = delete;
+  ~FleetAgent();
+
+  // address: порт, адрес, адрес:порт или [v6]:порт; пустой - порт
+  // fleetAgentPort на fleetAgentHost.
+  bool Listen(std::string_view address, std::string &error);
+  // Слушающий сокет: готов к чтению - есть подключения для Accept.
+  int GetFd() const;
+  void Accept();
+  // Кодирует сводку и отправляет всем агрегаторам; вызывать из потока
+  // планировщика после замера.
+  void Publish(PC &pc);
+  size_t GetClientCount() const;
+
+private:
+  struct Client {
+    int fd = -1;
+    std::vector<char> pending; // недоотправленный хвост кадра
+    size_t offset = 0;
+  };
+
+  int listenFd = -1;
+  std::vector<Client> clients;
+  std::vector<char> frame;
+
+  // false - соединение закрыто агрегатором или ошибка.
+  bool Send(Client &client);
+};
+} // namespace Devices
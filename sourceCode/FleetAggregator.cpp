@@ -0,0 +1,516 @@
+#include "FleetAggregator.hpp"
+#include "FleetAgent.hpp"
+#include "Scheduler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint64_t timerEvent = UINT64_MAX;
+
+// Читатель ровно того подмножества CBOR, которое пишет ExportWriter:
+// целые, float 16/32/64, строки, true/false/null, массивы и карты
+// определённой и неопределённой длины. Неизвестные ключи пропускаются,
+// так что новые поля агента не ломают старый агрегатор.
+class CborReader {
+public:
+    CborReader(const uint8_t *data, size_t size) : cursor(data), end(data + size) {}
+
+    bool ReadHead(uint8_t &major, uint8_t &info, uint64_t &value) {
+        if (cursor >= end) {
+            return false;
+        }
+        major = *cursor >> 5;
+        info = *cursor & 0x1f;
+        ++cursor;
+        value = info;
+        if (info < 24 || info == 31) {
+            return true;
+        }
+        if (info > 27) {
+            return false;
+        }
+        size_t bytes = size_t{1} << (info - 24);
+        if (static_cast<size_t>(end - cursor) < bytes) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value = value << 8 | cursor[i];
+        }
+        cursor += bytes;
+        return true;
+    }
+
+    bool IsBreak() const { return cursor < end && *cursor == 0xff; }
+    void SkipBreak() { ++cursor; }
+
+    bool ReadText(std::string_view &text) {
+        uint8_t major, info;
+        uint64_t length;
+        if (!ReadHead(major, info, length) || major != 3 || info == 31 ||
+            length > static_cast<uint64_t>(end - cursor)) {
+            return false;
+        }
+        text = std::string_view(reinterpret_cast<const char *>(cursor), length);
+        cursor += length;
+        return true;
+    }
+
+    bool ReadNumber(double &number) {
+        uint8_t major, info;
+        uint64_t value;
+        if (!ReadHead(major, info, value)) {
+            return false;
+        }
+        if (major == 0) {
+            number = static_cast<double>(value);
+            return true;
+        }
+        if (major == 1) {
+            number = -1.0 - static_cast<double>(value);
+            return true;
+        }
+        if (major != 7) {
+            return false;
+        }
+        switch (info) {
+        case 25: {
+            // Половинная точность: знак, 5 бит порядка, 10 бит мантиссы
+            int exponent = (value >> 10) & 0x1f;
+            double mantissa = static_cast<double>(value & 0x3ff);
+            number = exponent == 0    ? std::ldexp(mantissa, -24)
+                     : exponent == 31 ? (mantissa == 0 ? INFINITY : NAN)
+                                      : std::ldexp(mantissa + 1024, exponent - 25);
+            number = value & 0x8000 ? -number : number;
+            return true;
+        }
+        case 26: {
+            uint32_t bits = static_cast<uint32_t>(value);
+            float narrow;
+            memcpy(&narrow, &bits, sizeof(narrow));
+            number = narrow;
+            return true;
+        }
+        case 27:
+            memcpy(&number, &value, sizeof(number));
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Skip(int depth = 0) {
+        uint8_t major, info;
+        uint64_t value;
+        if (depth > 16 || !ReadHead(major, info, value)) {
+            return false;
+        }
+        switch (major) {
+        case 2:
+        case 3:
+            if (info == 31 || value > static_cast<uint64_t>(end - cursor)) {
+                return false;
+            }
+            cursor += value;
+            return true;
+        case 4:
+        case 5: {
+            uint64_t items = major == 5 ? value * 2 : value;
+            if (info == 31) {
+                while (!IsBreak()) {
+                    if (!Skip(depth + 1)) {
+                        return false;
+                    }
+                }
+                SkipBreak();
+                return true;
+            }
+            for (uint64_t i = 0; i < items; ++i) {
+                if (!Skip(depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case 6:
+            return Skip(depth + 1);
+        default:
+            return true;
+        }
+    }
+
+private:
+    const uint8_t *cursor;
+    const uint8_t *end;
+};
+} // namespace
+
+namespace Devices {
+uint32_t FleetStore::AddHost(std::string_view address) {
+    addresses.emplace_back(address);
+    names.emplace_back();
+    generations.push_back(0);
+    alerts.push_back(0);
+    lastSeen.push_back(0);
+    connected.push_back(0);
+    for (std::vector<float> &column : columns) {
+        column.push_back(0);
+    }
+    return static_cast<uint32_t>(addresses.size() - 1);
+}
+
+size_t FleetStore::GetHostCount() const { return addresses.size(); }
+
+void FleetStore::BeginSample(uint32_t host, uint64_t nowNs) {
+    lastSeen[host] = nowNs;
+    sampleTimeNs = nowNs;
+}
+
+void FleetStore::SetName(uint32_t host, std::string_view name) {
+    // Имя меняется редко: пул строк только при смене
+    if (names[host].View() != name) {
+        names[host] = InternedString(name);
+    }
+}
+
+void FleetStore::SetGeneration(uint32_t host, uint64_t generation) {
+    generations[host] = generation;
+}
+
+void FleetStore::SetAlerts(uint32_t host, uint32_t firing) { alerts[host] = firing; }
+
+void FleetStore::SetValue(uint32_t host, Series series, float value) {
+    columns[static_cast<size_t>(series)][host] = value;
+    quantiles[static_cast<size_t>(series)].Add(sampleTimeNs, value);
+}
+
+void FleetStore::SetConnected(uint32_t host, bool value) { connected[host] = value; }
+
+std::string_view FleetStore::GetAddress(uint32_t host) const { return addresses[host].View(); }
+std::string_view FleetStore::GetName(uint32_t host) const { return names[host].View(); }
+uint64_t FleetStore::GetGeneration(uint32_t host) const { return generations[host]; }
+uint32_t FleetStore::GetAlerts(uint32_t host) const { return alerts[host]; }
+float FleetStore::GetValue(uint32_t host, Series series) const {
+    return columns[static_cast<size_t>(series)][host];
+}
+View<float> FleetStore::GetColumn(Series series) const {
+    return columns[static_cast<size_t>(series)];
+}
+uint64_t FleetStore::GetLastSeen(uint32_t host) const { return lastSeen[host]; }
+bool FleetStore::IsConnected(uint32_t host) const { return connected[host] != 0; }
+
+bool FleetStore::IsFresh(uint32_t host, uint64_t nowNs) const {
+    return connected[host] && lastSeen[host] != 0 && nowNs - lastSeen[host] <= staleNs;
+}
+
+void FleetStore::GetTop(Series series, size_t n, uint64_t nowNs,
+                        std::vector<uint32_t> &out) const {
+    out.clear();
+    for (uint32_t host = 0; host < addresses.size(); ++host) {
+        if (IsFresh(host, nowNs)) {
+            out.push_back(host);
+        }
+    }
+    const std::vector<float> &column = columns[static_cast<size_t>(series)];
+    size_t count = std::min(n, out.size());
+    std::partial_sort(out.begin(), out.begin() + count, out.end(),
+                      [&column](uint32_t a, uint32_t b) { return column[a] > column[b]; });
+    out.resize(count);
+}
+
+const SlidingQuantiles &FleetStore::GetQuantiles(Series series) const {
+    return quantiles[static_cast<size_t>(series)];
+}
+
+FleetAggregator::FleetAggregator() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        error = errno;
+        return;
+    }
+    // Переподключение проверяется раз в секунду, пока процесс жив
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    itimerspec period{};
+    period.it_interval.tv_sec = 1;
+    period.it_value.tv_sec = 1;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = timerEvent;
+    if (timerFd < 0 || timerfd_settime(timerFd, 0, &period, nullptr) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event) != 0) {
+        error = errno;
+        if (timerFd >= 0) {
+            close(timerFd);
+            timerFd = -1;
+        }
+    }
+}
+
+FleetAggregator::~FleetAggregator() {
+    for (Agent &agent : agents) {
+        if (agent.fd >= 0) {
+            close(agent.fd);
+        }
+    }
+    if (timerFd >= 0) {
+        close(timerFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool FleetAggregator::AddAgent(std::string_view address, std::string &error) {
+    if (epollFd < 0) {
+        error = std::string("epoll: ") + strerror(this->error);
+        return false;
+    }
+    // host, host:port, [v6]:port
+    std::string host;
+    std::string port = std::to_string(fleetAgentPort);
+    if (!SplitHostPort(address, host, port, error)) {
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (status != 0) {
+        error = std::string(address) + ": " + gai_strerror(status);
+        return false;
+    }
+    Agent agent;
+    memcpy(&agent.address, result->ai_addr, result->ai_addrlen);
+    agent.addressLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    // Сводка - сотни байт; буфер растёт только под кадр крупнее
+    agent.buffer.resize(4096);
+    agents.push_back(std::move(agent));
+    uint32_t index = store.AddHost(address);
+    Connect(index, Scheduler::Now());
+    return true;
+}
+
+void FleetAggregator::Connect(uint32_t host, uint64_t nowNs) {
+    Agent &agent = agents[host];
+    agent.fd = socket(agent.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (agent.fd < 0) {
+        agent.retryNs = nowNs + reconnectNs;
+        return;
+    }
+    int enable = 1;
+    setsockopt(agent.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    if (connect(agent.fd, reinterpret_cast<sockaddr *>(&agent.address), agent.addressLength) != 0 &&
+        errno != EINPROGRESS) {
+        close(agent.fd);
+        agent.fd = -1;
+        agent.retryNs = nowNs + reconnectNs;
+        return;
+    }
+    // Готовность к записи - соединение установлено (или отвергнуто)
+    agent.connecting = true;
+    agent.used = 0;
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT;
+    event.data.u64 = host;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, agent.fd, &event);
+}
+
+void FleetAggregator::Disconnect(uint32_t host, uint64_t nowNs) {
+    Agent &agent = agents[host];
+    if (agent.fd < 0) {
+        return;
+    }
+    close(agent.fd);
+    agent.fd = -1;
+    agent.used = 0;
+    agent.retryNs = nowNs + reconnectNs;
+    if (!agent.connecting) {
+        --connectedCount;
+        store.SetConnected(host, false);
+    }
+    agent.connecting = false;
+}
+
+bool FleetAggregator::Receive(uint32_t host, uint64_t nowNs, size_t &frames) {
+    Agent &agent = agents[host];
+    ssize_t got = recv(agent.fd, agent.buffer.data() + agent.used,
+                       agent.buffer.size() - agent.used, 0);
+    if (got == 0) {
+        return false;
+    }
+    if (got < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    agent.used += static_cast<size_t>(got);
+
+    size_t offset = 0;
+    while (agent.used - offset >= 4) {
+        const uint8_t *header = agent.buffer.data() + offset;
+        uint32_t length = static_cast<uint32_t>(header[0]) << 24 |
+                          static_cast<uint32_t>(header[1]) << 16 |
+                          static_cast<uint32_t>(header[2]) << 8 | header[3];
+        if (length > fleetFrameLimit) {
+            return false;
+        }
+        if (agent.used - offset - 4 < length) {
+            if (length + 4 > agent.buffer.size()) {
+                agent.buffer.resize(length + 4);
+            }
+            break;
+        }
+        if (!Ingest(host, header + 4, length, nowNs)) {
+            return false;
+        }
+        offset += 4 + length;
+        ++frames;
+    }
+    // Неполный кадр переезжает в начало буфера
+    if (offset > 0) {
+        memmove(agent.buffer.data(), agent.buffer.data() + offset, agent.used - offset);
+        agent.used -= offset;
+    }
+    return true;
+}
+
+bool FleetAggregator::Ingest(uint32_t host, const uint8_t *data, size_t size, uint64_t nowNs) {
+    CborReader reader(data, size);
+    uint8_t major, info;
+    uint64_t count;
+    if (!reader.ReadHead(major, info, count) || major != 5) {
+        return false;
+    }
+    store.BeginSample(host, nowNs);
+    for (uint64_t i = 0; info == 31 || i < count; ++i) {
+        if (info == 31 && reader.IsBreak()) {
+            reader.SkipBreak();
+            break;
+        }
+        std::string_view key;
+        if (!reader.ReadText(key)) {
+            return false;
+        }
+        double number = 0;
+        if (key == "host") {
+            std::string_view name;
+            if (!reader.ReadText(name)) {
+                return false;
+            }
+            store.SetName(host, name);
+            continue;
+        }
+        size_t series = 0;
+        while (series < static_cast<size_t>(PC::Series::Count) &&
+               key != PC::GetSeriesName(static_cast<PC::Series>(series))) {
+            ++series;
+        }
+        bool known = series < static_cast<size_t>(PC::Series::Count) || key == "generation" ||
+                     key == "alerts";
+        if (!known) {
+            if (!reader.Skip()) {
+                return false;
+            }
+            continue;
+        }
+        if (!reader.ReadNumber(number)) {
+            return false;
+        }
+        if (key == "generation") {
+            store.SetGeneration(host, static_cast<uint64_t>(number));
+        } else if (key == "alerts") {
+            store.SetAlerts(host, static_cast<uint32_t>(number));
+        } else {
+            store.SetValue(host, static_cast<PC::Series>(series), static_cast<float>(number));
+        }
+    }
+    ++frameCount;
+    return true;
+}
+
+size_t FleetAggregator::ProcessEvents(uint64_t nowNs) {
+    size_t frames = 0;
+    if (timerFd < 0) {
+        Reconnect(nowNs);
+    }
+    int ready;
+    do {
+        ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 0);
+        for (int i = 0; i < ready; ++i) {
+            const epoll_event &event = events[static_cast<size_t>(i)];
+            if (event.data.u64 == timerEvent) {
+                uint64_t expirations;
+                if (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                    Reconnect(nowNs);
+                }
+                continue;
+            }
+            uint32_t host = static_cast<uint32_t>(event.data.u64);
+            Agent &agent = agents[host];
+            if (agent.fd < 0) {
+                continue; // закрыт раньше в этой же пачке событий
+            }
+            if (agent.connecting) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(agent.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (error != 0) {
+                    agent.connecting = false;
+                    close(agent.fd);
+                    agent.fd = -1;
+                    agent.retryNs = nowNs + reconnectNs;
+                    continue;
+                }
+                if (!(event.events & EPOLLOUT) && !(event.events & EPOLLIN)) {
+                    continue;
+                }
+                agent.connecting = false;
+                ++connectedCount;
+                store.SetConnected(host, true);
+                epoll_event readable{};
+                readable.events = EPOLLIN;
+                readable.data.u64 = host;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, agent.fd, &readable);
+            }
+            if (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                if (!Receive(host, nowNs, frames)) {
+                    Disconnect(host, nowNs);
+                }
+            }
+        }
+    } while (ready == static_cast<int>(events.size()));
+    return frames;
+}
+
+void FleetAggregator::Reconnect(uint64_t nowNs) {
+    for (uint32_t host = 0; host < agents.size(); ++host) {
+        if (agents[host].fd < 0 && nowNs >= agents[host].retryNs) {
+            Connect(host, nowNs);
+        }
+    }
+}
+
+bool FleetAggregator::Wait(int timeoutMs) const {
+    // Без таймера ожидание не длиннее периода переподключения
+    if (timerFd < 0 && (timeoutMs < 0 || timeoutMs > 1000)) {
+        timeoutMs = 1000;
+    }
+    pollfd descriptor{epollFd, POLLIN, 0};
+    return poll(&descriptor, 1, timeoutMs) > 0;
+}
+
+int FleetAggregator::GetFd() const { return epollFd; }
+int FleetAggregator::GetError() const { return error; }
+const FleetStore &FleetAggregator::GetStore() const { return store; }
+size_t FleetAggregator::GetConnectedCount() const { return connectedCount; }
+uint64_t FleetAggregator::GetFrameCount() const { return frameCount; }
+} // namespace Devices
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "QuantileSketch.hpp"
+#include "StringPool.hpp"
+#include "SysMonCore.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <vector>
+
+namespace Devices {
+// Колоночное хранилище парка: у каждого ряда (PC::Series) свой плотный
+// массив значений по хостам, поэтому выборка лучших хостов по одной
+// метрике проходит только по её столбцу. Индекс хоста постоянен.
+class FleetStore {
+public:
+  using Series = PC::Series;
+  // Хост без кадров дольше этого выпадает из выборок.
+  static constexpr uint64_t staleNs = 5 * 1000000000ull;
+
+  uint32_t AddHost(std::string_view address);
+  size_t GetHostCount() const;
+
+  // Начало и конец приёма кадра хоста; значения между ними - SetValue.
+  void BeginSample(uint32_t host, uint64_t nowNs);
+  void SetName(uint32_t host, std::string_view name);
+  void SetGeneration(uint32_t host, uint64_t generation);
+  void SetAlerts(uint32_t host, uint32_t firing);
+  void SetValue(uint32_t host, Series series, float value);
+  void SetConnected(uint32_t host, bool connected);
+
+  std::string_view GetAddress(uint32_t host) const;
+  std::string_view GetName(uint32_t host) const;
+  uint64_t GetGeneration(uint32_t host) const;
+  uint32_t GetAlerts(uint32_t host) const;
+  float GetValue(uint32_t host, Series series) const;
+  View<float> GetColumn(Series series) const;
+  uint64_t GetLastSeen(uint32_t host) const;
+  bool IsConnected(uint32_t host) const;
+  bool IsFresh(uint32_t host, uint64_t nowNs) const;
+
+  // n хостов с наибольшим значением ряда среди свежих, по убыванию;
+  // out переиспользуется между вызовами.
+  void GetTop(Series series, size_t n, uint64_t nowNs, std::vector<uint32_t> &out) const;
+  // Распределение ряда по всем хостам за окно: скетчи каждого хоста
+  // не хранятся, кадры сразу добавляются в общий скетч ряда.
+  const SlidingQuantiles &GetQuantiles(Series series) const;
+
+private:
+  std::vector<InternedString> addresses;
+  std::vector<InternedString> names;
+  std::vector<uint64_t> generations;
+  std::vector<uint32_t> alerts;
+  std::vector<uint64_t> lastSeen;
+  std::vector<uint8_t> connected;
+  std::array<std::vector<float>, static_cast<size_t>(Series::Count)> columns;
+  std::array<SlidingQuantiles, static_cast<size_t>(Series::Count)> quantiles;
+  uint64_t sampleTimeNs = 0;
+};
+
+// Агрегатор: неблокирующие TCP-соединения ко всем агентам (FleetAgent)
+// в одном epoll. Разбор кадров идёт прямо из буфера приёма соединения,
+// без промежуточных копий и аллокаций; оборванные соединения
+// переподключаются по таймеру. Дескриптор epoll можно отдать в event
+// loop (QSocketNotifier) так же, как дескриптор планировщика.
+class FleetAggregator {
+public:
+  static constexpr uint64_t reconnectNs = 2 * 1000000000ull;
+
+  FleetAggregator();
+  FleetAggregator(const FleetAggregator &) = delete;
+  FleetAggregator &operator=(const FleetAggregator &) = delete;
+  ~FleetAggregator();
+
+  // "host:port" или "host" (порт fleetAgentPort); имя разрешается сразу.
+  bool AddAgent(std::string_view address, std::string &error);
+  int GetFd() const;
+  // errno сбоя epoll или таймера переподключения; 0 - всё работает. Без
+  // таймера переподключение проверяет каждый ProcessEvents, и вызывать
+  // его нужно не реже раза в секунду.
+  int GetError() const;
+  // Обрабатывает всё готовое без ожидания; возвращает число принятых кадров.
+  size_t ProcessEvents(uint64_t nowNs);
+  // Ждёт событий не дольше timeoutMs (-1 - бесконечно).
+  bool Wait(int timeoutMs) const;
+
+  const FleetStore &GetStore() const;
+  size_t GetConnectedCount() const;
+  uint64_t GetFrameCount() const;
+
+private:
+  struct Agent {
+    sockaddr_storage address{};
+    socklen_t addressLength = 0;
+    int fd = -1;
+    bool connecting = false;
+    uint64_t retryNs = 0;
+    std::vector<uint8_t> buffer; // fleetFrameLimit + заголовок, один раз
+    size_t used = 0;
+  };
+
+  int epollFd;
+  int timerFd = -1;
+  int error = 0;
+  std::vector<Agent> agents;
+  FleetStore store;
+  std::array<epoll_event, 256> events;
+  size_t connectedCount = 0;
+  uint64_t frameCount = 0;
+
+  void Connect(uint32_t host, uint64_t nowNs);
+  void Reconnect(uint64_t nowNs);
+  void Disconnect(uint32_t host, uint64_t nowNs);
+  // false - соединение закрыто или кадр испорчен.
+  bool Receive(uint32_t host, uint64_t nowNs, size_t &frames);
+  bool Ingest(uint32_t host, const uint8_t *data, size_t size, uint64_t nowNs);
+};
+} // namespace Devices
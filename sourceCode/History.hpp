@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Devices {
+// Кольцевой буфер истории одной метрики: время замера и значение.
+// Память выделяется один раз в конструкторе, Push не аллоцирует.
+// Время хранится в миллисекундах от начала отсчёта (8 байт на точку),
+// поэтому часы истории с частотой 10 Гц занимают единицы мегабайт.
+// 32-битное смещение кончается через 49 дней: тогда начало отсчёта
+// переносится на половину диапазона вперёд, а точки старше него
+// (им больше 24 дней) отбрасываются.
+class History {
+public:
+  // Минимум и максимум значений, попавших в один столбец пикселей.
+  struct Bucket {
+    float min;
+    float max;
+    bool valid;
+  };
+
+  explicit History(size_t capacity = 0);
+
+  void Push(uint64_t timeNs, float value);
+  void Clear();
+
+  size_t GetSize() const;
+  size_t GetCapacity() const;
+  // Число записей за всё время; растёт при каждом Push - по нему
+  // потребители понимают, что кэшированную картинку пора перерисовать.
+  uint64_t GetPushCount() const;
+  bool IsEmpty() const;
+  uint64_t GetOldestTime() const;
+  uint64_t GetLatestTime() const;
+  float GetLatest() const;
+
+  // Прореживание для вывода: интервал [fromNs, toNs) делится на
+  // out.size() столбцов, в каждый попадает min/max его точек. Стоимость
+  // линейна по числу точек в интервале, out не перевыделяется.
+  void Decimate(uint64_t fromNs, uint64_t toNs, std::vector<Bucket> &out) const;
+
+private:
+  std::vector<uint32_t> times;
+  std::vector<float> values;
+  uint64_t originNs = 0;
+  size_t head = 0;
+  size_t size = 0;
+  uint64_t pushed = 0;
+
+  // Индекс в кольце i-й по старшинству точки.
+  size_t Slot(size_t index) const;
+  uint64_t TimeAt(size_t index) const;
+  // Первая по старшинству точка со временем не раньше timeNs.
+  size_t LowerBound(uint64_t timeNs) const;
+  void Rebase(uint64_t offsetMs);
+};
+} // namespace Devices
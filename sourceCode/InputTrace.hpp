@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace Devices {
+// Трасса сырых входов сборщиков: байты каждого чтения (/proc, hwmon,
+// RAPL, cpufreq, sysinfo, список адресов интерфейсов) с привязкой к
+// замеру и его времени. При воспроизведении те же чтения отдаются из
+// файла, а разбор, скорости, история, правила оповещений и GUI работают
+// как на живой системе. Перехватываются только чтения внутри замера на
+// потоке планировщика (PC::RunCollector); фоновые пробы инвентаря и
+// структура sysfs (топология, список датчиков) читаются с машины, где
+// идёт воспроизведение, - для чужого хоста её подменяет ULSM_SYSFS_ROOT.
+// Трасса открывается до создания PC: его конструктор делает первые
+// замеры, и они тоже должны пройти через неё.
+//
+// Формат: "ULSMTRC1", затем записи с байтом-тегом и полями varint:
+//   1 источник - длина и имя; номер - порядковый;
+//   2 замер    - номер сборщика, время от предыдущего замера в нс;
+//   3 чтение   - источник, длина + 1 (0 - ошибка чтения), длины общих с
+//                прошлым содержимым источника префикса и суффикса,
+//                оставшиеся байты.
+// /proc/stat и meminfo между замерами отличаются несколькими числами,
+// поэтому префикс и суффикс срезают большую часть объёма.
+class InputTrace {
+public:
+  static InputTrace &GetInstance() {
+    static InputTrace trace;
+    return trace;
+  }
+  InputTrace(const InputTrace &) = delete;
+  InputTrace &operator=(const InputTrace &) = delete;
+
+  bool StartRecording(const char *path, std::string &error);
+  // Дописывает буфер и закрывает файл; false - часть трассы не
+  // записалась, причина в GetError.
+  bool StopRecording();
+  bool IsRecording() const;
+  const std::string &GetError() const;
+
+  bool OpenReplay(const char *path, std::string &error);
+  bool IsReplaying() const;
+
+  // Замер на вызывающем потоке: между BeginRun/BeginReplayRun и EndRun
+  // чтения через TracedRead записываются или воспроизводятся.
+  void BeginRun(uint32_t collector, uint64_t timeNs);
+  void BeginReplayRun();
+  void EndRun();
+  static bool IsTracing() { return tracing; }
+
+  // Время следующего замера трассы без его разбора; false - конец.
+  bool PeekRun(uint64_t &timeNs);
+  // Разбирает следующий замер и его чтения; false - конец или файл
+  // повреждён.
+  bool NextRun(uint32_t &collector, uint64_t &timeNs);
+  uint64_t GetFileBytes() const;
+
+  // read() кладёт в buffer не больше size байт и возвращает их число
+  // или -1; при воспроизведении вызова нет, результат берётся из трассы.
+  template <typename Read>
+  ssize_t Trace(std::string_view source, char *buffer, size_t size, Read read) {
+    if (replaying) {
+      return Replay(source, buffer, size);
+    }
+    ssize_t got = read();
+    Record(source, buffer, got);
+    return got;
+  }
+
+private:
+  InputTrace() = default;
+  ~InputTrace();
+
+  static thread_local bool tracing;
+
+  // Имена источников хранятся один раз; содержимое - последнее
+  // прочитанное, от него считаются общие префикс и суффикс.
+  std::deque<std::string> sourceNames;
+  std::unordered_map<std::string_view, uint32_t> sourceIds;
+  std::vector<std::string> lastContent;
+
+  int fd = -1;
+  std::vector<uint8_t> output;
+  std::string error; // первая ошибка записи
+  uint64_t lastRunNs = 0;
+  uint64_t lastFlushNs = 0;
+
+  bool replaying = false;
+  std::vector<uint8_t> file;
+  size_t cursor = 0;
+  bool runPending = false;
+  uint32_t pendingCollector = 0;
+  uint64_t pendingTimeNs = 0;
+  struct Entry {
+    uint32_t source;
+    ssize_t length;
+    size_t offset; // в arena
+    bool used;
+  };
+  std::vector<Entry> entries;
+  std::vector<char> arena;
+  size_t nextEntry = 0;
+
+  uint32_t GetSourceId(std::string_view source, bool &added);
+  void Record(std::string_view source, const char *data, ssize_t got);
+  ssize_t Replay(std::string_view source, char *buffer, size_t size);
+  void Flush();
+};
+
+// Чтение источника через трассу; вне замера - просто read().
+template <typename Read>
+ssize_t TracedRead(std::string_view source, char *buffer, size_t size, Read read) {
+  if (!InputTrace::IsTracing()) {
+    return read();
+  }
+  return InputTrace::GetInstance().Trace(source, buffer, size, read);
+}
+
+// То же для источников по номеру (датчик, домен, процессор): имя
+// "kind:index" собирается только во время записи или воспроизведения.
+template <typename Read>
+ssize_t TracedRead(const char *kind, size_t index, char *buffer, size_t size, Read read) {
+  if (!InputTrace::IsTracing()) {
+    return read();
+  }
+  char source[48];
+  snprintf(source, sizeof(source), "%s:%zu", kind, index);
+  return InputTrace::GetInstance().Trace(source, buffer, size, read);
+}
+} // namespace Devices
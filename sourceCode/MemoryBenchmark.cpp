@@ -0,0 +1,451 @@
+#include "MemoryBenchmark.hpp"
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ULSM_X86 1
+#endif
+
+namespace {
+const size_t lineBytes = 64;
+const unsigned latencyRepeats = 3;
+const unsigned bandwidthRepeats = 5;
+const double scalar = 3.0;
+const int mpolBind = 2; // MPOL_BIND из linux/mempolicy.h
+
+volatile uintptr_t chaseSink;
+
+void PinToCpu(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Анонимное отображение, привязанное к узлу до первого касания.
+class Mapping {
+public:
+    ~Mapping() {
+        if (data) {
+            munmap(data, size);
+        }
+    }
+
+    bool Map(size_t bytes, int node, bool hugePages, std::string &error) {
+        size = bytes;
+        data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            error = std::string("cannot allocate benchmark memory: ") + strerror(errno);
+            return false;
+        }
+        if (hugePages) {
+            madvise(data, bytes, MADV_HUGEPAGE);
+        }
+        if (node >= 0) {
+            unsigned long mask[16] = {};
+            const size_t bits = sizeof(mask[0]) * 8;
+            if (static_cast<size_t>(node) >= sizeof(mask) * 8) {
+                error = "NUMA node out of range";
+                return false;
+            }
+            mask[node / bits] |= 1ul << (node % bits);
+            if (syscall(SYS_mbind, data, bytes, mpolBind, mask, sizeof(mask) * 8, 0) != 0) {
+                error = "cannot bind memory to node " + std::to_string(node) + ": " +
+                        strerror(errno);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void *data = nullptr;
+    size_t size = 0;
+};
+
+uint64_t Chase(void *start, uint64_t loads) {
+    void **p = static_cast<void **>(start);
+    for (uint64_t i = 0; i < loads; i += 8) {
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+        p = static_cast<void **>(*p);
+    }
+    chaseSink = reinterpret_cast<uintptr_t>(p);
+    return (loads + 7) / 8 * 8;
+}
+
+// Случайный цикл по всем строкам набора (алгоритм Саттоло): следующий
+// адрес непредсказуем для префетчера, каждая строка посещается.
+void BuildChain(char *base, size_t lines, std::vector<uint32_t> &order, uint64_t &seed) {
+    order.resize(lines);
+    for (size_t i = 0; i < lines; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    for (size_t i = lines - 1; i > 0; --i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::swap(order[i], order[seed % i]);
+    }
+    for (size_t i = 0; i < lines; ++i) {
+        *reinterpret_cast<void **>(base + i * lineBytes) = base + order[i] * lineBytes;
+    }
+}
+
+void RunRegular(Devices::MemoryBenchmark::Test test, double *a, double *b, double *c,
+                size_t count) {
+    using Test = Devices::MemoryBenchmark::Test;
+    switch (test) {
+    case Test::Copy:
+        for (size_t i = 0; i < count; ++i) {
+            c[i] = a[i];
+        }
+        break;
+    case Test::Scale:
+        for (size_t i = 0; i < count; ++i) {
+            b[i] = scalar * c[i];
+        }
+        break;
+    case Test::Add:
+        for (size_t i = 0; i < count; ++i) {
+            c[i] = a[i] + b[i];
+        }
+        break;
+    default:
+        for (size_t i = 0; i < count; ++i) {
+            a[i] = b[i] + scalar * c[i];
+        }
+        break;
+    }
+}
+
+#ifdef ULSM_X86
+// Запись мимо кэша: строка не читается перед записью и не вытесняет
+// рабочие данные. Срезы выровнены по строке кэша.
+__attribute__((target("sse2"))) void RunNonTemporal(Devices::MemoryBenchmark::Test test,
+                                                    double *a, double *b, double *c,
+                                                    size_t count) {
+    using Test = Devices::MemoryBenchmark::Test;
+    const __m128d s = _mm_set1_pd(scalar);
+    switch (test) {
+    case Test::Copy:
+        for (size_t i = 0; i < count; i += 2) {
+            _mm_stream_pd(c + i, _mm_load_pd(a + i));
+        }
+        break;
+    case Test::Scale:
+        for (size_t i = 0; i < count; i += 2) {
+            _mm_stream_pd(b + i, _mm_mul_pd(s, _mm_load_pd(c + i)));
+        }
+        break;
+    case Test::Add:
+        for (size_t i = 0; i < count; i += 2) {
+            _mm_stream_pd(c + i, _mm_add_pd(_mm_load_pd(a + i), _mm_load_pd(b + i)));
+        }
+        break;
+    default:
+        for (size_t i = 0; i < count; i += 2) {
+            _mm_stream_pd(a + i, _mm_add_pd(_mm_load_pd(b + i),
+                                            _mm_mul_pd(s, _mm_load_pd(c + i))));
+        }
+        break;
+    }
+    _mm_sfence();
+}
+#endif
+
+// Байт на элемент по соглашению STREAM.
+size_t BytesPerElement(Devices::MemoryBenchmark::Test test) {
+    using Test = Devices::MemoryBenchmark::Test;
+    return test == Test::Copy || test == Test::Scale ? 2 * sizeof(double) : 3 * sizeof(double);
+}
+} // namespace
+
+namespace Devices {
+MemoryBenchmark::~MemoryBenchmark() { Stop(); }
+
+const char *MemoryBenchmark::GetTestName(Test test) {
+    switch (test) {
+    case Test::Copy:
+        return "Copy";
+    case Test::Scale:
+        return "Scale";
+    case Test::Add:
+        return "Add";
+    default:
+        return "Triad";
+    }
+}
+
+bool MemoryBenchmark::HasNonTemporalStores() {
+#ifdef ULSM_X86
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+bool MemoryBenchmark::Start(const Options &options, std::string &error) {
+    if (IsRunning()) {
+        error = "memory benchmark is already running";
+        return false;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (options.threads == 0) {
+        error = "at least one thread is required";
+        return false;
+    }
+    if (options.minWorkingSet < 2 * lineBytes || options.maxWorkingSet < options.minWorkingSet) {
+        error = "invalid working set range";
+        return false;
+    }
+
+    Options resolved = options;
+    if (resolved.cpus.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    resolved.cpus.push_back(cpu);
+                }
+            }
+        }
+    }
+    if (resolved.cpus.empty()) {
+        error = "no CPUs available";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.latency.clear();
+        results.bandwidth.clear();
+        results.progress = 0;
+        results.error.clear();
+    }
+    stopRequested = false;
+    running = true;
+    thread = std::thread(&MemoryBenchmark::Run, this, std::move(resolved));
+    return true;
+}
+
+void MemoryBenchmark::Stop() {
+    stopRequested = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool MemoryBenchmark::IsRunning() const { return running.load(); }
+
+void MemoryBenchmark::GetResults(Results &out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.latency.assign(results.latency.begin(), results.latency.end());
+    out.bandwidth.assign(results.bandwidth.begin(), results.bandwidth.end());
+    out.progress = results.progress;
+    out.error = results.error;
+}
+
+void MemoryBenchmark::SetProgress(unsigned step, unsigned steps) {
+    std::lock_guard<std::mutex> lock(mutex);
+    results.progress = steps ? step * 100 / steps : 100;
+}
+
+void MemoryBenchmark::Fail(const std::string &error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    results.error = error;
+}
+
+void MemoryBenchmark::Run(Options options) {
+    PinToCpu(options.cpus.front());
+
+    // Две точки на октаву: перегибы между степенями двойки не теряются
+    unsigned latencySteps = 0;
+    for (size_t size = options.minWorkingSet; size <= options.maxWorkingSet; size *= 2) {
+        latencySteps += size + size / 2 <= options.maxWorkingSet ? 2 : 1;
+    }
+    unsigned bandwidthSteps = static_cast<unsigned>(Test::Count) * 2;
+    unsigned steps = latencySteps + bandwidthSteps;
+
+    MeasureLatency(options, steps);
+    if (!stopRequested) {
+        MeasureBandwidth(options, latencySteps, steps);
+    }
+    SetProgress(steps, steps);
+    running = false;
+}
+
+void MemoryBenchmark::MeasureLatency(const Options &options, unsigned steps) {
+    Mapping mapping;
+    std::string error;
+    if (!mapping.Map(options.maxWorkingSet, options.memoryNode, options.hugePages, error)) {
+        Fail(error);
+        return;
+    }
+    char *base = static_cast<char *>(mapping.data);
+    std::vector<uint32_t> order;
+    uint64_t seed = 0x2545f4914f6cdd1dull;
+    unsigned step = 0;
+
+    auto measure = [&](size_t workingSet) {
+        size_t lines = workingSet / lineBytes;
+        BuildChain(base, lines, order, seed);
+        uint64_t loads = std::min<uint64_t>(std::max<uint64_t>(2 * lines, 1 << 20), 1 << 22);
+        Chase(base, std::min<uint64_t>(lines, loads)); // прогрев кэшей и TLB
+        double best = 0;
+        for (unsigned repeat = 0; repeat < latencyRepeats && !stopRequested; ++repeat) {
+            uint64_t start = Diagnostics::MonotonicNs();
+            uint64_t done = Chase(base, loads);
+            double ns = static_cast<double>(Diagnostics::MonotonicNs() - start) / done;
+            best = repeat == 0 ? ns : std::min(best, ns);
+        }
+        if (best > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.latency.push_back({workingSet, best});
+        }
+        SetProgress(++step, steps);
+    };
+
+    for (size_t size = options.minWorkingSet;
+         size <= options.maxWorkingSet && !stopRequested; size *= 2) {
+        measure(size);
+        if (size + size / 2 <= options.maxWorkingSet && !stopRequested) {
+            measure(size + size / 2);
+        }
+    }
+}
+
+void MemoryBenchmark::MeasureBandwidth(const Options &options, unsigned firstStep,
+                                       unsigned steps) {
+    const unsigned threads = options.threads;
+    // Срез потока - целое число строк кэша
+    const size_t granule = lineBytes / sizeof(double);
+    size_t perThread = options.arrayBytes / sizeof(double) / threads / granule * granule;
+    if (perThread == 0) {
+        Fail("STREAM arrays are too small for the thread count");
+        return;
+    }
+    size_t count = perThread * threads;
+
+    Mapping mapping;
+    std::string error;
+    if (!mapping.Map(3 * count * sizeof(double), options.memoryNode, options.hugePages, error)) {
+        Fail(error);
+        return;
+    }
+    double *a = static_cast<double *>(mapping.data);
+    double *b = a + count;
+    double *c = b + count;
+
+    // Пул закреплённых потоков: раунд начинается приращением round,
+    // команда публикуется до него. Первый раунд заполняет массивы, так
+    // что без mbind страницы оказываются на узле своего потока.
+    enum class Command { Fill, Regular, NonTemporal, Quit };
+    std::atomic<unsigned> round{0};
+    std::atomic<unsigned> done{0};
+    // Координатор закреплён за процессором потока 0 (ради замера
+    // задержки) и ждёт конца раунда во сне, а не крутится рядом с ним
+    std::mutex roundMutex;
+    std::condition_variable roundDone;
+    Command command = Command::Fill;
+    Test test = Test::Copy;
+
+    std::vector<std::thread> pool;
+    for (unsigned index = 0; index < threads; ++index) {
+        pool.emplace_back([&, index] {
+            PinToCpu(options.cpus[index % options.cpus.size()]);
+            size_t begin = index * perThread;
+            unsigned seen = 0;
+            for (;;) {
+                unsigned current;
+                while ((current = round.load(std::memory_order_acquire)) == seen) {
+                    std::this_thread::yield();
+                }
+                seen = current;
+                if (command == Command::Quit) {
+                    break;
+                }
+                if (command == Command::Fill) {
+                    std::fill(a + begin, a + begin + perThread, 1.0);
+                    std::fill(b + begin, b + begin + perThread, 2.0);
+                    std::fill(c + begin, c + begin + perThread, 0.0);
+                }
+#ifdef ULSM_X86
+                else if (command == Command::NonTemporal) {
+                    RunNonTemporal(test, a + begin, b + begin, c + begin, perThread);
+                }
+#endif
+                else {
+                    RunRegular(test, a + begin, b + begin, c + begin, perThread);
+                }
+                if (done.fetch_add(1, std::memory_order_release) + 1 == threads) {
+                    std::lock_guard<std::mutex> lock(roundMutex);
+                    roundDone.notify_one();
+                }
+            }
+        });
+    }
+
+    auto runRound = [&](Command next) {
+        command = next;
+        done.store(0, std::memory_order_relaxed);
+        uint64_t start = Diagnostics::MonotonicNs();
+        round.fetch_add(1, std::memory_order_release);
+        if (next != Command::Quit) {
+            std::unique_lock<std::mutex> lock(roundMutex);
+            roundDone.wait(lock, [&] { return done.load(std::memory_order_acquire) >= threads; });
+        }
+        return Diagnostics::MonotonicNs() - start;
+    };
+
+    runRound(Command::Fill);
+    unsigned step = firstStep;
+    for (bool nonTemporal : {false, true}) {
+        for (size_t index = 0; index < static_cast<size_t>(Test::Count); ++index) {
+            if (stopRequested) {
+                break;
+            }
+            test = static_cast<Test>(index);
+            if (nonTemporal && !HasNonTemporalStores()) {
+                SetProgress(++step, steps);
+                continue;
+            }
+            // Как в STREAM: лучший из повторов
+            uint64_t best = UINT64_MAX;
+            for (unsigned repeat = 0; repeat < bandwidthRepeats && !stopRequested; ++repeat) {
+                best = std::min(best, runRound(nonTemporal ? Command::NonTemporal
+                                                           : Command::Regular));
+            }
+            if (best != UINT64_MAX && best != 0) {
+                double bytes = static_cast<double>(BytesPerElement(test) * count);
+                std::lock_guard<std::mutex> lock(mutex);
+                results.bandwidth.push_back({test, nonTemporal, bytes * 1e9 / best});
+            }
+            SetProgress(++step, steps);
+        }
+    }
+
+    runRound(Command::Quit);
+    for (std::thread &worker : pool) {
+        worker.join();
+    }
+}
+} // namespace Devices
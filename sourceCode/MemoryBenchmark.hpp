@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Devices {
+// Замер иерархии памяти в фоновом потоке.
+// Латентность - pointer chasing по случайному циклу строк кэша в рабочем
+// наборе растущего размера: перегибы кривой совпадают с размерами L1/L2/L3
+// и TLB. Пропускная способность - ядра STREAM (copy, scale, add, triad) в
+// обычном варианте и с non-temporal записью, на заданном числе потоков.
+// Память можно привязать к узлу NUMA (mbind), иначе страницы размещаются
+// первым касанием потока, который с ними и работает.
+class MemoryBenchmark {
+public:
+  enum class Test { Copy, Scale, Add, Triad, Count };
+
+  struct Options {
+    size_t minWorkingSet = 4 << 10;
+    size_t maxWorkingSet = 256 << 20;
+    // Размер каждого из трёх массивов STREAM; по правилам STREAM - не
+    // меньше четырёх объёмов последнего кэша.
+    size_t arrayBytes = 64 << 20;
+    unsigned threads = 1;
+    // Потоки закрепляются по кругу за этими процессорами, латентность
+    // меряется на первом. Пусто - все процессоры, доступные процессу.
+    std::vector<unsigned> cpus;
+    int memoryNode = -1; // -1 - без привязки (first touch)
+    bool hugePages = true; // подсказка THP, меньше промахов TLB
+  };
+
+  struct LatencyPoint {
+    size_t workingSet;
+    double nsPerLoad;
+  };
+
+  // Байты считаются по соглашению STREAM: без чтения строки под запись.
+  struct Bandwidth {
+    Test test;
+    bool nonTemporal;
+    double bytesPerSecond;
+  };
+
+  struct Results {
+    std::vector<LatencyPoint> latency;
+    std::vector<Bandwidth> bandwidth;
+    unsigned progress = 0; // проценты
+    std::string error;
+  };
+
+  MemoryBenchmark() = default;
+  ~MemoryBenchmark();
+  MemoryBenchmark(const MemoryBenchmark &) = delete;
+  MemoryBenchmark &operator=(const MemoryBenchmark &) = delete;
+
+  static const char *GetTestName(Test test);
+  static bool HasNonTemporalStores();
+
+  bool Start(const Options &options, std::string &error);
+  // Прерывает замер; уже полученные точки остаются в результатах.
+  void Stop();
+  bool IsRunning() const;
+  // Копия результатов под блокировкой, ёмкость out переиспользуется.
+  void GetResults(Results &out) const;
+
+private:
+  std::thread thread;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> running{false};
+  mutable std::mutex mutex;
+  Results results;
+
+  void Run(Options options);
+  void MeasureLatency(const Options &options, unsigned steps);
+  void MeasureBandwidth(const Options &options, unsigned firstStep, unsigned steps);
+  void SetProgress(unsigned step, unsigned steps);
+  void Fail(const std::string &error);
+};
+} // namespace Devices
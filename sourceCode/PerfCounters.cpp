@@ -0,0 +1,253 @@
+#include "PerfCounters.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+enum Event {
+    Cycles,
+    Instructions,
+    CacheReferences,
+    CacheMisses,
+    BranchMisses,
+    StalledCycles,
+    CpuClock,
+    ContextSwitches,
+    CpuMigrations,
+    PageFaults,
+    EventCount
+};
+
+struct EventDefinition {
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventDefinition definitions[EventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+const int hardwarePairs[][2] = {
+    {Cycles, Instructions}, {CacheReferences, CacheMisses}, {BranchMisses, StalledCycles}};
+
+int OpenEvent(int event, unsigned cpu, int groupFd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = definitions[event].type;
+    attr.config = definitions[event].config;
+    attr.read_format =
+        PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Группа включается целиком после открытия всех событий
+    attr.disabled = groupFd < 0;
+    return static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, -1, static_cast<int>(cpu), groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+int ReadParanoid() {
+    char buffer[16] = {};
+    int fd = open("/proc/sys/kernel/perf_event_paranoid", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 2;
+    }
+    ssize_t got = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    return got > 0 ? atoi(buffer) : 2;
+}
+
+// 0 при успехе, иначе errno открытия лидера.
+int OpenGroup(std::vector<int> &fds, std::vector<int> &events, int &leader, unsigned cpu,
+              int first, int last) {
+    leader = OpenEvent(first, cpu, -1);
+    if (leader < 0) {
+        return errno;
+    }
+    events.push_back(first);
+    for (int event = first + 1; event <= last; ++event) {
+        int fd = OpenEvent(event, cpu, leader);
+        if (fd >= 0) {
+            fds.push_back(fd);
+            events.push_back(event);
+        }
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return 0;
+}
+} // namespace
+
+namespace Devices {
+PerfCounters::~PerfCounters() { Close(); }
+
+void PerfCounters::CloseGroup(Group &group) {
+    for (int fd : group.fds) {
+        close(fd);
+    }
+    if (group.leader >= 0) {
+        close(group.leader);
+    }
+    group = Group();
+}
+
+void PerfCounters::Close() {
+    for (Group &group : hardware) {
+        CloseGroup(group);
+    }
+    for (Group &group : software) {
+        CloseGroup(group);
+    }
+    hardware.clear();
+    software.clear();
+    counters.clear();
+    hasHardware = false;
+}
+
+bool PerfCounters::Open(const std::vector<bool> &online, std::string &error) {
+    Close();
+    hardware.resize(online.size() * hardwareGroupCount);
+    software.resize(online.size());
+    counters.assign(online.size(), CoreCounters());
+    readBuffer.assign(3 + EventCount, 0);
+
+    // Нет PMU - ядро отвечает ENOENT/EOPNOTSUPP на первом же процессоре,
+    // остальные не пробуем
+    bool tryHardware = true;
+    bool opened = false;
+    int failure = 0;
+    for (unsigned cpu = 0; cpu < online.size(); ++cpu) {
+        if (!online[cpu]) {
+            continue;
+        }
+        for (size_t pair = 0; tryHardware && pair < hardwareGroupCount; ++pair) {
+            Group &group = hardware[cpu * hardwareGroupCount + pair];
+            int result = OpenGroup(group.fds, group.events, group.leader, cpu,
+                                   hardwarePairs[pair][0], hardwarePairs[pair][1]);
+            if (result == 0) {
+                group.last.assign(group.events.size(), 0);
+                hasHardware = true;
+                opened = true;
+            } else if (pair == 0 && (result == ENOENT || result == EOPNOTSUPP || result == ENODEV)) {
+                tryHardware = false;
+            } else if (pair == 0) {
+                failure = result;
+            }
+            // Лидер второй или третьей пары, которого нет на этом PMU,
+            // просто оставляет свои показатели нулями
+        }
+        Group &group = software[cpu];
+        int result = OpenGroup(group.fds, group.events, group.leader, cpu, CpuClock, PageFaults);
+        if (result == 0) {
+            group.last.assign(group.events.size(), 0);
+            opened = true;
+        } else {
+            failure = result;
+        }
+    }
+    if (!opened) {
+        if (failure == EACCES || failure == EPERM) {
+            error = "perf_event_open: permission denied (kernel.perf_event_paranoid = " +
+                    std::to_string(ReadParanoid()) + ", needs CAP_PERFMON or a value <= 0)";
+        } else {
+            error = std::string("perf_event_open: ") + strerror(failure);
+        }
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool PerfCounters::IsOpen() const { return !counters.empty(); }
+bool PerfCounters::HasHardware() const { return hasHardware; }
+const std::vector<CoreCounters> &PerfCounters::GetCounters() const { return counters; }
+
+float PerfCounters::ReadGroup(Group &group, CoreCounters &out) {
+    // nr, time_enabled, time_running, значения в порядке открытия
+    size_t bytes = (3 + group.events.size()) * sizeof(uint64_t);
+    if (read(group.leader, readBuffer.data(), bytes) != static_cast<ssize_t>(bytes)) {
+        return 0;
+    }
+    uint64_t enabled = readBuffer[1];
+    uint64_t running = readBuffer[2];
+    uint64_t deltaEnabled = enabled - group.lastEnabled;
+    uint64_t deltaRunning = running - group.lastRunning;
+    bool first = group.lastEnabled == 0;
+    group.lastEnabled = enabled;
+    group.lastRunning = running;
+
+    double scale = deltaRunning != 0 ? static_cast<double>(deltaEnabled) / deltaRunning : 0;
+    double seconds = deltaEnabled / 1e9;
+    for (size_t i = 0; i < group.events.size(); ++i) {
+        uint64_t value = readBuffer[3 + i];
+        double rate = first || seconds <= 0 ? 0 : (value - group.last[i]) * scale / seconds;
+        group.last[i] = value;
+        switch (group.events[i]) {
+        case Cycles:
+            out.cycles = rate;
+            break;
+        case Instructions:
+            out.instructions = rate;
+            break;
+        case CacheReferences:
+            out.cacheReferences = rate;
+            break;
+        case CacheMisses:
+            out.cacheMisses = rate;
+            break;
+        case BranchMisses:
+            out.branchMisses = rate;
+            break;
+        case StalledCycles:
+            out.stalledCycles = rate;
+            break;
+        case ContextSwitches:
+            out.contextSwitches = rate;
+            break;
+        case CpuMigrations:
+            out.migrations = rate;
+            break;
+        case PageFaults:
+            out.pageFaults = rate;
+            break;
+        default:
+            break; // cpu-clock - только лидер: в системном режиме идёт и в простое
+        }
+    }
+    return deltaEnabled != 0 ? static_cast<float>(deltaRunning) / deltaEnabled : 0;
+}
+
+void PerfCounters::Read() {
+    for (size_t cpu = 0; cpu < counters.size(); ++cpu) {
+        CoreCounters &out = counters[cpu];
+        out = CoreCounters();
+        for (size_t pair = 0; pair < hardwareGroupCount; ++pair) {
+            Group &group = hardware[cpu * hardwareGroupCount + pair];
+            if (group.leader < 0) {
+                continue;
+            }
+            float running = ReadGroup(group, out);
+            out.running = out.hardware ? std::min(out.running, running) : running;
+            out.hardware = true;
+        }
+        out.ipc = out.cycles > 0 ? static_cast<float>(out.instructions / out.cycles) : 0;
+        if (software[cpu].leader >= 0) {
+            ReadGroup(software[cpu], out);
+        }
+    }
+}
+} // namespace Devices
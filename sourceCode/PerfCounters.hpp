@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Devices {
+// Показатели одного логического процессора за последний интервал, в
+// секунду; поправка на мультиплексирование уже внесена. Нули - событие
+// недоступно или процессор выключен.
+struct CoreCounters {
+  bool hardware = false; // есть ли аппаратные счётчики
+  float ipc = 0;
+  double cycles = 0;
+  double instructions = 0;
+  double cacheReferences = 0;
+  double cacheMisses = 0;
+  double branchMisses = 0;
+  double stalledCycles = 0; // backend: ожидание памяти и исполнительных блоков
+  double contextSwitches = 0;
+  double migrations = 0;
+  double pageFaults = 0;
+  // Доля интервала на PMU у хуже всех обслуженной аппаратной группы:
+  // меньше 1 - мультиплексирование, 0 - группа не помещается на PMU и
+  // её показатели не измерены.
+  float running = 0;
+};
+
+// Системные счётчики perf_event_open на каждый процессор (pid = -1).
+// На процессор три аппаратные группы по два события (cycles +
+// instructions, cache-references + cache-misses, branch-misses +
+// stalled-cycles) и программная с лидером cpu-clock (context-switches,
+// cpu-migrations, page-faults). Все шесть аппаратных событий в одной
+// группе могут не поместиться на PMU (на AMD один счётчик занимает NMI
+// watchdog), и такая группа не считается вовсе; пары помещаются везде,
+// а при нехватке счётчиков ядро мультиплексирует их по очереди.
+// Группа читается одним read с PERF_FORMAT_GROUP, так что события
+// группы сняты за одно и то же время и масштабируются общим
+// time_enabled / time_running; IPC берётся из одной группы.
+// Без PMU (виртуальная машина) остаётся только программная группа.
+// Событие, которое ядро не поддерживает (stalled-cycles-backend на
+// многих Intel), исключается, остальные работают.
+class PerfCounters {
+public:
+  PerfCounters() = default;
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  // online[N] - включён ли cpuN. false и текст в error, если не
+  // открылась ни одна группа (perf_event_paranoid, нет CAP_PERFMON).
+  bool Open(const std::vector<bool> &online, std::string &error);
+  void Close();
+  bool IsOpen() const;
+  bool HasHardware() const;
+
+  // Один проход read по всем группам; скорости - по разнице с прошлым.
+  void Read();
+  const std::vector<CoreCounters> &GetCounters() const;
+
+private:
+  struct Group {
+    int leader = -1;
+    std::vector<int> fds;
+    std::vector<int> events; // индекс события для каждого значения группы
+    std::vector<uint64_t> last;
+    uint64_t lastEnabled = 0;
+    uint64_t lastRunning = 0;
+  };
+  static constexpr size_t hardwareGroupCount = 3;
+  std::vector<Group> hardware; // hardwareGroupCount групп на процессор
+  std::vector<Group> software;
+  std::vector<CoreCounters> counters;
+  std::vector<uint64_t> readBuffer;
+  bool hasHardware = false;
+
+  static void CloseGroup(Group &group);
+  // Доля интервала, когда группа стояла на PMU.
+  float ReadGroup(Group &group, CoreCounters &out);
+};
+} // namespace Devices
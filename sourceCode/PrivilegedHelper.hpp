@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace Devices {
+// Разделение привилегий: данные, доступные только root (таблица
+// SMBIOS), собирает отдельный маленький исполняемый файл ulsm-helper.
+// Он запускается один раз при старте через sudo (пароль спрашивает сам
+// sudo с терминала) и живёт, пока открыт его конец socketpair. Помощник
+// не принимает путей и команд, только номера запросов из Request, и
+// отвечает двоичным кадром Header + length байт.
+class PrivilegedHelper {
+public:
+  enum class Request : uint32_t { DmiTable = 1 };
+
+  struct Header {
+    uint32_t request;
+    int32_t status; // 0 или errno на стороне помощника
+    uint32_t length;
+  };
+
+  static PrivilegedHelper &GetInstance() {
+    static PrivilegedHelper helper;
+    return helper;
+  }
+  PrivilegedHelper(const PrivilegedHelper &) = delete;
+  PrivilegedHelper &operator=(const PrivilegedHelper &) = delete;
+
+  // Помощник ищется рядом с исполняемым файлом, ULSM_HELPER задаёт путь
+  // явно. Уже root - запускается без sudo.
+  bool Start(std::string &error);
+  void Stop();
+
+  // Запрос и ответ целиком; вызовы из разных потоков идут по очереди.
+  bool Call(Request request, std::vector<uint8_t> &reply, std::string &error);
+
+  // Сторона помощника: обслуживает запросы на fd до закрытия сокета.
+  static int Serve(int fd);
+
+private:
+  PrivilegedHelper() = default;
+  ~PrivilegedHelper();
+
+  std::mutex mutex; // один запрос в полёте
+  std::atomic<int> fd{-1};
+  pid_t pid = -1;
+};
+} // namespace Devices
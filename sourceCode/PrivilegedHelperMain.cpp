@@ -0,0 +1,9 @@
+#include "PrivilegedHelper.hpp"
+#include <unistd.h>
+
+// ulsm-helper: запускается ULSM через sudo, запросы приходят на stdin
+// (конец socketpair), ответы уходят туда же.
+int main()
+{
+    return Devices::PrivilegedHelper::Serve(STDIN_FILENO);
+}
@@ -0,0 +1,204 @@
+#include "QuantileSketch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double bucketGamma = (1 + Devices::QuantileSketch::relativeAccuracy) /
+                     (1 - Devices::QuantileSketch::relativeAccuracy);
+const double logGamma = std::log(bucketGamma);
+} // namespace
+
+namespace Devices {
+int32_t QuantileSketch::Index(double value) {
+    return static_cast<int32_t>(std::ceil(std::log(value) / logGamma));
+}
+
+// Середина корзины в смысле относительной погрешности.
+double QuantileSketch::Value(int32_t index) {
+    return 2 * std::pow(bucketGamma, index) / (bucketGamma + 1);
+}
+
+void QuantileSketch::Add(double value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (total == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    total += count;
+    if (value < minIndexable) {
+        zeroCount += count;
+        return;
+    }
+    AddToBucket(Index(value), count);
+}
+
+void QuantileSketch::AddToBucket(int32_t index, uint64_t count) {
+    if (bucketTotal == 0) {
+        counts.assign(1, 0);
+        offset = index;
+    }
+    bucketTotal += count;
+    // Ёмкость растёт удвоением, но не сверх maxBuckets
+    auto reserve = [this](size_t size) {
+        if (size > counts.capacity()) {
+            counts.reserve(std::min(maxBuckets, std::max(size, counts.capacity() * 2)));
+        }
+    };
+
+    if (index < offset) {
+        // Ниже занятого диапазона: если расширение вниз не помещается,
+        // значение уходит в младшую корзину (она и так сливная)
+        size_t grow = static_cast<size_t>(offset - index);
+        if (counts.size() + grow > maxBuckets) {
+            grow = maxBuckets - counts.size();
+        }
+        reserve(counts.size() + grow);
+        counts.insert(counts.begin(), grow, 0);
+        offset -= static_cast<int32_t>(grow);
+        index = std::max(index, offset);
+    } else if (index >= offset + static_cast<int32_t>(counts.size())) {
+        size_t size = static_cast<size_t>(index - offset) + 1;
+        uint64_t collapsed = 0;
+        if (size > maxBuckets) {
+            // Младшие корзины сливаются в первую сохраняемую
+            size_t drop = size - maxBuckets;
+            size_t dropped = std::min(drop, counts.size());
+            for (size_t i = 0; i < dropped; ++i) {
+                collapsed += counts[i];
+            }
+            counts.erase(counts.begin(), counts.begin() + static_cast<std::ptrdiff_t>(dropped));
+            offset += static_cast<int32_t>(drop);
+            size = maxBuckets;
+        }
+        reserve(size);
+        counts.resize(size, 0);
+        counts[0] += collapsed;
+    }
+    counts[static_cast<size_t>(index - offset)] += count;
+}
+
+void QuantileSketch::Merge(const QuantileSketch &other) {
+    if (other.total == 0) {
+        return;
+    }
+    if (total == 0) {
+        min = other.min;
+        max = other.max;
+    } else {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    total += other.total;
+    zeroCount += other.zeroCount;
+    // Сначала старшая корзина: диапазон расширяется один раз
+    for (size_t i = other.counts.size(); i-- > 0;) {
+        if (other.counts[i] != 0) {
+            AddToBucket(other.offset + static_cast<int32_t>(i), other.counts[i]);
+        }
+    }
+}
+
+void QuantileSketch::Clear() {
+    counts.clear();
+    bucketTotal = 0;
+    zeroCount = 0;
+    total = 0;
+    min = 0;
+    max = 0;
+}
+
+uint64_t QuantileSketch::GetCount() const { return total; }
+double QuantileSketch::GetMin() const { return min; }
+double QuantileSketch::GetMax() const { return max; }
+
+double QuantileSketch::GetQuantile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1));
+    if (rank < zeroCount) {
+        return std::max(0.0, min);
+    }
+    uint64_t seen = zeroCount;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            double value = Value(offset + static_cast<int32_t>(i));
+            return std::min(max, std::max(min, value));
+        }
+    }
+    return max;
+}
+
+size_t QuantileSketch::GetMemoryBytes() const {
+    return sizeof(*this) + counts.capacity() * sizeof(uint64_t);
+}
+
+uint64_t SlidingQuantiles::SliceNs(size_t window) {
+    const uint64_t second = 1000000000ull;
+    switch (static_cast<Window>(window)) {
+    case Window::Minute:
+        return 10 * second;
+    case Window::Hour:
+        return 600 * second;
+    default:
+        return 4 * 3600 * second;
+    }
+}
+
+// Шесть срезов в каждом окне: шаг сдвига - шестая часть окна
+size_t SlidingQuantiles::SliceCount(size_t) { return 6; }
+
+uint64_t SlidingQuantiles::GetWindowNs(Window window) {
+    size_t index = static_cast<size_t>(window);
+    return SliceNs(index) * SliceCount(index);
+}
+
+void SlidingQuantiles::Add(uint64_t timeNs, double value) {
+    for (size_t window = 0; window < rings.size(); ++window) {
+        Ring &ring = rings[window];
+        if (ring.slices.empty()) {
+            ring.slices.resize(SliceCount(window));
+            ring.epochs.assign(SliceCount(window), 0);
+        }
+        // Эпоха с единицы: 0 отмечает ещё не использованный срез
+        uint64_t epoch = timeNs / SliceNs(window) + 1;
+        size_t slot = epoch % ring.slices.size();
+        if (ring.epochs[slot] != epoch) {
+            ring.epochs[slot] = epoch;
+            ring.slices[slot].Clear();
+        }
+        ring.slices[slot].Add(value);
+    }
+}
+
+void SlidingQuantiles::MergeInto(Window window, uint64_t nowNs,
+                                 QuantileSketch &out) const {
+    size_t index = static_cast<size_t>(window);
+    const Ring &ring = rings[index];
+    uint64_t current = nowNs / SliceNs(index) + 1;
+    for (size_t slot = 0; slot < ring.slices.size(); ++slot) {
+        uint64_t epoch = ring.epochs[slot];
+        if (epoch != 0 && epoch <= current && epoch + ring.slices.size() > current) {
+            out.Merge(ring.slices[slot]);
+        }
+    }
+}
+
+size_t SlidingQuantiles::GetMemoryBytes() const {
+    size_t bytes = sizeof(*this);
+    for (const Ring &ring : rings) {
+        for (const QuantileSketch &slice : ring.slices) {
+            bytes += slice.GetMemoryBytes();
+        }
+        bytes += ring.epochs.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+} // namespace Devices
@@ -0,0 +1,193 @@
+#include "Scheduler.hpp"
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace Devices {
+Scheduler::Scheduler()
+    : timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+      error(timerFd < 0 ? errno : 0) {}
+
+Scheduler::~Scheduler() {
+    if (timerFd >= 0) {
+        close(timerFd);
+    }
+}
+
+uint64_t Scheduler::Now() { return Diagnostics::MonotonicNs(); }
+
+Scheduler::TaskId Scheduler::AddTask(const std::string &name,
+                                     uint64_t intervalNs, int priority,
+                                     Callback callback,
+                                     uint64_t idleIntervalNs) {
+    Task task;
+    task.name = name;
+    task.intervalNs = intervalNs;
+    task.idleIntervalNs = idleIntervalNs;
+    task.currentIntervalNs = intervalNs;
+    task.nextDueNs = Now() + intervalNs;
+    task.lastRunNs = 0;
+    task.lastElapsedNs = 0;
+    task.priority = priority;
+    task.viewed = true;
+    task.callback = std::move(callback);
+    task.histogram = &Diagnostics::GetInstance().GetHistogram(name);
+    tasks.push_back(std::move(task));
+    due.reserve(tasks.size());
+    Arm();
+    return tasks.size() - 1;
+}
+
+void Scheduler::SetInterval(TaskId id, uint64_t intervalNs) {
+    Task &task = tasks[id];
+    task.intervalNs = intervalNs;
+    if (task.viewed || task.currentIntervalNs < intervalNs) {
+        task.currentIntervalNs = intervalNs;
+    }
+    task.nextDueNs = std::min(task.nextDueNs, Now() + task.currentIntervalNs);
+    Arm();
+}
+
+void Scheduler::SetViewed(TaskId id, bool viewed) {
+    Task &task = tasks[id];
+    if (task.viewed == viewed) {
+        return;
+    }
+    task.viewed = viewed;
+    if (viewed) {
+        // Вернулись к просмотру - сразу к базовой частоте, без ожидания
+        // накопившегося длинного интервала.
+        task.currentIntervalNs = task.intervalNs;
+        task.nextDueNs = std::min(task.nextDueNs, Now() + task.intervalNs);
+        Arm();
+    }
+}
+
+bool Scheduler::IsViewed(TaskId id) const { return tasks[id].viewed; }
+uint64_t Scheduler::GetInterval(TaskId id) const { return tasks[id].intervalNs; }
+uint64_t Scheduler::GetCurrentInterval(TaskId id) const {
+    return tasks[id].currentIntervalNs;
+}
+uint64_t Scheduler::GetLastRun(TaskId id) const { return tasks[id].lastRunNs; }
+uint64_t Scheduler::GetLastElapsed(TaskId id) const {
+    return tasks[id].lastElapsedNs;
+}
+const std::string &Scheduler::GetName(TaskId id) const { return tasks[id].name; }
+size_t Scheduler::GetTaskCount() const { return tasks.size(); }
+int Scheduler::GetFd() const { return timerFd; }
+int Scheduler::GetError() const { return error; }
+
+int Scheduler::GetTimeoutMs() const {
+    if (tasks.empty()) {
+        return -1;
+    }
+    uint64_t nextNs = GetNextDue();
+    uint64_t nowNs = Now();
+    if (nextNs <= nowNs) {
+        return 0;
+    }
+    uint64_t timeoutMs = (nextNs - nowNs + 999999) / 1000000;
+    return static_cast<int>(std::min<uint64_t>(timeoutMs, INT32_MAX));
+}
+
+uint64_t Scheduler::GetNextDue() const {
+    uint64_t nextNs = tasks.front().nextDueNs;
+    for (const Task &task : tasks) {
+        nextNs = std::min(nextNs, task.nextDueNs);
+    }
+    return nextNs;
+}
+
+void Scheduler::Run(Task &task, uint64_t nowNs) {
+    {
+        ScopedTimer timer(*task.histogram);
+        task.callback(nowNs);
+    }
+    task.lastElapsedNs = task.lastRunNs == 0 ? 0 : nowNs - task.lastRunNs;
+    task.lastRunNs = nowNs;
+
+    if (!task.viewed && task.idleIntervalNs > task.currentIntervalNs) {
+        task.currentIntervalNs =
+            std::min(task.currentIntervalNs * 2, task.idleIntervalNs);
+    }
+
+    // Дедлайны по абсолютной сетке, чтобы задержка одного запуска не
+    // сдвигала все последующие; при сильном отставании - пересинхронизация.
+    task.nextDueNs += task.currentIntervalNs;
+    if (task.nextDueNs <= nowNs) {
+        task.nextDueNs = nowNs + task.currentIntervalNs;
+    }
+}
+
+size_t Scheduler::RunDue() {
+    if (timerFd >= 0) {
+        uint64_t expirations = 0;
+        while (read(timerFd, &expirations, sizeof(expirations)) < 0 &&
+               errno == EINTR) {
+        }
+    }
+
+    uint64_t nowNs = Now();
+    due.clear();
+    for (TaskId id = 0; id < tasks.size(); ++id) {
+        if (tasks[id].nextDueNs <= nowNs) {
+            due.push_back(id);
+        }
+    }
+    std::sort(due.begin(), due.end(), [this](TaskId left, TaskId right) {
+        return tasks[left].priority > tasks[right].priority;
+    });
+    for (TaskId id : due) {
+        Run(tasks[id], Now());
+    }
+
+    Arm();
+    return due.size();
+}
+
+void Scheduler::RunAll() {
+    for (Task &task : tasks) {
+        Run(task, Now());
+    }
+    Arm();
+}
+
+bool Scheduler::Wait(int timeoutMs) const {
+    if (error != 0) {
+        // Таймера нет - сон до ближайшего дедлайна
+        int dueMs = GetTimeoutMs();
+        if (dueMs >= 0 && (timeoutMs < 0 || dueMs <= timeoutMs)) {
+            poll(nullptr, 0, dueMs);
+            return true;
+        }
+        poll(nullptr, 0, timeoutMs);
+        return false;
+    }
+    pollfd descriptor{};
+    descriptor.fd = timerFd;
+    descriptor.events = POLLIN;
+    return poll(&descriptor, 1, timeoutMs) > 0;
+}
+
+void Scheduler::Arm() {
+    // После сбоя дедлайны ждёт вызывающий по GetTimeoutMs()
+    if (error != 0 || tasks.empty()) {
+        return;
+    }
+    uint64_t nextNs = GetNextDue();
+
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(nextNs / 1000000000ull);
+    spec.it_value.tv_nsec = static_cast<long>(nextNs % 1000000000ull);
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+        error = errno;
+    }
+}
+} // namespace Devices
@@ -0,0 +1,543 @@
+#include "SnapshotExport.hpp"
+#include "Diagnostics.hpp"
+#include "SysMonCore.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+using Devices::ExportWriter;
+
+bool WriteToFd(void *context, const char *data, size_t size) {
+    int fd = *static_cast<int *>(context);
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// "-" - маркер неизвестного значения в пуле строк, наружу уходит null.
+void Text(ExportWriter &writer, std::string_view key, std::string_view value) {
+    writer.Key(key);
+    if (value.empty() || value == "-") {
+        writer.Null();
+    } else {
+        writer.String(value);
+    }
+}
+
+void Uint(ExportWriter &writer, std::string_view key, uint64_t value) {
+    writer.Key(key);
+    writer.Uint(value);
+}
+
+void Int(ExportWriter &writer, std::string_view key, int64_t value) {
+    writer.Key(key);
+    writer.Int(value);
+}
+
+void Double(ExportWriter &writer, std::string_view key, double value) {
+    writer.Key(key);
+    writer.Double(value);
+}
+
+// Номер в топологии; -1 (неизвестно) - null.
+void Index(ExportWriter &writer, std::string_view key, int32_t value) {
+    writer.Key(key);
+    if (value < 0) {
+        writer.Null();
+    } else {
+        writer.Uint(static_cast<uint64_t>(value));
+    }
+}
+
+void Address(ExportWriter &writer, std::string_view key, int family, const void *address) {
+    char buffer[INET6_ADDRSTRLEN];
+    writer.Key(key);
+    if (inet_ntop(family, address, buffer, sizeof(buffer))) {
+        writer.String(buffer);
+    } else {
+        writer.Null();
+    }
+}
+
+const char *GetCacheType(char type) {
+    switch (type) {
+    case 'D':
+        return "data";
+    case 'I':
+        return "instruction";
+    default:
+        return "unified";
+    }
+}
+
+const char *GetDomainKind(Devices::PowerDomain::Kind kind) {
+    using Kind = Devices::PowerDomain::Kind;
+    switch (kind) {
+    case Kind::Package:
+        return "package";
+    case Kind::Core:
+        return "core";
+    case Kind::Uncore:
+        return "uncore";
+    case Kind::Dram:
+        return "dram";
+    case Kind::Platform:
+        return "platform";
+    default:
+        return "other";
+    }
+}
+} // namespace
+
+namespace Devices {
+bool ParseExportFormat(std::string_view name, ExportFormat &format) {
+    if (name == "json") {
+        format = ExportFormat::Json;
+        return true;
+    }
+    if (name == "cbor") {
+        format = ExportFormat::Cbor;
+        return true;
+    }
+    return false;
+}
+
+ExportWriter::ExportWriter(ExportFormat format, Sink sink, void *context)
+    : format(format), sink(sink), context(context) {}
+
+void ExportWriter::Put(const char *data, size_t size) {
+    while (size > 0 && !failed) {
+        if (used == buffer.size() && !Flush()) {
+            return;
+        }
+        size_t chunk = std::min(size, buffer.size() - used);
+        memcpy(buffer.data() + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void ExportWriter::PutByte(uint8_t byte) {
+    char value = static_cast<char>(byte);
+    Put(&value, 1);
+}
+
+bool ExportWriter::Flush() {
+    if (!failed && used > 0) {
+        failed = !sink(context, buffer.data(), used);
+    }
+    used = 0;
+    return !failed;
+}
+
+bool ExportWriter::IsFailed() const { return failed; }
+
+void ExportWriter::Separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (depth == 0 || format != ExportFormat::Json) {
+        return;
+    }
+    uint64_t bit = uint64_t{1} << ((depth - 1) & 63);
+    if (hasElements & bit) {
+        PutByte(',');
+    }
+    hasElements |= bit;
+}
+
+void ExportWriter::CborHead(uint8_t major, uint64_t value) {
+    // Аргумент в самом байте (< 24) или в 1/2/4/8 следующих, big-endian
+    uint8_t head[9];
+    size_t size;
+    if (value < 24) {
+        head[0] = static_cast<uint8_t>(major << 5 | value);
+        size = 1;
+    } else {
+        size_t bytes = value <= 0xff ? 1 : value <= 0xffff ? 2 : value <= 0xffffffff ? 4 : 8;
+        head[0] = static_cast<uint8_t>(major << 5 | (bytes == 1   ? 24
+                                                      : bytes == 2 ? 25
+                                                      : bytes == 4 ? 26
+                                                                   : 27));
+        for (size_t i = 0; i < bytes; ++i) {
+            head[bytes - i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+        size = bytes + 1;
+    }
+    Put(reinterpret_cast<const char *>(head), size);
+}
+
+void ExportWriter::Open(char bracket, uint8_t cborHead) {
+    Separator();
+    if (format == ExportFormat::Json) {
+        PutByte(static_cast<uint8_t>(bracket));
+    } else {
+        PutByte(cborHead);
+    }
+    ++depth;
+    hasElements &= ~(uint64_t{1} << ((depth - 1) & 63));
+}
+
+void ExportWriter::Close(char bracket) {
+    if (depth > 0) {
+        --depth;
+    }
+    if (format == ExportFormat::Json) {
+        PutByte(static_cast<uint8_t>(bracket));
+        // Документ JSON в выводе командной строки заканчивается строкой
+        if (depth == 0) {
+            PutByte('\n');
+        }
+    } else {
+        PutByte(0xff);
+    }
+}
+
+void ExportWriter::BeginObject() { Open('{', 0xbf); }
+void ExportWriter::EndObject() { Close('}'); }
+void ExportWriter::BeginArray() { Open('[', 0x9f); }
+void ExportWriter::EndArray() { Close(']'); }
+
+void ExportWriter::Key(std::string_view key) {
+    String(key);
+    if (format == ExportFormat::Json) {
+        PutByte(':');
+    }
+    afterKey = true;
+}
+
+void ExportWriter::JsonString(std::string_view value) {
+    static const char hex[] = "0123456789abcdef";
+    PutByte('"');
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        Put(value.data() + start, i - start);
+        start = i + 1;
+        char escape[6] = {'\\', static_cast<char>(c), 0, 0, 0, 0};
+        size_t size = 2;
+        if (c == '\n') {
+            escape[1] = 'n';
+        } else if (c == '\t') {
+            escape[1] = 't';
+        } else if (c < 0x20) {
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = hex[c >> 4];
+            escape[5] = hex[c & 0xf];
+            size = 6;
+        }
+        Put(escape, size);
+    }
+    Put(value.data() + start, value.size() - start);
+    PutByte('"');
+}
+
+void ExportWriter::String(std::string_view value) {
+    Separator();
+    if (format == ExportFormat::Json) {
+        JsonString(value);
+    } else {
+        CborHead(3, value.size());
+        Put(value.data(), value.size());
+    }
+}
+
+void ExportWriter::Uint(uint64_t value) {
+    Separator();
+    if (format == ExportFormat::Json) {
+        char text[24];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        Put(text, static_cast<size_t>(result.ptr - text));
+    } else {
+        CborHead(0, value);
+    }
+}
+
+void ExportWriter::Int(int64_t value) {
+    if (value >= 0) {
+        Uint(static_cast<uint64_t>(value));
+        return;
+    }
+    Separator();
+    if (format == ExportFormat::Json) {
+        char text[24];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        Put(text, static_cast<size_t>(result.ptr - text));
+    } else {
+        // Отрицательное n кодируется как -1 - n
+        CborHead(1, static_cast<uint64_t>(-(value + 1)));
+    }
+}
+
+void ExportWriter::Double(double value) {
+    if (format == ExportFormat::Json) {
+        if (!std::isfinite(value)) {
+            Null();
+            return;
+        }
+        Separator();
+        // to_chars не зависит от локали (Qt ставит ru_RU с запятой)
+        char text[32];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        Put(text, static_cast<size_t>(result.ptr - text));
+        return;
+    }
+    Separator();
+    float narrow = static_cast<float>(value);
+    if (static_cast<double>(narrow) == value || std::isnan(value)) {
+        uint32_t bits;
+        memcpy(&bits, &narrow, sizeof(bits));
+        uint8_t bytes[5] = {0xfa, static_cast<uint8_t>(bits >> 24),
+                            static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 8),
+                            static_cast<uint8_t>(bits)};
+        Put(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint8_t bytes[9] = {0xfb};
+        for (size_t i = 0; i < 8; ++i) {
+            bytes[8 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        Put(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+    }
+}
+
+void ExportWriter::Bool(bool value) {
+    Separator();
+    if (format == ExportFormat::Json) {
+        Put(value ? "true" : "false", value ? 4 : 5);
+    } else {
+        PutByte(value ? 0xf5 : 0xf4);
+    }
+}
+
+void ExportWriter::Null() {
+    Separator();
+    if (format == ExportFormat::Json) {
+        Put("null", 4);
+    } else {
+        PutByte(0xf6);
+    }
+}
+
+bool ExportSnapshot(const PC &pc, ExportWriter &writer) {
+    static LatencyHistogram &exportTime = Diagnostics::GetInstance().GetHistogram("ExportSnapshot");
+    ScopedTimer timer(exportTime);
+
+    writer.BeginObject();
+    Uint(writer, "format_version", 1);
+    Uint(writer, "generation", pc.GetGeneration());
+    Text(writer, "hostname", pc.GetHostname());
+    Uptime uptime = pc.GetUptime();
+    writer.Key("uptime");
+    writer.BeginObject();
+    Uint(writer, "days", static_cast<uint64_t>(uptime.days));
+    Uint(writer, "hours", static_cast<uint64_t>(uptime.hours));
+    Uint(writer, "minutes", static_cast<uint64_t>(uptime.minutes));
+    writer.EndObject();
+    Double(writer, "cpu_use_percent", pc.GetCPUUse());
+    writer.Key("memory");
+    writer.BeginObject();
+    Uint(writer, "total_bytes", pc.GetRAMVolume());
+    Uint(writer, "used_bytes", pc.GetUsedRAMVolume());
+    Uint(writer, "available_bytes", pc.GetAvailableRAMVolume());
+    writer.EndObject();
+
+    writer.Key("cpus");
+    writer.BeginArray();
+    for (const CPU &cpu : pc.GetCPU()) {
+        writer.BeginObject();
+        Text(writer, "name", cpu.GetName());
+        Text(writer, "socket", cpu.GetSocket());
+        Uint(writer, "cores", cpu.GetCores());
+        Uint(writer, "threads", cpu.GetThreads());
+        Uint(writer, "max_speed_mhz", cpu.GetMaxSpeedMHz());
+        Int(writer, "temperature_millicelsius", cpu.GetTemperature());
+        Uint(writer, "power_milliwatts", cpu.GetPowerMilliwatts());
+        Uint(writer, "l1_cache_bytes", cpu.GetL1Cache());
+        Uint(writer, "l2_cache_bytes", cpu.GetL2Cache());
+        Uint(writer, "l3_cache_bytes", cpu.GetL3Cache());
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("caches");
+    writer.BeginArray();
+    for (const CacheLevel &cache : pc.GetCaches()) {
+        writer.BeginObject();
+        Uint(writer, "level", cache.level);
+        Text(writer, "type", GetCacheType(cache.type));
+        Uint(writer, "size_bytes", cache.size);
+        Uint(writer, "line_size", cache.lineSize);
+        Uint(writer, "ways", cache.ways);
+        Uint(writer, "cpus_per_instance", cache.cpusPerInstance);
+        Uint(writer, "instances", cache.instances);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("memory_modules");
+    writer.BeginArray();
+    for (const RAM &module : pc.GetRam()) {
+        writer.BeginObject();
+        Text(writer, "name", module.GetName());
+        Uint(writer, "size_bytes", module.GetSize());
+        Text(writer, "form_factor", module.GetFormFactor());
+        Text(writer, "type", module.GetType());
+        Text(writer, "manufacturer", module.GetManufacturer());
+        Uint(writer, "speed_mts", module.GetSpeed());
+        Text(writer, "channel", module.GetChannel());
+        Uint(writer, "rank", module.GetRank());
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("network_interfaces");
+    writer.BeginArray();
+    for (const NetworkInterface &interface : pc.GetNIs()) {
+        uint8_t flags = interface.GetFlags();
+        writer.BeginObject();
+        Text(writer, "name", interface.GetName());
+        if (flags & NetworkInterface::HasIpv4) {
+            Address(writer, "ipv4", AF_INET, &interface.GetIpv4());
+            Address(writer, "ipv4_netmask", AF_INET, &interface.GetIpv4Netmask());
+        }
+        if (flags & NetworkInterface::HasIpv6) {
+            Address(writer, "ipv6", AF_INET6, &interface.GetIpv6());
+            Address(writer, "ipv6_netmask", AF_INET6, &interface.GetIpv6Netmask());
+        }
+        if (flags & NetworkInterface::HasGateway) {
+            Address(writer, "gateway", AF_INET, &interface.GetGateway());
+        }
+        if (flags & NetworkInterface::HasMac) {
+            const std::array<uint8_t, 6> &mac = interface.GetMac();
+            char text[18];
+            snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1],
+                     mac[2], mac[3], mac[4], mac[5]);
+            Text(writer, "mac", text);
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    const std::pair<const char *, View<InternedString>> lists[] = {
+        {"dns", pc.GetDNS()}, {"gpus", pc.GetGPU()}, {"network_controllers", pc.GetNIControllers()}};
+    for (const auto &list : lists) {
+        writer.Key(list.first);
+        writer.BeginArray();
+        for (InternedString item : list.second) {
+            writer.String(item.View());
+        }
+        writer.EndArray();
+    }
+
+    writer.Key("logical_cpus");
+    writer.BeginArray();
+    for (const LogicalCPU &cpu : pc.GetLogicalCPUs()) {
+        writer.BeginObject();
+        Uint(writer, "id", cpu.id);
+        Index(writer, "package", cpu.package);
+        Index(writer, "die", cpu.die);
+        Index(writer, "node", cpu.node);
+        Index(writer, "core", cpu.core);
+        Index(writer, "llc", cpu.llc);
+        writer.Key("online");
+        writer.Bool(cpu.online);
+        Double(writer, "use_percent", cpu.use);
+        Uint(writer, "frequency_mhz", cpu.frequencyMHz);
+        Uint(writer, "min_frequency_mhz", cpu.minFrequencyMHz);
+        Uint(writer, "max_frequency_mhz", cpu.maxFrequencyMHz);
+        Text(writer, "governor", cpu.governor.View());
+        Int(writer, "temperature_millicelsius", cpu.temperature);
+        Double(writer, "ipc", cpu.ipc);
+        Double(writer, "pmu_running", cpu.pmuRunning);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("power_domains");
+    writer.BeginArray();
+    for (const PowerDomain &domain : pc.GetPowerDomains()) {
+        if (!domain.readable) {
+            continue;
+        }
+        writer.BeginObject();
+        Text(writer, "name", domain.name.View());
+        Text(writer, "kind", GetDomainKind(domain.kind));
+        Index(writer, "package", domain.package);
+        Double(writer, "watts", domain.watts);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("interface_traffic");
+    writer.BeginArray();
+    for (const InterfaceTraffic &traffic : pc.GetInterfaceTraffic()) {
+        writer.BeginObject();
+        Text(writer, "name", traffic.name.View());
+        Uint(writer, "rx_bytes", traffic.rxBytes);
+        Uint(writer, "tx_bytes", traffic.txBytes);
+        Double(writer, "rx_bytes_per_second", traffic.rxRate);
+        Double(writer, "tx_bytes_per_second", traffic.txRate);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // Самодиагностика: во что обходится мониторинг самому хосту
+    Diagnostics &diagnostics = Diagnostics::GetInstance();
+    ProcessUsage usage = diagnostics.GetProcessUsage();
+    writer.Key("diagnostics");
+    writer.BeginObject();
+    Double(writer, "cpu_percent", usage.cpuPercent);
+    Double(writer, "cpu_seconds", usage.cpuSeconds);
+    Uint(writer, "rss_bytes", usage.rssBytes);
+    Uint(writer, "allocations", usage.allocations);
+    Uint(writer, "allocated_bytes", usage.allocatedBytes);
+    Uint(writer, "sampling_allocations", usage.samplingAllocations);
+    writer.Key("timings");
+    writer.BeginArray();
+    diagnostics.ForEachHistogram(
+        [&writer](const std::string &name, const LatencyHistogram &histogram) {
+            writer.BeginObject();
+            Text(writer, "name", name);
+            Uint(writer, "count", histogram.GetCount());
+            Uint(writer, "mean_ns", static_cast<uint64_t>(histogram.GetMean()));
+            Uint(writer, "p50_ns", histogram.GetPercentile(50));
+            Uint(writer, "p99_ns", histogram.GetPercentile(99));
+            Uint(writer, "max_ns", histogram.GetMax());
+            writer.EndObject();
+        });
+    writer.EndArray();
+    writer.EndObject();
+
+    writer.EndObject();
+    return writer.Flush();
+}
+
+bool ExportSnapshot(const PC &pc, ExportFormat format, int fd) {
+    ExportWriter writer(format, &WriteToFd, &fd);
+    return ExportSnapshot(pc, writer);
+}
+} // namespace Devices
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Devices {
+class PC;
+
+enum class ExportFormat { Json, Cbor };
+
+// "json" или "cbor"; false - формат неизвестен, format не меняется.
+bool ParseExportFormat(std::string_view name, ExportFormat &format);
+
+// Потоковый писатель JSON/CBOR (RFC 8949) без аллокаций: дерево не
+// строится, значения кодируются сразу в буфер фиксированного размера,
+// который сливается в sink по заполнении. Контейнеры CBOR - неопределённой
+// длины (0x9f/0xbf ... 0xff), поэтому размер заранее знать не нужно.
+// Ошибка sink запоминается, остальной вывод после неё отбрасывается.
+class ExportWriter {
+public:
+  using Sink = bool (*)(void *context, const char *data, size_t size);
+
+  ExportWriter(ExportFormat format, Sink sink, void *context);
+  ExportWriter(const ExportWriter &) = delete;
+  ExportWriter &operator=(const ExportWriter &) = delete;
+
+  void BeginObject();
+  void EndObject();
+  void BeginArray();
+  void EndArray();
+  // Ключ следующего значения внутри объекта.
+  void Key(std::string_view key);
+
+  void String(std::string_view value);
+  void Uint(uint64_t value);
+  void Int(int64_t value);
+  // NaN и бесконечности в JSON - null; в CBOR значение, точно
+  // представимое float, кодируется 4 байтами.
+  void Double(double value);
+  void Bool(bool value);
+  void Null();
+
+  // Сливает остаток буфера; false - sink отказал.
+  bool Flush();
+  bool IsFailed() const;
+
+private:
+  ExportFormat format;
+  Sink sink;
+  void *context;
+  std::array<char, 16384> buffer;
+  size_t used = 0;
+  uint64_t hasElements = 0; // бит на уровень вложенности (JSON, до 64)
+  uint32_t depth = 0;
+  bool afterKey = false;
+  bool failed = false;
+
+  void Put(const char *data, size_t size);
+  void PutByte(uint8_t byte);
+  // Запятая перед элементом JSON, если он не первый на своём уровне.
+  void Separator();
+  void Open(char bracket, uint8_t cborHead);
+  void Close(char bracket);
+  void CborHead(uint8_t major, uint64_t value);
+  void JsonString(std::string_view value);
+};
+
+// Весь снимок PC: инвентарь, последние замеры, топология, счётчики и
+// самодиагностика. Читает данные так же, как GUI, - вызывать из потока
+// планировщика. Статические данные берутся из памяти, поэтому выгрузка
+// укладывается в доли миллисекунды и не обращается к /proc и /sys.
+bool ExportSnapshot(const PC &pc, ExportWriter &writer);
+// То же в дескриптор (stdout для --once).
+bool ExportSnapshot(const PC &pc, ExportFormat format, int fd);
+} // namespace Devices
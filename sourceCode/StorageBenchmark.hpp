@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Diagnostics.hpp"
+#include "History.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Devices {
+// Счётчики устройства из /proc/diskstats (сектора по 512 байт).
+struct DiskStats {
+  char name[32] = {};
+  uint64_t reads = 0;
+  uint64_t readSectors = 0;
+  uint64_t writes = 0;
+  uint64_t writeSectors = 0;
+  uint64_t inFlight = 0;
+  uint64_t ioTicksMs = 0; // время с хотя бы одним запросом в работе
+};
+
+// Нагрузочный тест накопителя: последовательные или случайные чтение и
+// запись блоками заданного размера с заданной глубиной очереди по файлу
+// или блочному устройству. В каталоге или по несуществующему пути тест
+// создаёт собственный файл и удаляет его; существующий файл только
+// читается. Ввод-вывод прямой (O_DIRECT), если файловая
+// система его поддерживает. Движок - io_uring с зарегистрированными
+// буферами, при его недоступности - нативный AIO ядра, в крайнем случае
+// pread/pwrite с глубиной очереди 1. Системные вызовы io_uring и AIO
+// делаются напрямую, liburing и libaio не нужны.
+class StorageBenchmark {
+public:
+  enum class Pattern { SequentialRead, SequentialWrite, RandomRead, RandomWrite };
+  enum class Engine { Auto, IoUring, Aio, Sync };
+
+  struct Options {
+    std::string path; // каталог, новый файл, существующий файл или устройство
+    Pattern pattern = Pattern::RandomRead;
+    Engine engine = Engine::Auto;
+    uint32_t blockSize = 4096;
+    uint32_t queueDepth = 32;
+    // Размер тестовой области собственного файла (он заполняется до
+    // замера); существующий файл ограничивает её своим размером, у
+    // блочного устройства берётся его размер.
+    uint64_t fileSize = 1ull << 30;
+    uint64_t durationNs = 30ull * 1000000000ull;
+    // Запись на блочное устройство уничтожает данные на нём.
+    bool allowDeviceWrites = false;
+  };
+
+  struct Status {
+    bool running = false;
+    Engine engine = Engine::Auto; // фактически выбранный движок
+    bool registeredBuffers = false;
+    bool direct = false;
+    uint64_t operations = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+    uint64_t elapsedNs = 0;
+    std::string error;
+  };
+
+  static constexpr size_t historyCapacity = 1 << 14;
+
+  StorageBenchmark() = default;
+  ~StorageBenchmark();
+  StorageBenchmark(const StorageBenchmark &) = delete;
+  StorageBenchmark &operator=(const StorageBenchmark &) = delete;
+
+  static const char *GetPatternName(Pattern pattern);
+  static const char *GetEngineName(Engine engine);
+
+  // Проверяет параметры и открывает цель синхронно, сам замер - в
+  // фоновом потоке.
+  bool Start(const Options &options, std::string &error);
+  void Stop();
+  bool IsRunning() const;
+  void GetStatus(Status &out) const;
+  // Задержка от отправки запроса до его завершения.
+  const LatencyHistogram &GetHistogram() const;
+
+  // Вызывается владельцем на каждом замере: IOPS и МБ/с с прошлого
+  // вызова в кривые.
+  void Sample(uint64_t nowNs);
+  const History &GetIopsHistory() const;
+  const History &GetBandwidthHistory() const; // байт/с
+
+  // Счётчики устройства, на котором лежит цель последнего запуска.
+  // false, если устройство не найдено (tmpfs, overlay).
+  bool GetDiskStats(DiskStats &out);
+
+private:
+  std::thread thread;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> running{false};
+  std::atomic<uint64_t> operations{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> errors{0};
+  std::atomic<uint64_t> elapsedNs{0};
+  mutable std::mutex mutex; // status.error и выбранный движок
+  Status status;
+  LatencyHistogram histogram;
+
+  int fd = -1;
+  uint32_t deviceMajor = 0;
+  uint32_t deviceMinor = 0;
+  int diskStatsFd = -1;
+  std::vector<char> diskStatsBuffer;
+
+  uint64_t lastSampleNs = 0;
+  uint64_t lastOperations = 0;
+  uint64_t lastBytes = 0;
+  History iops{historyCapacity};
+  History bandwidth{historyCapacity};
+
+  void Run(Options options, uint64_t span, bool prefill);
+  void Fail(const std::string &error);
+  void CloseTarget();
+};
+} // namespace Devices
@@ -0,0 +1,426 @@
+#include "StressTest.hpp"
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ULSM_X86 1
+#endif
+
+// Скалярное ядро не должно превращаться в SSE автовекторизатором,
+// иначе сравнение ядер теряет смысл.
+#if defined(__GNUC__) && !defined(__clang__)
+#define ULSM_NO_VECTORIZE __attribute__((optimize("no-tree-vectorize")))
+#else
+#define ULSM_NO_VECTORIZE
+#endif
+
+namespace {
+const uint64_t periodNs = 100000000ull;
+const uint64_t chunkIterations = 4096;
+
+// Результат вычислений уходит сюда, чтобы компилятор их не выбросил.
+volatile double floatSink;
+volatile uint64_t integerSink;
+
+// Восемь независимых цепочек a = a * m + c на ядро: латентность FMA
+// перекрывается, упор в пропускную способность исполнительных блоков.
+// Значения сходятся к c / (1 - m) и не уходят в денормали.
+ULSM_NO_VECTORIZE uint64_t FloatScalar(uint64_t iterations) {
+    double a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    const double m = 0.999999;
+    const double c = 1e-6;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (double &value : a) {
+            value = value * m + c;
+        }
+    }
+    floatSink = a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7];
+    return iterations * 8 * 2;
+}
+
+ULSM_NO_VECTORIZE uint64_t IntegerScalar(uint64_t iterations) {
+    uint64_t a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (uint64_t &value : a) {
+            value = (value + 0x9e3779b9u) ^ (value >> 3);
+        }
+    }
+    integerSink = a[0] ^ a[1] ^ a[2] ^ a[3] ^ a[4] ^ a[5] ^ a[6] ^ a[7];
+    return iterations * 8 * 3;
+}
+
+#ifdef ULSM_X86
+__attribute__((target("sse2"))) uint64_t FloatSSE(uint64_t iterations) {
+    __m128d a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm_set1_pd(k + 1);
+    }
+    const __m128d m = _mm_set1_pd(0.999999);
+    const __m128d c = _mm_set1_pd(1e-6);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m128d &value : a) {
+            value = _mm_add_pd(_mm_mul_pd(value, m), c);
+        }
+    }
+    __m128d sum = _mm_setzero_pd();
+    for (const __m128d &value : a) {
+        sum = _mm_add_pd(sum, value);
+    }
+    floatSink = _mm_cvtsd_f64(sum);
+    return iterations * 8 * 2 * 2;
+}
+
+__attribute__((target("sse2"))) uint64_t IntegerSSE(uint64_t iterations) {
+    __m128i a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm_set1_epi32(k + 1);
+    }
+    const __m128i c = _mm_set1_epi32(0x9e3779b9);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m128i &value : a) {
+            value = _mm_xor_si128(_mm_add_epi32(value, c), _mm_srli_epi32(value, 3));
+        }
+    }
+    __m128i sum = _mm_setzero_si128();
+    for (const __m128i &value : a) {
+        sum = _mm_xor_si128(sum, value);
+    }
+    integerSink = static_cast<uint64_t>(_mm_cvtsi128_si32(sum));
+    return iterations * 8 * 4 * 3;
+}
+
+__attribute__((target("avx2,fma"))) uint64_t FloatAVX2(uint64_t iterations) {
+    __m256d a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm256_set1_pd(k + 1);
+    }
+    const __m256d m = _mm256_set1_pd(0.999999);
+    const __m256d c = _mm256_set1_pd(1e-6);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m256d &value : a) {
+            value = _mm256_fmadd_pd(value, m, c);
+        }
+    }
+    __m256d sum = _mm256_setzero_pd();
+    for (const __m256d &value : a) {
+        sum = _mm256_add_pd(sum, value);
+    }
+    floatSink = _mm256_cvtsd_f64(sum);
+    return iterations * 8 * 4 * 2;
+}
+
+__attribute__((target("avx2"))) uint64_t IntegerAVX2(uint64_t iterations) {
+    __m256i a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm256_set1_epi32(k + 1);
+    }
+    const __m256i c = _mm256_set1_epi32(0x9e3779b9);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m256i &value : a) {
+            value = _mm256_xor_si256(_mm256_add_epi32(value, c),
+                                     _mm256_srli_epi32(value, 3));
+        }
+    }
+    __m256i sum = _mm256_setzero_si256();
+    for (const __m256i &value : a) {
+        sum = _mm256_xor_si256(sum, value);
+    }
+    integerSink = static_cast<uint64_t>(_mm256_extract_epi32(sum, 0));
+    return iterations * 8 * 8 * 3;
+}
+
+__attribute__((target("avx512f"))) uint64_t FloatAVX512(uint64_t iterations) {
+    __m512d a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm512_set1_pd(k + 1);
+    }
+    const __m512d m = _mm512_set1_pd(0.999999);
+    const __m512d c = _mm512_set1_pd(1e-6);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m512d &value : a) {
+            value = _mm512_fmadd_pd(value, m, c);
+        }
+    }
+    __m512d sum = _mm512_setzero_pd();
+    for (const __m512d &value : a) {
+        sum = _mm512_add_pd(sum, value);
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, sum);
+    floatSink = lanes[0];
+    return iterations * 8 * 8 * 2;
+}
+
+__attribute__((target("avx512f"))) uint64_t IntegerAVX512(uint64_t iterations) {
+    __m512i a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm512_set1_epi32(k + 1);
+    }
+    const __m512i c = _mm512_set1_epi32(0x9e3779b9);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (__m512i &value : a) {
+            value = _mm512_xor_si512(_mm512_add_epi32(value, c),
+                                     _mm512_maskz_srli_epi32(0xffff, value, 3));
+        }
+    }
+    __m512i sum = _mm512_setzero_si512();
+    for (const __m512i &value : a) {
+        sum = _mm512_xor_si512(sum, value);
+    }
+    alignas(64) uint32_t lanes[16];
+    _mm512_store_si512(lanes, sum);
+    integerSink = lanes[0];
+    return iterations * 8 * 16 * 3;
+}
+#endif
+
+using KernelFunction = uint64_t (*)(uint64_t);
+
+KernelFunction Select(Devices::StressTest::Kernel kernel,
+                      Devices::StressTest::Workload workload) {
+    using Kernel = Devices::StressTest::Kernel;
+    bool integer = workload == Devices::StressTest::Workload::Integer;
+    switch (kernel) {
+#ifdef ULSM_X86
+    case Kernel::SSE:
+        return integer ? IntegerSSE : FloatSSE;
+    case Kernel::AVX2:
+        return integer ? IntegerAVX2 : FloatAVX2;
+    case Kernel::AVX512:
+        return integer ? IntegerAVX512 : FloatAVX512;
+#endif
+    default:
+        return integer ? IntegerScalar : FloatScalar;
+    }
+}
+
+void SleepUntil(uint64_t deadlineNs) {
+    timespec deadline{};
+    deadline.tv_sec = static_cast<time_t>(deadlineNs / 1000000000ull);
+    deadline.tv_nsec = static_cast<long>(deadlineNs % 1000000000ull);
+    // Повтор только после сигнала; при любой другой ошибке пауза
+    // пропускается, а не крутится вечно
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+}
+} // namespace
+
+namespace Devices {
+double StressTest::WorkerResult::GetGigaOpsPerSecond() const {
+    return busyNs == 0 ? 0 : static_cast<double>(operations) / busyNs;
+}
+
+StressTest::StressTest()
+    : stopRequested(false), activeWorkers(0), kernel(Kernel::Scalar),
+      workload(Workload::Float), lastSampleNs(0), lastOperations(0),
+      throughput(historyCapacity), frequency(historyCapacity),
+      temperature(historyCapacity), power(historyCapacity), energyJoules(0),
+      measuredOperations(0) {}
+
+StressTest::~StressTest() { Stop(); }
+
+bool StressTest::IsSupported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Auto:
+    case Kernel::Scalar:
+        return true;
+#ifdef ULSM_X86
+    case Kernel::SSE:
+        return __builtin_cpu_supports("sse2");
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Kernel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+StressTest::Kernel StressTest::GetBestKernel() {
+    for (Kernel kernel : {Kernel::AVX512, Kernel::AVX2, Kernel::SSE}) {
+        if (IsSupported(kernel)) {
+            return kernel;
+        }
+    }
+    return Kernel::Scalar;
+}
+
+const char *StressTest::GetKernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Auto:
+        return "Auto";
+    case Kernel::Scalar:
+        return "Scalar";
+    case Kernel::SSE:
+        return "SSE2";
+    case Kernel::AVX2:
+        return "AVX2+FMA";
+    case Kernel::AVX512:
+        return "AVX-512";
+    }
+    return "Unknown";
+}
+
+bool StressTest::Start(const Options &options, std::string &error) {
+    if (IsRunning()) {
+        error = "stress test is already running";
+        return false;
+    }
+    Join();
+    workers.clear();
+
+    Kernel selected = options.kernel == Kernel::Auto ? GetBestKernel() : options.kernel;
+    if (!IsSupported(selected)) {
+        error = std::string(GetKernelName(selected)) + " is not supported by this CPU";
+        return false;
+    }
+    unsigned load = options.loadPercent;
+    if (load == 0 || load > 100) {
+        error = "load level must be 1..100%";
+        return false;
+    }
+
+    std::vector<unsigned> cpus = options.cpus;
+    if (cpus.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    }
+    if (cpus.empty()) {
+        error = "no CPUs available";
+        return false;
+    }
+
+    kernel = selected;
+    workload = options.workload;
+    throughput.Clear();
+    frequency.Clear();
+    temperature.Clear();
+    power.Clear();
+    energyJoules = 0;
+    measuredOperations = 0;
+    lastSampleNs = Diagnostics::MonotonicNs();
+    lastOperations = 0;
+    stopRequested = false;
+    activeWorkers = static_cast<unsigned>(cpus.size());
+
+    uint64_t endNs = lastSampleNs + options.durationNs;
+    for (unsigned cpu : cpus) {
+        workers.push_back(std::make_unique<Worker>());
+        Worker &worker = *workers.back();
+        worker.cpu = cpu;
+        worker.thread = std::thread(Run, std::ref(worker), selected, workload, load,
+                                    endNs, std::cref(stopRequested),
+                                    std::ref(activeWorkers));
+    }
+    return true;
+}
+
+void StressTest::Run(Worker &worker, Kernel kernel, Workload workload,
+                     unsigned loadPercent, uint64_t endNs,
+                     const std::atomic<bool> &stop, std::atomic<unsigned> &active) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker.cpu, &set);
+    worker.affinityError.store(pthread_setaffinity_np(pthread_self(), sizeof(set), &set),
+                               std::memory_order_relaxed);
+
+    KernelFunction compute = Select(kernel, workload);
+    const uint64_t busyPerPeriod = periodNs * loadPercent / 100;
+    uint64_t now = Diagnostics::MonotonicNs();
+    while (!stop.load(std::memory_order_relaxed) && now < endNs) {
+        uint64_t periodStart = now;
+        uint64_t busyUntil = std::min(periodStart + busyPerPeriod, endNs);
+        uint64_t operations = 0;
+        do {
+            operations += compute(chunkIterations);
+            now = Diagnostics::MonotonicNs();
+        } while (now < busyUntil && !stop.load(std::memory_order_relaxed));
+        worker.operations.fetch_add(operations, std::memory_order_relaxed);
+        worker.busyNs.fetch_add(now - periodStart, std::memory_order_relaxed);
+
+        if (loadPercent < 100 && !stop.load(std::memory_order_relaxed)) {
+            SleepUntil(std::min(periodStart + periodNs, endNs));
+            now = Diagnostics::MonotonicNs();
+        }
+    }
+    // Завершение последнего потока владелец видит через IsRunning
+    active.fetch_sub(1);
+}
+
+void StressTest::Stop() {
+    stopRequested = true;
+    Join();
+}
+
+void StressTest::Join() {
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    activeWorkers = 0;
+}
+
+bool StressTest::IsRunning() const { return activeWorkers.load() != 0; }
+StressTest::Kernel StressTest::GetKernel() const { return kernel; }
+StressTest::Workload StressTest::GetWorkload() const { return workload; }
+
+void StressTest::Sample(uint64_t nowNs, double frequencyMHz, double temperatureC, double watts) {
+    uint64_t operations = 0;
+    for (const auto &worker : workers) {
+        operations += worker->operations.load(std::memory_order_relaxed);
+    }
+    if (nowNs > lastSampleNs) {
+        throughput.Push(nowNs, static_cast<float>(
+                                   static_cast<double>(operations - lastOperations) /
+                                   (nowNs - lastSampleNs)));
+        // Мощность - средняя за тот же интервал, энергия копится только
+        // там, где она известна
+        if (watts > 0) {
+            energyJoules += watts * (nowNs - lastSampleNs) / 1e9;
+            measuredOperations += operations - lastOperations;
+        }
+    }
+    lastSampleNs = nowNs;
+    lastOperations = operations;
+    if (frequencyMHz > 0) {
+        frequency.Push(nowNs, static_cast<float>(frequencyMHz));
+    }
+    if (temperatureC > 0) {
+        temperature.Push(nowNs, static_cast<float>(temperatureC));
+    }
+    if (watts > 0) {
+        power.Push(nowNs, static_cast<float>(watts));
+    }
+}
+
+void StressTest::GetResults(std::vector<WorkerResult> &out) const {
+    out.clear();
+    for (const auto &worker : workers) {
+        out.push_back({worker->cpu, worker->operations.load(std::memory_order_relaxed),
+                       worker->busyNs.load(std::memory_order_relaxed),
+                       worker->affinityError.load(std::memory_order_relaxed)});
+    }
+}
+
+const History &StressTest::GetThroughputHistory() const { return throughput; }
+const History &StressTest::GetFrequencyHistory() const { return frequency; }
+const History &StressTest::GetTemperatureHistory() const { return temperature; }
+const History &StressTest::GetPowerHistory() const { return power; }
+double StressTest::GetOpsPerJoule() const {
+    return energyJoules > 0 ? measuredOperations / energyJoules : 0;
+}
+} // namespace Devices
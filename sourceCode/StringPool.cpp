@@ -0,0 +1,48 @@
+#include "StringPool.hpp"
+
+namespace Devices {
+InternedString::InternedString(std::string_view text)
+    : id(StringPool::GetInstance().Intern(text)) {}
+
+std::string_view InternedString::View() const {
+    return StringPool::GetInstance().Lookup(id);
+}
+
+std::string InternedString::String() const { return std::string(View()); }
+
+StringPool::StringPool() {
+    strings.emplace_back("-");
+    index.emplace(strings.back(), 0);
+}
+
+uint32_t StringPool::Intern(std::string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ' ||
+                             text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    if (text.empty()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(text);
+    if (found != index.end()) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.emplace_back(text);
+    index.emplace(strings.back(), id);
+    return id;
+}
+
+std::string_view StringPool::Lookup(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return id < strings.size() ? std::string_view(strings[id])
+                               : std::string_view(strings.front());
+}
+
+size_t StringPool::GetSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strings.size();
+}
+} // namespace Devices
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Devices {
+// Интернированная строка: 4-байтовый индекс в общем пуле процесса.
+// Записи устройств хранят только индексы и остаются тривиально
+// копируемыми; одинаковые имена (производитель, тип памяти) хранятся один раз.
+class InternedString {
+private:
+  uint32_t id = 0;
+
+public:
+  InternedString() = default;
+  explicit InternedString(std::string_view text);
+
+  // Идентификатор 0 зарезервирован под "-" (значение неизвестно).
+  bool IsEmpty() const { return id == 0; }
+  uint32_t GetId() const { return id; }
+  std::string_view View() const;
+  std::string String() const;
+
+  bool operator==(InternedString other) const { return id == other.id; }
+  bool operator!=(InternedString other) const { return id != other.id; }
+};
+
+class StringPool {
+private:
+  StringPool();
+
+  mutable std::mutex mutex;
+  std::deque<std::string> strings;
+  std::unordered_map<std::string_view, uint32_t> index;
+
+public:
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+  static StringPool &GetInstance() {
+    static StringPool pool;
+    return pool;
+  }
+
+  uint32_t Intern(std::string_view text);
+  // Ссылка на строку действительна до конца работы процесса.
+  std::string_view Lookup(uint32_t id) const;
+  size_t GetSize() const;
+};
+} // namespace Devices
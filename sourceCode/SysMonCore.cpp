@@ -1,45 +1,61 @@
 #include "SysMonCore.hpp"
+#include "Diagnostics.hpp"
+#include "Dmi.hpp"
+#include "InputTrace.hpp"
+#include "SysfsUtil.hpp"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
+#include <fcntl.h>
 #include <ifaddrs.h>
 #include <iostream>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
-#include <sensors/sensors.h>
-#include <sstream>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/sysinfo.h>
 #include <sys/types.h>
-#include <thread>
+#include <type_traits>
+#include <unistd.h>
 
 namespace {
-std::string lsCache(std::string cacheID) {
-    FILE *pipe = popen("sudo dmidecode -t cache", "r");
-    if (!pipe) {
-        std::cout << "Failed to run dmidecode" << std::endl;
-        return "";
+// Файл целиком в буфер вызывающего (ReadSmallFile); внутри замера
+// содержимое проходит через трассу входов (InputTrace).
+ssize_t ReadFile(const char *path, char *buffer, size_t size) {
+    ssize_t length = Devices::TracedRead(path, buffer, size - 1, [path, buffer, size]() {
+        return Devices::ReadSmallFile(path, buffer, size);
+    });
+    if (length >= 0) {
+        buffer[length] = '\0';
     }
-    std::string currentCache;
-    char buffer[256];
-    bool find = false;
-
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        std::string line(buffer);
-        if (line.find(cacheID.substr(0, cacheID.size() - 1)) != std::string::npos) {
-            find = true;
-        } else if (line.find("Installed Size:") != std::string::npos && find) {
-            currentCache = line.substr(line.find(":") + 2);
-            break;
-        }
+    return length;
+}
+
+// Значение после "Ключ: " в строке вывода lspci или /proc/cpuinfo.
+std::string_view FieldValue(std::string_view line) {
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+        return {};
     }
+    line.remove_prefix(std::min(line.size(), colon + 2));
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+        line.remove_suffix(1);
+    }
+    return line;
+}
 
-    pclose(pipe);
-    currentCache.pop_back();
-    return currentCache;
+// Корень sysfs; ULSM_SYSFS_ROOT подменяет его снимком дерева для
+// отладки и проверки на чужих конфигурациях.
+const char *SysfsRoot() {
+    static const char *root = [] {
+        const char *override = getenv("ULSM_SYSFS_ROOT");
+        return override && *override ? override : "/sys";
+    }();
+    return root;
 }
 } // namespace
 
@@ -47,473 +63,1253 @@ namespace Devices {
 long long PC::currentCPUUseIdle = 0;
 long long PC::currentCPUUseTotal = 0;
 
-Device::Device() : name("-") {}
-Device::Device(std::string name) : name(name) {}
-Device::Device(const Device &other) : name(other.name) {}
-Device &Device::operator=(const Device &other) {
-    this->name = other.name;
-    return *this;
-}
-std::string Device::GetName() const { return this->name; }
-
-CPU::CPU()
-    : Device("-"), cores(0), threats(0), maxSpeed("-"), socket("-"),
-    l1Cache("-"), l2Cache("-"), l3Cache("-"), temperature(0) {}
-CPU::CPU(const CPU &other)
-    : Device(other.name), cores(other.cores), threats(other.threats),
-    maxSpeed(other.maxSpeed), socket(other.socket), l1Cache(other.l1Cache),
-    l2Cache(other.l2Cache), l3Cache(other.l3Cache),
-    temperature(other.temperature) {}
-
-size_t CPU::GetCores() const { return this->cores; }
-size_t CPU::GetThreats() const { return this->threats; }
-std::string CPU::GetMaxSpeed() const { return this->maxSpeed; }
-std::string CPU::GetSocket() const { return this->socket; }
-std::string CPU::GetL1Cache() const { return this->l1Cache; }
-std::string CPU::GetL2Cache() const { return this->l2Cache; }
-std::string CPU::GetL3Cache() const { return this->l3Cache; }
-int CPU::GetTemperature() const { return this->temperature; }
-
-RAM::RAM()
-    : Device("-"), size("-"), formFactor("-"), type("-"), manufacturer("-"),
-    speed("-"), channel("-"), rank(0) {}
-RAM::RAM(const RAM &other)
-    : Device(other.name), size(other.size), formFactor(other.formFactor),
-    type(other.type), manufacturer(other.manufacturer), speed(other.speed),
-    channel(other.channel), rank(other.rank) {}
-
-std::string RAM::GetSize() const { return this->size; }
-std::string RAM::GetFormFactor() const { return this->formFactor; }
-std::string RAM::GetType() const {
-    return this->type;
-    ;
-}
-std::string RAM::GetManufacturer() const { return this->manufacturer; }
-std::string RAM::GetSpeed() const { return this->speed; }
-std::string RAM::GetChannel() const { return this->channel; }
-int RAM::GetRank() const {
-    return this->rank;
-    ;
+static_assert(std::is_trivially_copyable<CPU>::value,
+              "CPU records must stay trivially copyable");
+static_assert(std::is_trivially_copyable<RAM>::value,
+              "RAM records must stay trivially copyable");
+static_assert(std::is_trivially_copyable<NetworkInterface>::value,
+              "NetworkInterface records must stay trivially copyable");
+static_assert(std::is_trivially_copyable<LogicalCPU>::value,
+              "LogicalCPU records must stay trivially copyable");
+
+std::string_view Device::GetName() const { return this->name.View(); }
+uint32_t Device::GetDirty() const { return this->dirty; }
+
+uint32_t CPU::Compare(const CPU &other) const {
+    uint32_t mask = 0;
+    if (name != other.name) {
+        mask |= Name;
+    }
+    if (socket != other.socket) {
+        mask |= Socket;
+    }
+    if (cores != other.cores) {
+        mask |= Cores;
+    }
+    if (threads != other.threads) {
+        mask |= Threads;
+    }
+    if (maxSpeedMHz != other.maxSpeedMHz) {
+        mask |= MaxSpeed;
+    }
+    if (temperature != other.temperature) {
+        mask |= Temperature;
+    }
+    if (powerMilliwatts != other.powerMilliwatts) {
+        mask |= Power;
+    }
+    if (l1Cache != other.l1Cache || l2Cache != other.l2Cache ||
+        l3Cache != other.l3Cache) {
+        mask |= Caches;
+    }
+    return mask;
 }
 
-void PC::CollectHostname() {
-    std::ifstream hostnameFile("/proc/sys/kernel/hostname");
-    if (hostnameFile.is_open()) {
-        getline(hostnameFile, hostname);
-    } else {
-        hostname = "-";
+uint32_t RAM::Compare(const RAM &other) const {
+    uint32_t mask = 0;
+    if (name != other.name) {
+        mask |= Name;
     }
+    if (size != other.size) {
+        mask |= Size;
+    }
+    if (formFactor != other.formFactor) {
+        mask |= FormFactor;
+    }
+    if (type != other.type) {
+        mask |= Type;
+    }
+    if (manufacturer != other.manufacturer) {
+        mask |= Manufacturer;
+    }
+    if (speed != other.speed) {
+        mask |= Speed;
+    }
+    if (channel != other.channel) {
+        mask |= Channel;
+    }
+    if (rank != other.rank) {
+        mask |= Rank;
+    }
+    return mask;
 }
 
-void PC::CollectStaticCPUData() {
-    FILE *pipe = popen("sudo dmidecode -t processor", "r");
-    if (pipe) {
-        CPU current_proc;
-        char buffer[256];
+uint32_t NetworkInterface::Compare(const NetworkInterface &other) const {
+    uint8_t changedFlags = flags ^ other.flags;
+    uint32_t mask = 0;
+    if (name != other.name) {
+        mask |= Name;
+    }
+    if ((changedFlags & HasIpv4) || memcmp(&ipv4, &other.ipv4, sizeof(ipv4)) != 0) {
+        mask |= Ipv4;
+    }
+    if ((changedFlags & HasIpv6) || memcmp(&ipv6, &other.ipv6, sizeof(ipv6)) != 0) {
+        mask |= Ipv6;
+    }
+    if (memcmp(&ipv4Netmask, &other.ipv4Netmask, sizeof(ipv4Netmask)) != 0) {
+        mask |= Ipv4Netmask;
+    }
+    if (memcmp(&ipv6Netmask, &other.ipv6Netmask, sizeof(ipv6Netmask)) != 0) {
+        mask |= Ipv6Netmask;
+    }
+    if ((changedFlags & HasMac) || mac != other.mac) {
+        mask |= Mac;
+    }
+    if ((changedFlags & HasGateway) ||
+        memcmp(&gateway, &other.gateway, sizeof(gateway)) != 0) {
+        mask |= Gateway;
+    }
+    return mask;
+}
 
-        while (fgets(buffer, sizeof(buffer), pipe)) {
-            std::string line(buffer);
-
-            if (line.find("Socket Designation:") != std::string::npos) {
-                current_proc.socket = line.substr(line.find(":") + 2);
-                current_proc.socket.pop_back();
-            } else if (line.find("Max Speed:") != std::string::npos) {
-                current_proc.maxSpeed = line.substr(line.find(":") + 2);
-                current_proc.maxSpeed.pop_back();
-            } else if (line.find("Version:") != std::string::npos) {
-                current_proc.name = line.substr(line.find(":") + 2);
-                current_proc.name.pop_back();
-            } else if (line.find("Core Count:") != std::string::npos) {
-                std::stringstream ss(line.substr(line.find(":") + 2));
-                ss >> current_proc.cores;
-            } else if (line.find("Thread Count:") != std::string::npos) {
-                std::stringstream ss(line.substr(line.find(":") + 2));
-                ss >> current_proc.threats;
-            } else if (line.find("L1 Cache Handle:") != std::string::npos) {
-                current_proc.l1Cache = lsCache(line.substr(line.find(":") + 2));
-            } else if (line.find("L2 Cache Handle:") != std::string::npos) {
-                current_proc.l2Cache = lsCache(line.substr(line.find(":") + 2));
-            } else if (line.find("L3 Cache Handle:") != std::string::npos) {
-                current_proc.l3Cache = lsCache(line.substr(line.find(":") + 2));
-            } else if (line.find("Processor Information") != std::string::npos &&
-                       current_proc.cores != 0) {
-                mainProcessors.push_back(current_proc);
-                current_proc.cores = 0;
-            }
+bool ChangeSet::Has(Snapshot::Section section) const {
+    if (full) {
+        return true;
+    }
+    for (const Change &change : changes) {
+        if (change.section == section) {
+            return true;
         }
-        mainProcessors.push_back(current_proc);
-        pclose(pipe);
     }
+    return false;
 }
 
-void PC::CollectStaticRAMData() {
-    FILE *pipe = popen("sudo dmidecode -t memory", "r");
-    if (pipe) {
-        RAM currentRAM;
-        char buffer[256];
-
-        while (fgets(buffer, sizeof(buffer), pipe)) {
-            std::string line(buffer);
-
-            if (line.find("\tSize:") != std::string::npos) {
-                currentRAM.size = line.substr(line.find(":") + 2);
-                currentRAM.size.pop_back();
-            } else if (line.find("Form Factor:") != std::string::npos) {
-                currentRAM.formFactor = line.substr(line.find(":") + 2);
-                currentRAM.formFactor.pop_back();
-            } else if (line.find("Bank Locator:") != std::string::npos) {
-                currentRAM.channel = line.substr(line.find(":") + 2);
-                currentRAM.channel.pop_back();
-            } else if (line.find("Type:") != std::string::npos) {
-                currentRAM.type = line.substr(line.find(":") + 2);
-                currentRAM.type.pop_back();
-            } else if (line.find("Manufacturer:") != std::string::npos) {
-                currentRAM.manufacturer = line.substr(line.find(":") + 2);
-                currentRAM.manufacturer.pop_back();
-            } else if (line.find("Part Number:") != std::string::npos) {
-                currentRAM.name = line.substr(line.find(":") + 2);
-                currentRAM.name.pop_back();
-            } else if (line.find("Configured Memory Speed:") != std::string::npos) {
-                currentRAM.speed = line.substr(line.find(":") + 2);
-                currentRAM.speed.pop_back();
-            } else if (line.find("Rank:") != std::string::npos) {
-                std::stringstream temp(line.substr(line.find(":") + 2));
-                temp >> currentRAM.rank;
-            } else if (line.find("Memory Device") != std::string::npos &&
-                       currentRAM.rank != 0) {
-                if (currentRAM.channel.empty()) {
-                    currentRAM.channel = "Single";
-                }
-                RAMDevices.push_back(currentRAM);
-                currentRAM.rank = 0;
-            }
-        }
-        if (currentRAM.channel.empty()) {
-            currentRAM.channel = "Single";
+uint32_t ChangeSet::GetMask(Snapshot::Section section, uint32_t index) const {
+    if (full) {
+        return ~0u;
+    }
+    uint32_t mask = 0;
+    for (const Change &change : changes) {
+        if (change.section == section &&
+            (change.index == index || change.index == UINT32_MAX)) {
+            mask |= change.mask;
         }
-        RAMDevices.push_back(currentRAM);
-        pclose(pipe);
     }
+    return mask;
 }
 
-NetworkInterface::NetworkInterface()
-    : Device("-"), ipv4("-"), ipv6("-"), ipv4Netmask("-"), ipv6Netmask("-"),
-    mac("-"), gateway("-") {};
-NetworkInterface::NetworkInterface(const NetworkInterface &other)
-    : Device(other.name), ipv4(other.ipv4), ipv6(other.ipv6),
-    ipv4Netmask(other.ipv4Netmask), ipv6Netmask(other.ipv4Netmask),
-    mac(other.mac), gateway(other.gateway) {}
+bool ChangeSet::IsStructureChanged(Snapshot::Section section) const {
+    return GetMask(section, UINT32_MAX) & structureChanged;
+}
 
-std::string NetworkInterface::GetIpv4() const { return this->ipv4; }
-std::string NetworkInterface::GetIpv6() const { return this->ipv6; }
-std::string NetworkInterface::GetIpv4Netmask() const {
+uint32_t CPU::GetCores() const { return this->cores; }
+uint32_t CPU::GetThreads() const { return this->threads; }
+uint32_t CPU::GetMaxSpeedMHz() const { return this->maxSpeedMHz; }
+std::string_view CPU::GetSocket() const { return this->socket.View(); }
+uint64_t CPU::GetL1Cache() const { return this->l1Cache; }
+uint64_t CPU::GetL2Cache() const { return this->l2Cache; }
+uint64_t CPU::GetL3Cache() const { return this->l3Cache; }
+int32_t CPU::GetTemperature() const { return this->temperature; }
+uint32_t CPU::GetPowerMilliwatts() const { return this->powerMilliwatts; }
+
+uint64_t RAM::GetSize() const { return this->size; }
+std::string_view RAM::GetFormFactor() const { return this->formFactor.View(); }
+std::string_view RAM::GetType() const { return this->type.View(); }
+std::string_view RAM::GetManufacturer() const {
+    return this->manufacturer.View();
+}
+uint32_t RAM::GetSpeed() const { return this->speed; }
+std::string_view RAM::GetChannel() const { return this->channel.View(); }
+uint32_t RAM::GetRank() const { return this->rank; }
+
+uint8_t NetworkInterface::GetFlags() const { return this->flags; }
+const in_addr &NetworkInterface::GetIpv4() const { return this->ipv4; }
+const in6_addr &NetworkInterface::GetIpv6() const { return this->ipv6; }
+const in_addr &NetworkInterface::GetIpv4Netmask() const {
     return this->ipv4Netmask;
 }
-std::string NetworkInterface::GetIpv6Netmask() const {
+const in6_addr &NetworkInterface::GetIpv6Netmask() const {
     return this->ipv6Netmask;
 }
+const std::array<uint8_t, 6> &NetworkInterface::GetMac() const {
+    return this->mac;
+}
+const in_addr &NetworkInterface::GetGateway() const { return this->gateway; }
+
+std::string FormatBytes(uint64_t bytes) {
+    static const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    size_t unit = 0;
+    double value = static_cast<double>(bytes);
+    while (value >= 1024.0 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+        value /= 1024.0;
+        ++unit;
+    }
+    char buffer[32];
+    if (value == static_cast<double>(static_cast<uint64_t>(value))) {
+        snprintf(buffer, sizeof(buffer), "%llu %s",
+                 static_cast<unsigned long long>(value), units[unit]);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.1f %s", value, units[unit]);
+    }
+    return buffer;
+}
+
+std::string FormatIpv4(const in_addr &address) {
+    char buffer[INET_ADDRSTRLEN]{};
+    inet_ntop(AF_INET, &address, buffer, sizeof(buffer));
+    return buffer;
+}
+
+std::string FormatIpv6(const in6_addr &address) {
+    char buffer[INET6_ADDRSTRLEN]{};
+    inet_ntop(AF_INET6, &address, buffer, sizeof(buffer));
+    return buffer;
+}
+
+std::string FormatMac(const std::array<uint8_t, 6> &mac) {
+    char buffer[18];
+    snprintf(buffer, sizeof(buffer), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0],
+             mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buffer;
+}
+
+void PC::CollectHostname() {
+    char buffer[256];
+    if (ReadFile("/proc/sys/kernel/hostname", buffer, sizeof(buffer)) > 0) {
+        snapshot.hostname = InternedString(buffer);
+    } else {
+        snapshot.hostname = InternedString();
+    }
+}
 
-std::string NetworkInterface::GetMac() const { return this->mac; }
+void PC::CollectStaticCPUData() {
+    // Ядра, потоки, частота и кэши - из sysfs; SMBIOS даёт только
+    // сокет и паспортные значения, и без помощника с правами root его
+    // нет вовсе.
+    std::vector<PackageSummary> packages;
+    CpuTopology::ReadPackages(SysfsRoot(), packages);
+
+    // Процессоры - структуры SMBIOS типа 4 (DSP0134, 7.5); пустые
+    // сокеты пропускаются
+    ForEachDmiStructure(GetDmiTable(SysfsRoot()), 4, [this](const DmiStructure &entry) {
+        if ((entry.GetByte(0x18) & 0x40) == 0) {
+            return;
+        }
+        CPU processor;
+        processor.socket = InternedString(entry.GetString(0x04));
+        processor.name = InternedString(entry.GetString(0x10));
+        processor.maxSpeedMHz = entry.GetWord(0x14);
+        // 0xff - значение в 16-битном поле Core Count 2 / Thread Count 2
+        processor.cores = entry.GetByte(0x23) == 0xff ? entry.GetWord(0x2a) : entry.GetByte(0x23);
+        processor.threads =
+            entry.GetByte(0x25) == 0xff ? entry.GetWord(0x2e) : entry.GetByte(0x25);
+        snapshot.mainProcessors.push_back(processor);
+    });
+
+    // Название - из /proc/cpuinfo: первая запись в начале файла
+    char model[4096];
+    std::string_view modelName;
+    if (ReadFile("/proc/cpuinfo", model, sizeof(model)) > 0) {
+        if (const char *line = strstr(model, "model name")) {
+            modelName = FieldValue(std::string_view(line, strcspn(line, "\n")));
+        }
+    }
 
-std::string NetworkInterface::GatGateway() const { return this->gateway; }
+    while (snapshot.mainProcessors.size() < packages.size()) {
+        snapshot.mainProcessors.push_back(CPU());
+    }
+    for (size_t index = 0; index < snapshot.mainProcessors.size(); ++index) {
+        CPU &processor = snapshot.mainProcessors[index];
+        if (processor.name.IsEmpty() && !modelName.empty()) {
+            processor.name = InternedString(modelName);
+        }
+        if (index >= packages.size()) {
+            continue;
+        }
+        // Выключенные процессоры sysfs не видит, паспорт DMI важнее
+        const PackageSummary &package = packages[index];
+        if (processor.cores == 0) {
+            processor.cores = package.cores;
+        }
+        if (processor.threads == 0) {
+            processor.threads = package.threads;
+        }
+        if (processor.maxSpeedMHz == 0) {
+            processor.maxSpeedMHz = package.maxFrequencyMHz;
+        }
+        processor.l1Cache = package.l1Cache;
+        processor.l2Cache = package.l2Cache;
+        processor.l3Cache = package.l3Cache;
+    }
+}
+
+void PC::CollectStaticRAMData() {
+    // Модули - структуры SMBIOS типа 17 (DSP0134, 7.18); Size 0 -
+    // пустой слот
+    ForEachDmiStructure(GetDmiTable(SysfsRoot()), 17, [this](const DmiStructure &entry) {
+        uint16_t size = entry.GetWord(0x0c);
+        if (size == 0 || size == 0xffff) {
+            return;
+        }
+        RAM module;
+        if (size == 0x7fff) {
+            module.size = static_cast<uint64_t>(entry.GetDword(0x1c) & 0x7fffffff) << 20;
+        } else if (size & 0x8000) {
+            module.size = static_cast<uint64_t>(size & 0x7fff) << 10;
+        } else {
+            module.size = static_cast<uint64_t>(size) << 20;
+        }
+        module.formFactor = InternedString(GetDmiFormFactor(entry.GetByte(0x0e)));
+        module.type = InternedString(GetDmiMemoryType(entry.GetByte(0x12)));
+        std::string_view bank = entry.GetString(0x11);
+        module.channel = InternedString(bank.empty() ? std::string_view("Single") : bank);
+        module.manufacturer = InternedString(entry.GetString(0x17));
+        module.name = InternedString(entry.GetString(0x1a));
+        module.rank = entry.GetByte(0x1b) & 0x0f;
+        module.speed = entry.GetWord(0x20);
+        if (module.speed == 0) {
+            module.speed = entry.GetWord(0x15);
+        }
+        snapshot.RAMDevices.push_back(module);
+    });
+}
 
 void PC::CollectUptime() {
-    std::ifstream uptimeFile("/proc/uptime");
-    if (uptimeFile.is_open()) {
-        double uptimeInSeconds{};
-        uptimeFile >> uptimeInSeconds;
+    char buffer[128];
+    if (ReadFile("/proc/uptime", buffer, sizeof(buffer)) > 0) {
+        double uptimeInSeconds = strtod(buffer, nullptr);
+        Uptime &uptime = snapshot.uptime;
 
         uptime.days = uptimeInSeconds / (24 * 3600);
         uptime.hours = (uptimeInSeconds - uptime.days * 24 * 3600) / 3600;
         uptime.minutes =
             (uptimeInSeconds - uptime.days * 24 * 3600 - uptime.hours * 3600) /
             60;
-
-        uptimeFile.close();
     }
 }
 
 void PC::CollectDynamicCPUData() {
-    for (int i = 0; i < 2; ++i) {
-        std::ifstream cpuUsageFile("/proc/stat");
-        std::string line;
-
-        if (std::getline(cpuUsageFile, line)) {
-            if (line.compare(0, 3, "cpu") == 0) {
-                std::istringstream iss(line);
-                std::string cpuName;
-                long long userProcess = 0;
-                long long niceProcess = 0;
-                long long system = 0;
-                long long idle = 0;
-                long long iowait = 0;
-                long long irq = 0;
-                long long softirq = 0;
-                long long steal = 0;
-
-                iss >> cpuName >> userProcess >> niceProcess >> system >> idle >>
-                    iowait >> irq >> softirq >> steal;
-
-                long long totalIdle = idle + iowait;
-                long long totalNotIdle =
-                    userProcess + niceProcess + system + irq + softirq + steal;
-                long long total = totalIdle + totalNotIdle;
-
-                if (currentCPUUseTotal != 0) {
-                    double differenceTotal = total - currentCPUUseTotal;
-                    double differenceIdle = totalIdle - currentCPUUseIdle;
-                    totalCPUUse =
-                        (differenceTotal - differenceIdle) / differenceTotal * 100.0;
-
-                    currentCPUUseTotal = total;
-                    currentCPUUseIdle = totalIdle;
-
-                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                    continue;
-                }
-
-                currentCPUUseTotal = total;
-                currentCPUUseIdle = totalIdle;
+    // Строки "cpu" и "cpuN" идут в начале /proc/stat, хвост (interrupts)
+    // может не поместиться в буфер и не нужен. Загрузка считается по
+    // разнице с предыдущим замером планировщика, без повторного чтения.
+    if (ReadFile("/proc/stat", procBuffer.data(), procBuffer.size()) <= 0) {
+        return;
+    }
+    for (LogicalCPU &cpu : logicalCPUs) {
+        cpu.online = false;
+    }
+    bool newCPU = false;
+    char *cursor = procBuffer.data();
+    while (strncmp(cursor, "cpu", 3) == 0) {
+        cursor += 3;
+        bool total = *cursor == ' ';
+        size_t core = total ? 0 : strtoul(cursor, &cursor, 10);
+
+        long long fields[8]{};
+        for (long long &field : fields) {
+            field = strtoll(cursor, &cursor, 10);
+        }
+        long long userProcess = fields[0];
+        long long niceProcess = fields[1];
+        long long system = fields[2];
+        long long idle = fields[3];
+        long long iowait = fields[4];
+        long long irq = fields[5];
+        long long softirq = fields[6];
+        long long steal = fields[7];
+
+        long long totalIdle = idle + iowait;
+        long long totalNotIdle =
+            userProcess + niceProcess + system + irq + softirq + steal;
+        long long totalTime = totalIdle + totalNotIdle;
+
+        if (total) {
+            if (currentCPUUseTotal != 0 && totalTime > currentCPUUseTotal) {
+                double differenceTotal = totalTime - currentCPUUseTotal;
+                double differenceIdle = totalIdle - currentCPUUseIdle;
+                snapshot.cpuUse =
+                    (differenceTotal - differenceIdle) / differenceTotal * 100.0;
+                PushHistory(Series::CPU, static_cast<float>(snapshot.cpuUse));
+            }
+            currentCPUUseTotal = totalTime;
+            currentCPUUseIdle = totalIdle;
+        } else {
+            // Список ядер растёт только при первом замере и при hotplug.
+            // Бюджет делится на все настроенные процессоры сразу, чтобы
+            // первые ядра не получили больше остальных.
+            while (coreTimes.size() <= core) {
+                size_t cores = std::max<size_t>(
+                    core + 1, static_cast<size_t>(std::max(1, get_nprocs_conf())));
+                coreTimes.push_back(CPUTimes{0, 0});
+                coreHistory.emplace_back(
+                    std::clamp<size_t>(coreHistoryBudget / cores, 1, coreHistoryCapacity));
+                coreQuantiles.emplace_back();
+                LogicalCPU cpu;
+                cpu.id = static_cast<uint32_t>(logicalCPUs.size());
+                logicalCPUs.push_back(cpu);
+                newCPU = true;
             }
+            CPUTimes &times = coreTimes[core];
+            LogicalCPU &cpu = logicalCPUs[core];
+            cpu.online = true;
+            if (times.total != 0 && totalTime > times.total) {
+                double differenceTotal = totalTime - times.total;
+                double differenceIdle = totalIdle - times.idle;
+                cpu.use = static_cast<float>((differenceTotal - differenceIdle) /
+                                             differenceTotal * 100.0);
+                coreHistory[core].Push(sampleTimeNs, cpu.use);
+                coreQuantiles[core].Add(sampleTimeNs, cpu.use);
+            }
+            times.total = totalTime;
+            times.idle = totalIdle;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    }
-
-    std::vector<CPU>::iterator temp = mainProcessors.begin();
-    sensors_init(nullptr);
-
-    sensors_chip_name const *chip;
-    int chip_nr = 0;
 
-    while ((chip = sensors_get_detected_chips(nullptr, &chip_nr))) {
-        if (chip->prefix &&
-            (strstr(chip->prefix, "coretemp") || strstr(chip->prefix, "k10temp") ||
-             strstr(chip->prefix, "zenpower"))) {
+        cursor = strchr(cursor, '\n');
+        if (!cursor) {
+            break;
+        }
+        ++cursor;
+    }
+    if (newCPU) {
+        LoadTopology();
+    }
 
-            sensors_feature const *feature;
-            int feature_nr = 0;
+    // Энергия пакетов снимается тем же тиком, что и загрузка, - для
+    // сопоставления мощности с нагрузкой
+    power.Read(sampleTimeNs);
+    if (power.IsReadable()) {
+        PushHistory(Series::PackagePower, power.GetPackageWatts());
+    }
 
-            while ((feature = sensors_get_features(chip, &feature_nr))) {
-                if (feature->type == SENSORS_FEATURE_TEMP) {
-                    sensors_subfeature const *sub = sensors_get_subfeature(
-                        chip, feature, SENSORS_SUBFEATURE_TEMP_INPUT);
+    // Температуры раскладываются по процессорам, известным только после
+    // статической пробы CPU.
+    if (!IsReady(Probe::CPU)) {
+        return;
+    }
 
-                    if (sub) {
-                        double val;
-                        int rc = sensors_get_value(chip, sub->number, &val);
-                        if (rc >= 0) {
-                            temp->temperature = val;
-                            ++temp;
-                        }
-                    }
-                }
+    // Датчики уже привязаны к пакетам и ядрам в LoadTopology: здесь
+    // только pread по открытым дескрипторам
+    temperatures.Read();
+    int32_t hottest = 0;
+    for (size_t package = 0; package < snapshot.mainProcessors.size(); ++package) {
+        CPU &processor = snapshot.mainProcessors[package];
+        processor.temperature = temperatures.GetPackage(static_cast<int32_t>(package));
+        hottest = std::max(hottest, processor.temperature);
+        processor.powerMilliwatts = 0;
+        for (const PowerDomain &domain : power.GetDomains()) {
+            if (domain.kind == PowerDomain::Kind::Package &&
+                domain.package == static_cast<int32_t>(package)) {
+                processor.powerMilliwatts = static_cast<uint32_t>(domain.watts * 1000);
             }
         }
     }
-    sensors_cleanup();
+    for (LogicalCPU &cpu : logicalCPUs) {
+        cpu.temperature = temperatures.GetCpu(cpu.id);
+        hottest = std::max(hottest, cpu.temperature);
+    }
+    if (hottest != 0) {
+        PushHistory(Series::Temperature, hottest / 1000.0f);
+    }
 }
 
-void PC::CollectDynamicRAMData() {
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        summaryRAMVolume =
-            static_cast<double>(info.totalram * info.mem_unit) / (1024 * 1024);
-        usedRAMVolume =
-            static_cast<double>((info.totalram - info.freeram) * info.mem_unit) /
-            (1024 * 1024);
+void PC::LoadTopology() {
+    topology.Load(SysfsRoot(), logicalCPUs.size());
+    temperatures.Load(SysfsRoot(), topology);
+    for (LogicalCPU &cpu : logicalCPUs) {
+        const CpuPlacement &placement = topology.GetPlacement(cpu.id);
+        cpu.package = placement.package;
+        cpu.die = placement.die;
+        cpu.node = placement.node;
+        cpu.core = placement.core;
+        cpu.llc = placement.llc;
+        cpu.minFrequencyMHz = placement.minFrequencyMHz;
+        cpu.maxFrequencyMHz = placement.maxFrequencyMHz;
+        cpu.governor = placement.governor;
     }
+    ++topologyVersion;
 }
 
-void PC::CollectCommonNIsData() {
-    struct ifaddrs *ifaddr, *ifa;
-    int family{};
+void PC::CollectCoreFrequencies() {
+    // Hotplug: список online сверяется одним pread, дерево
+    // перестраивается только при его изменении
+    if (topology.GetCpuCount() != logicalCPUs.size() || topology.IsStale()) {
+        LoadTopology();
+    }
+    for (LogicalCPU &cpu : logicalCPUs) {
+        cpu.frequencyMHz = cpu.online ? topology.ReadFrequencyMHz(cpu.id) : 0;
+    }
+}
 
-    if (getifaddrs(&ifaddr) == -1) {
+void PC::CollectPerfCounters() {
+    // Группы открываются на включённые процессоры и переоткрываются
+    // при hotplug; после отказа (нет прав) повторных попыток нет
+    if (perfTopologyVersion != topologyVersion) {
+        perfTopologyVersion = topologyVersion;
+        std::vector<bool> online;
+        for (const LogicalCPU &cpu : logicalCPUs) {
+            online.push_back(cpu.online);
+        }
+        perfError.clear();
+        if (online.empty() || !perfCounters.Open(online, perfError)) {
+            perfCounters.Close();
+        }
+    }
+    if (!perfCounters.IsOpen()) {
         return;
     }
+    perfCounters.Read();
+    const std::vector<CoreCounters> &counters = perfCounters.GetCounters();
+    for (LogicalCPU &cpu : logicalCPUs) {
+        cpu.ipc = cpu.id < counters.size() ? counters[cpu.id].ipc : 0;
+        cpu.pmuRunning = cpu.id < counters.size() ? counters[cpu.id].running : 0;
+    }
+}
 
-    for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-        bool ifaceExists = false;
-        NetworkInterface tempNIs{};
-        tempNIs.name = ifa->ifa_name;
-
-        if (ifa->ifa_addr == nullptr) {
-            continue;
+void PC::CollectDynamicRAMData() {
+    struct sysinfo info;
+    ssize_t got = TracedRead("sysinfo", reinterpret_cast<char *>(&info), sizeof(info),
+                             [&info]() -> ssize_t { return sysinfo(&info) == 0 ? sizeof(info) : -1; });
+    if (got == static_cast<ssize_t>(sizeof(info))) {
+        snapshot.RAMVolume = static_cast<uint64_t>(info.totalram) * info.mem_unit;
+        snapshot.usedRAMVolume =
+            static_cast<uint64_t>(info.totalram - info.freeram) * info.mem_unit;
+        if (snapshot.RAMVolume != 0) {
+            PushHistory(Series::Memory,
+                        static_cast<float>(static_cast<double>(snapshot.usedRAMVolume) /
+                                           snapshot.RAMVolume * 100.0));
         }
+    }
 
-        family = ifa->ifa_addr->sa_family;
-
-        if (family == AF_INET) {
-            char ip[INET_ADDRSTRLEN]{};
-            char netmask[INET_ADDRSTRLEN]{};
-            struct sockaddr_in *addr = (struct sockaddr_in *)ifa->ifa_addr;
-            struct sockaddr_in *mask = (struct sockaddr_in *)ifa->ifa_netmask;
-            inet_ntop(AF_INET, &addr->sin_addr, ip, INET_ADDRSTRLEN);
-            inet_ntop(AF_INET, &mask->sin_addr, netmask, INET_ADDRSTRLEN);
+    // MemAvailable есть только в /proc/meminfo: sysinfo не учитывает
+    // освобождаемые кэши. Строка третья, первых 256 байт хватает.
+    char buffer[256];
+    if (ReadFile("/proc/meminfo", buffer, sizeof(buffer)) > 0) {
+        if (const char *line = strstr(buffer, "MemAvailable:")) {
+            snapshot.availableRAMVolume =
+                strtoull(line + strlen("MemAvailable:"), nullptr, 10) * 1024;
+            if (snapshot.RAMVolume != 0) {
+                PushHistory(Series::MemoryAvailable,
+                            static_cast<float>(static_cast<double>(snapshot.availableRAMVolume) /
+                                               snapshot.RAMVolume * 100.0));
+            }
+        }
+    }
+}
 
-            for (std::vector<NetworkInterface>::iterator temp = NIs.begin();
-                 temp != NIs.end(); ++temp) {
-                if (temp->name == ifa->ifa_name) {
-                    ifaceExists = true;
-                    temp->ipv4 = ip;
-                    temp->ipv4Netmask = netmask;
+void PC::CollectNIAddresses() {
+    // Список getifaddrs перекладывается в записи фиксированного размера:
+    // в таком виде он попадает в трассу входов и разбирается одинаково
+    // при живом замере и при воспроизведении
+    struct AddressRecord {
+        char name[IFNAMSIZ];
+        uint8_t family;
+        bool hasNetmask;
+        uint8_t address[16];
+        uint8_t netmask[16];
+    };
+    static_assert(std::is_trivially_copyable_v<AddressRecord>);
+    ssize_t got = TracedRead("getifaddrs", procBuffer.data(), procBuffer.size(), [this]() -> ssize_t {
+        struct ifaddrs *ifaddr;
+        if (getifaddrs(&ifaddr) == -1) {
+            return -1;
+        }
+        size_t used = 0;
+        for (struct ifaddrs *ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+            if (ifa->ifa_addr == nullptr || used + sizeof(AddressRecord) > procBuffer.size()) {
+                continue;
+            }
+            AddressRecord record{};
+            strncpy(record.name, ifa->ifa_name, sizeof(record.name) - 1);
+            record.family = static_cast<uint8_t>(ifa->ifa_addr->sa_family);
+            record.hasNetmask = ifa->ifa_netmask != nullptr;
+            if (record.family == AF_INET) {
+                memcpy(record.address, &reinterpret_cast<sockaddr_in *>(ifa->ifa_addr)->sin_addr,
+                       sizeof(in_addr));
+                if (record.hasNetmask) {
+                    memcpy(record.netmask,
+                           &reinterpret_cast<sockaddr_in *>(ifa->ifa_netmask)->sin_addr,
+                           sizeof(in_addr));
+                }
+            } else if (record.family == AF_INET6) {
+                memcpy(record.address, &reinterpret_cast<sockaddr_in6 *>(ifa->ifa_addr)->sin6_addr,
+                       sizeof(in6_addr));
+                if (record.hasNetmask) {
+                    memcpy(record.netmask,
+                           &reinterpret_cast<sockaddr_in6 *>(ifa->ifa_netmask)->sin6_addr,
+                           sizeof(in6_addr));
                 }
             }
-            if (!ifaceExists) {
-                tempNIs.ipv4 = ip;
-                tempNIs.ipv4Netmask = netmask;
-                NIs.push_back(tempNIs);
-                ifaceExists = true;
+            memcpy(procBuffer.data() + used, &record, sizeof(record));
+            used += sizeof(record);
+        }
+        freeifaddrs(ifaddr);
+        return static_cast<ssize_t>(used);
+    });
+    if (got < 0) {
+        return;
+    }
+
+    // Записи обновляются на месте; исчезнувшие интерфейсы удаляются в конце.
+    for (auto &known : snapshot.NIs) {
+        known.seen = false;
+        known.flags &= ~(NetworkInterface::HasIpv4 | NetworkInterface::HasIpv6);
+    }
+
+    for (size_t offset = 0; offset + sizeof(AddressRecord) <= static_cast<size_t>(got);
+         offset += sizeof(AddressRecord)) {
+        AddressRecord record;
+        memcpy(&record, procBuffer.data() + offset, sizeof(record));
+        record.name[sizeof(record.name) - 1] = '\0';
+
+        InternedString name(record.name);
+        NetworkInterface *current = nullptr;
+        for (auto &known : snapshot.NIs) {
+            if (known.name == name) {
+                current = &known;
+                break;
             }
         }
+        if (!current) {
+            snapshot.NIs.emplace_back();
+            current = &snapshot.NIs.back();
+            current->name = name;
+        }
+        current->seen = true;
 
-        else if (family == AF_INET6) {
-            char ip6[INET6_ADDRSTRLEN]{};
-            char netmask6[INET6_ADDRSTRLEN]{};
-            struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)ifa->ifa_addr;
-            struct sockaddr_in6 *mask6 = (struct sockaddr_in6 *)ifa->ifa_netmask;
-            inet_ntop(AF_INET6, &addr6->sin6_addr, ip6, INET6_ADDRSTRLEN);
-            inet_ntop(AF_INET6, &mask6->sin6_addr, netmask6, INET6_ADDRSTRLEN);
-
-            for (std::vector<NetworkInterface>::iterator temp = NIs.begin();
-                 temp != NIs.end(); ++temp) {
-                if (temp->name == ifa->ifa_name) {
-                    ifaceExists = true;
-                    temp->ipv6 = ip6;
-                    temp->ipv6Netmask = netmask6;
-                }
+        if (record.family == AF_INET) {
+            memcpy(&current->ipv4, record.address, sizeof(in_addr));
+            if (record.hasNetmask) {
+                memcpy(&current->ipv4Netmask, record.netmask, sizeof(in_addr));
             }
-            if (!ifaceExists) {
-                tempNIs.ipv6 = ip6;
-                tempNIs.ipv6Netmask = netmask6;
-                NIs.push_back(tempNIs);
-                ifaceExists = true;
+            current->flags |= NetworkInterface::HasIpv4;
+        } else if (record.family == AF_INET6) {
+            memcpy(&current->ipv6, record.address, sizeof(in6_addr));
+            if (record.hasNetmask) {
+                memcpy(&current->ipv6Netmask, record.netmask, sizeof(in6_addr));
             }
+            current->flags |= NetworkInterface::HasIpv6;
         }
+    }
 
-        if (!ifaceExists) {
-            tempNIs.ipv4 = "-";
-            tempNIs.ipv4Netmask = "-";
-            tempNIs.ipv6 = "-";
-            tempNIs.ipv6Netmask = "-";
-            NIs.push_back(tempNIs);
+    for (size_t i = 0; i < snapshot.NIs.size();) {
+        if (snapshot.NIs[i].seen) {
+            ++i;
+        } else {
+            snapshot.NIs.erase(snapshot.NIs.begin() + i);
         }
     }
+}
 
-    freeifaddrs(ifaddr);
-
-    for (std::vector<NetworkInterface>::iterator temp = NIs.begin();
-         temp != NIs.end(); ++temp) {
-        std::string path = "/sys/class/net/" + temp->name + "/address";
-        std::ifstream addressFile(path);
-        if (addressFile) {
-            std::getline(addressFile, temp->mac);
-
-            addressFile.close();
+void PC::CollectNILinks() {
+    char route[16384];
+    if (ReadFile("/proc/net/route", route, sizeof(route)) < 0) {
+        route[0] = '\0';
+    }
 
-            if (!temp->mac.empty() && temp->mac.back() == '\n') {
-                temp->mac.pop_back();
+    for (auto &current : snapshot.NIs) {
+        std::string_view name = current.name.View();
+        char path[128];
+        char address[64];
+        snprintf(path, sizeof(path), "/sys/class/net/%.*s/address",
+                 static_cast<int>(name.size()), name.data());
+
+        unsigned int bytes[6];
+        if (ReadFile(path, address, sizeof(address)) > 0 &&
+            sscanf(address, "%x:%x:%x:%x:%x:%x", &bytes[0], &bytes[1], &bytes[2],
+                   &bytes[3], &bytes[4], &bytes[5]) == 6) {
+            for (size_t i = 0; i < 6; ++i) {
+                current.mac[i] = static_cast<uint8_t>(bytes[i]);
             }
+            current.flags |= NetworkInterface::HasMac;
         } else {
-            temp->mac = "-";
+            current.flags &= ~NetworkInterface::HasMac;
         }
 
-        std::ifstream route("/proc/net/route");
-        std::string line;
-
-        while (std::getline(route, line)) {
-            if (line.find(temp->name) != std::string::npos) {
-                std::istringstream iss(line);
-                std::string iface, dest, gateway;
-                iss >> iface >> dest >> gateway;
-
-                if (dest == "00000000") {
-                    struct in_addr addr;
-                    addr.s_addr = std::stoul(gateway, nullptr, 16);
-                    temp->gateway = inet_ntoa(addr);
-                }
+        // Маршрут по умолчанию: Destination 00000000 у этого интерфейса
+        current.flags &= ~NetworkInterface::HasGateway;
+        for (char *line = route; *line;) {
+            char *next = strchr(line, '\n');
+            char iface[IFNAMSIZ + 1]{};
+            char dest[16]{};
+            char gateway[16]{};
+            if (sscanf(line, "%16s %15s %15s", iface, dest, gateway) == 3 &&
+                name == iface && strcmp(dest, "00000000") == 0) {
+                current.gateway.s_addr =
+                    static_cast<in_addr_t>(strtoul(gateway, nullptr, 16));
+                current.flags |= NetworkInterface::HasGateway;
+            }
+            if (!next) {
+                break;
             }
+            line = next + 1;
         }
+    }
+}
 
-        route.close();
-
-        if (temp->gateway.empty()) {
-            temp->gateway = "-";
+void PC::CollectDNS() {
+    char buffer[8192];
+    if (ReadFile("/etc/resolv.conf", buffer, sizeof(buffer)) < 0) {
+        return;
+    }
+    snapshot.DNS.clear();
+    std::string_view text(buffer);
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+        if (line.compare(0, 11, "nameserver ") == 0) {
+            line.remove_prefix(11);
+            line = line.substr(0, line.find('%'));
+            line = line.substr(0, line.find_first_of(" \t#"));
+            snapshot.DNS.push_back(InternedString(line));
         }
     }
+}
 
-    std::ifstream resolv("/etc/resolv.conf");
-    std::string line;
-    if (resolv) {
-        while (std::getline(resolv, line)) {
-            if(line.find("nameserver") != std::string::npos){
-                int delimeterPos = line.find('%');
-                if (delimeterPos == -1) {
-                    delimeterPos = line.size();
-                }
-                DNS.push_back(
-                    line.substr(11, line.size() - 11 - (line.size() - delimeterPos)));
+void PC::CollectNITraffic() {
+    // Суммарный трафик всех интерфейсов, кроме loopback. Скорость - по
+    // фактическому времени между замерами, а не по номинальному интервалу.
+    if (ReadFile("/proc/net/dev", procBuffer.data(), procBuffer.size()) <= 0) {
+        return;
+    }
+    uint64_t rxBytes = 0;
+    uint64_t txBytes = 0;
+    for (InterfaceTraffic &traffic : interfaceTraffic) {
+        traffic.seen = false;
+    }
+    char *line = procBuffer.data();
+    while (line && *line) {
+        char *next = strchr(line, '\n');
+        char *colon = strchr(line, ':');
+        if (colon && (!next || colon < next)) {
+            char *name = line;
+            while (*name == ' ') {
+                ++name;
+            }
+            std::string_view interfaceName(name, colon - name);
+            char *cursor = colon + 1;
+            uint64_t fields[9]{};
+            for (uint64_t &field : fields) {
+                field = strtoull(cursor, &cursor, 10);
             }
+            if (interfaceName != "lo") {
+                rxBytes += fields[0];
+                txBytes += fields[8];
+            }
+
+            // Поиск по интернированному имени - без аллокаций, список
+            // растёт только при появлении интерфейса
+            InternedString key(interfaceName);
+            auto known = std::find_if(interfaceTraffic.begin(), interfaceTraffic.end(),
+                                      [key](const InterfaceTraffic &traffic) {
+                                          return traffic.name == key;
+                                      });
+            if (known == interfaceTraffic.end()) {
+                interfaceTraffic.emplace_back();
+                interfaceTraffic.back().name = key;
+                interfaceTraffic.back().rxBytes = fields[0];
+                interfaceTraffic.back().txBytes = fields[8];
+                known = interfaceTraffic.end() - 1;
+            } else if (lastTrafficTimeNs != 0 && sampleTimeNs > lastTrafficTimeNs &&
+                       fields[0] >= known->rxBytes && fields[8] >= known->txBytes) {
+                double seconds = (sampleTimeNs - lastTrafficTimeNs) / 1e9;
+                known->rxRate = static_cast<float>((fields[0] - known->rxBytes) / seconds);
+                known->txRate = static_cast<float>((fields[8] - known->txBytes) / seconds);
+                known->rxQuantiles.Add(sampleTimeNs, known->rxRate);
+                known->txQuantiles.Add(sampleTimeNs, known->txRate);
+            }
+            known->rxBytes = fields[0];
+            known->txBytes = fields[8];
+            known->seen = true;
         }
-        resolv.close();
+        line = next ? next + 1 : nullptr;
+    }
+    interfaceTraffic.erase(
+        std::remove_if(interfaceTraffic.begin(), interfaceTraffic.end(),
+                       [](const InterfaceTraffic &traffic) { return !traffic.seen; }),
+        interfaceTraffic.end());
+
+    if (lastTrafficTimeNs != 0 && sampleTimeNs > lastTrafficTimeNs &&
+        rxBytes >= lastRxBytes && txBytes >= lastTxBytes) {
+        double seconds = (sampleTimeNs - lastTrafficTimeNs) / 1e9;
+        PushHistory(Series::NetworkRx,
+                    static_cast<float>((rxBytes - lastRxBytes) / seconds));
+        PushHistory(Series::NetworkTx,
+                    static_cast<float>((txBytes - lastTxBytes) / seconds));
     }
+    lastRxBytes = rxBytes;
+    lastTxBytes = txBytes;
+    lastTrafficTimeNs = sampleTimeNs;
 }
 
 void PC::CollectPCIDevices() {
     FILE *pipe = popen("lspci", "r");
     if (pipe) {
         char buffer[256];
+        std::vector<InternedString> GPU;
+        std::vector<InternedString> NIControllers;
 
         while (fgets(buffer, sizeof(buffer), pipe)) {
-            std::string line(buffer);
-
-            if (line.find("VGA compatible controller:") != std::string::npos) {
-                line = line.substr(line.find(":") + 2);
-                line.pop_back();
-                GPU.push_back(line.substr(line.find(":") + 2));
-            } else if (line.find("Ethernet controller:") != std::string::npos ||
-                       line.find("Network controller:") != std::string::npos) {
-                line = line.substr(line.find(":") + 2);
-                line.pop_back();
-                NIControllers.push_back(line.substr(line.find(":") + 2));
+            std::string_view line(buffer);
+
+            if (line.find("VGA compatible controller:") != std::string_view::npos) {
+                GPU.push_back(InternedString(FieldValue(FieldValue(line))));
+            } else if (line.find("Ethernet controller:") != std::string_view::npos ||
+                       line.find("Network controller:") != std::string_view::npos) {
+                NIControllers.push_back(
+                    InternedString(FieldValue(FieldValue(line))));
             }
         }
         pclose(pipe);
+        snapshot.GPU.swap(GPU);
+        snapshot.NIControllers.swap(NIControllers);
     }
 }
 
-std::vector<std::string> &PC::GetGPU() { return this->GPU; }
-std::vector<std::string> &PC::GetNIControllers() { return this->NIControllers; }
+void PC::StartProbe(Probe probe, const char *name, void (PC::*collect)()) {
+    LatencyHistogram &histogram = Diagnostics::GetInstance().GetHistogram(name);
+    probes[static_cast<size_t>(probe)] =
+        std::async(std::launch::async, [this, &histogram, collect]() {
+            {
+                ScopedTimer timer(histogram);
+                (this->*collect)();
+            }
+            if (probeFd >= 0) {
+                uint64_t one = 1;
+                ssize_t written = write(probeFd, &one, sizeof(one));
+                (void)written;
+            }
+        }).share();
+}
 
-PC::PC() {
-    CollectHostname();
+PC::PC()
+    : probeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), changeLogHead(0),
+    firstLoggedGeneration(1), probePublished{}, sampleTimeNs(0),
+    procBuffer(64 * 1024), lastRxBytes(0), lastTxBytes(0),
+    lastTrafficTimeNs(0), topologyVersion(0), perfTopologyVersion(0), replayStartNs(0),
+    replayFirstNs(0), replayOffsetNs(0), replaySpeed(0) {
+    changeLog.resize(changeLogCapacity);
+    for (History &series : history) {
+        series = History(seriesCapacity);
+    }
+    LoadAlertRules();
+    power.Load(SysfsRoot());
+
+    // Пробы (SMBIOS через помощника, lspci) идут параллельно, а окно
+    // показывается сразу и заполняет разделы по мере готовности.
+    StartProbe(Probe::Hostname, "CollectHostname", &PC::CollectHostname);
+    StartProbe(Probe::CPU, "CollectStaticCPUData", &PC::CollectStaticCPUData);
+    StartProbe(Probe::RAM, "CollectStaticRAMData", &PC::CollectStaticRAMData);
+    StartProbe(Probe::PCI, "CollectPCIDevices", &PC::CollectPCIDevices);
+
+    const uint64_t second = 1000000000ull;
+    auto task = [this](Collector collector) -> Scheduler::TaskId & {
+        return tasks[static_cast<size_t>(collector)];
+    };
+    task(Collector::Uptime) = scheduler.AddTask(
+        "CollectUptime", second, 0,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectUptime, nowNs); },
+        60 * second);
+    task(Collector::CPU) = scheduler.AddTask(
+        "CollectDynamicCPUData", second, 10,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectDynamicCPUData, nowNs); },
+        5 * second);
+    task(Collector::RAM) = scheduler.AddTask(
+        "CollectDynamicRAMData", second, 5,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectDynamicRAMData, nowNs); },
+        5 * second);
+    task(Collector::NetworkAddresses) = scheduler.AddTask(
+        "CollectNIAddresses", 2 * second, 3,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectNIAddresses, nowNs); },
+        30 * second);
+    task(Collector::NetworkLinks) = scheduler.AddTask(
+        "CollectNILinks", 10 * second, 2,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectNILinks, nowNs); }, 60 * second);
+    task(Collector::DNS) = scheduler.AddTask(
+        "CollectDNS", 30 * second, 1,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectDNS, nowNs); }, 300 * second);
+    task(Collector::PCI) = scheduler.AddTask(
+        "CollectPCIDevices", 300 * second, 0,
+        [this](uint64_t nowNs) {
+            if (IsReady(Probe::PCI)) {
+                RunCollector(&PC::CollectPCIDevices, nowNs);
+            }
+        });
+    task(Collector::NetworkTraffic) = scheduler.AddTask(
+        "CollectNITraffic", second, 4,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectNITraffic, nowNs); },
+        5 * second);
+    task(Collector::CoreFrequency) = scheduler.AddTask(
+        "CollectCoreFrequencies", second, 6,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectCoreFrequencies, nowNs); },
+        30 * second);
+    task(Collector::PerfCounters) = scheduler.AddTask(
+        "CollectPerfCounters", second, 6,
+        [this](uint64_t nowNs) { RunCollector(&PC::CollectPerfCounters, nowNs); },
+        30 * second);
 
-    CollectStaticCPUData();
+    UpdateData();
+}
 
-    CollectStaticRAMData();
+PC::~PC() {
+    for (auto &probe : probes) {
+        if (probe.valid()) {
+            probe.wait();
+        }
+    }
+    if (probeFd >= 0) {
+        close(probeFd);
+    }
+}
 
-    CollectPCIDevices();
+bool PC::IsReady(Probe probe) const {
+    const auto &future = probes[static_cast<size_t>(probe)];
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) ==
+                                 std::future_status::ready;
+}
 
-    UpdateData();
+void PC::WaitReady(Probe probe) const {
+    const auto &future = probes[static_cast<size_t>(probe)];
+    if (future.valid()) {
+        future.wait();
+    }
+}
+
+int PC::GetProbeFd() const { return this->probeFd; }
+
+void PC::LogChange(Snapshot::Section section, uint32_t index, uint32_t mask) {
+    // Кольцевой журнал фиксированного размера: при переполнении самые старые
+    // записи вытесняются, и запросы с более ранних поколений получают full.
+    ChangeRecord &slot = changeLog[changeLogHead % changeLogCapacity];
+    if (changeLogHead >= changeLogCapacity) {
+        firstLoggedGeneration = slot.generation + 1;
+    }
+    slot.generation = snapshot.generation + 1;
+    slot.change = Change{section, index, mask};
+    ++changeLogHead;
+}
+
+template <typename T>
+void PC::DiffRecords(Snapshot::Section section, std::vector<T> &current,
+                     const std::vector<T> &old) {
+    if (current.size() != old.size()) {
+        for (T &record : current) {
+            record.dirty = ~0u;
+        }
+        LogChange(section, UINT32_MAX, structureChanged);
+        return;
+    }
+    for (size_t i = 0; i < current.size(); ++i) {
+        current[i].dirty = current[i].Compare(old[i]);
+        if (current[i].dirty != 0) {
+            LogChange(section, static_cast<uint32_t>(i), current[i].dirty);
+        }
+    }
+}
+
+void PC::PollProbes() {
+    using Section = Snapshot::Section;
+    size_t logged = changeLogHead;
+    auto publish = [this](Probe probe, Section section, uint32_t mask) {
+        size_t index = static_cast<size_t>(probe);
+        if (!probePublished[index] && IsReady(probe)) {
+            probePublished[index] = true;
+            LogChange(section, section == Section::System ? 0 : UINT32_MAX, mask);
+        }
+    };
+    publish(Probe::Hostname, Section::System, Snapshot::HostnameField);
+    publish(Probe::CPU, Section::CPU, structureChanged);
+    publish(Probe::RAM, Section::RAM, structureChanged);
+    publish(Probe::PCI, Section::PCI, structureChanged);
+    if (changeLogHead != logged) {
+        ++snapshot.generation;
+    }
+}
+
+const char *PC::GetSeriesName(Series series) {
+    static const char *const names[] = {"cpu", "memory", "net_rx", "net_tx",
+                                        "temperature", "mem_available", "power"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Series::Count),
+                  "every series needs a metric name");
+    return names[static_cast<size_t>(series)];
+}
+
+void PC::PushHistory(Series series, float value) {
+    history[static_cast<size_t>(series)].Push(sampleTimeNs, value);
+    quantiles[static_cast<size_t>(series)].Add(sampleTimeNs, value);
+    alerts.Sample(static_cast<uint32_t>(series), sampleTimeNs, value);
+}
+
+void PC::LoadAlertRules() {
+    // Имена метрик регистрируются в порядке Series, индекс совпадает
+    for (size_t series = 0; series < static_cast<size_t>(Series::Count); ++series) {
+        alerts.RegisterMetric(GetSeriesName(static_cast<Series>(series)));
+    }
+    alerts.SetLog(&std::clog);
+
+    // ULSM_ALERT_RULES, затем $XDG_CONFIG_HOME/ulsm/alerts.conf или
+    // ~/.config/ulsm/alerts.conf; без файла - правила по умолчанию.
+    std::string path;
+    if (const char *explicitPath = getenv("ULSM_ALERT_RULES")) {
+        path = explicitPath;
+    } else if (const char *config = getenv("XDG_CONFIG_HOME")) {
+        path = std::string(config) + "/ulsm/alerts.conf";
+    } else if (const char *home = getenv("HOME")) {
+        path = std::string(home) + "/.config/ulsm/alerts.conf";
+    }
+    if (!path.empty() && access(path.c_str(), R_OK) == 0) {
+        alerts.LoadRules(path.c_str(), std::cerr);
+        return;
+    }
+
+    std::string error;
+    for (const char *rule : {"cpu_busy: cpu > 90 for 30s",
+                             "memory_low: mem_available < 5%",
+                             "cpu_hot: temperature > 90 for 10s"}) {
+        if (!alerts.AddRule(rule, error)) {
+            std::cerr << "Default alert rule '" << rule << "': " << error << std::endl;
+        }
+    }
+}
+
+const std::array<PC::Collect, static_cast<size_t>(PC::Collector::Count)> PC::collectors = {
+    &PC::CollectUptime,      &PC::CollectDynamicCPUData,  &PC::CollectDynamicRAMData,
+    &PC::CollectNIAddresses, &PC::CollectNILinks,         &PC::CollectDNS,
+    &PC::CollectPCIDevices,  &PC::CollectNITraffic,       &PC::CollectCoreFrequencies,
+    &PC::CollectPerfCounters};
+
+void PC::RunCollector(Collect collect, uint64_t nowNs) {
+    using Section = Snapshot::Section;
+    InputTrace &trace = InputTrace::GetInstance();
+    // При воспроизведении живые замеры не выполняются: входы идут только
+    // из трассы (ReplayNext открывает замер до вызова)
+    if (trace.IsReplaying() && !InputTrace::IsTracing()) {
+        return;
+    }
+    // lspci и счётчики perf в трассу не попадают: это не чтения файлов
+    bool recording = false;
+    if (trace.IsRecording() && collect != &PC::CollectPCIDevices &&
+        collect != &PC::CollectPerfCounters) {
+        size_t collector = static_cast<size_t>(
+            std::find(collectors.begin(), collectors.end(), collect) - collectors.begin());
+        trace.BeginRun(static_cast<uint32_t>(collector), nowNs);
+        recording = true;
+    }
+    sampleTimeNs = nowNs;
+    uint64_t allocations = Diagnostics::GetThreadAllocationCount();
+    PollProbes();
+
+    // Разделы, которые ещё заполняет фоновая проба, не копируются и не
+    // сравниваются. Копирование переиспользует ёмкость векторов previous.
+    bool cpuReady = IsReady(Probe::CPU);
+    bool pciReady = IsReady(Probe::PCI);
+    previous.uptime = snapshot.uptime;
+    previous.cpuUse = snapshot.cpuUse;
+    previous.RAMVolume = snapshot.RAMVolume;
+    previous.usedRAMVolume = snapshot.usedRAMVolume;
+    previous.availableRAMVolume = snapshot.availableRAMVolume;
+    if (cpuReady) {
+        previous.mainProcessors = snapshot.mainProcessors;
+    }
+    previous.NIs = snapshot.NIs;
+    previous.DNS = snapshot.DNS;
+    if (pciReady) {
+        previous.GPU = snapshot.GPU;
+        previous.NIControllers = snapshot.NIControllers;
+    }
+
+    (this->*collect)();
+    if (recording) {
+        trace.EndRun();
+    }
+
+    size_t logged = changeLogHead;
+    const Uptime &uptime = snapshot.uptime;
+    uint32_t system = 0;
+    if (uptime.days != previous.uptime.days ||
+        uptime.hours != previous.uptime.hours ||
+        uptime.minutes != previous.uptime.minutes) {
+        system |= Snapshot::UptimeField;
+    }
+    if (snapshot.cpuUse != previous.cpuUse) {
+        system |= Snapshot::CPUUseField;
+    }
+    if (snapshot.RAMVolume != previous.RAMVolume) {
+        system |= Snapshot::RAMVolumeField;
+    }
+    if (snapshot.usedRAMVolume != previous.usedRAMVolume) {
+        system |= Snapshot::UsedRAMVolumeField;
+    }
+    if (snapshot.availableRAMVolume != previous.availableRAMVolume) {
+        system |= Snapshot::AvailableRAMVolumeField;
+    }
+    if (system != 0) {
+        LogChange(Section::System, 0, system);
+    }
+    if (cpuReady) {
+        DiffRecords(Section::CPU, snapshot.mainProcessors, previous.mainProcessors);
+    }
+    DiffRecords(Section::NetworkInterfaces, snapshot.NIs, previous.NIs);
+    if (snapshot.DNS != previous.DNS) {
+        LogChange(Section::DNS, UINT32_MAX, structureChanged);
+    }
+    if (pciReady && (snapshot.GPU != previous.GPU ||
+                     snapshot.NIControllers != previous.NIControllers)) {
+        LogChange(Section::PCI, UINT32_MAX, structureChanged);
+    }
+
+    if (changeLogHead != logged) {
+        ++snapshot.generation;
+    }
+    Diagnostics::AddSamplingAllocations(Diagnostics::GetThreadAllocationCount() - allocations);
+}
+
+uint64_t PC::GetGeneration() const { return snapshot.generation; }
+
+void PC::ChangedSince(uint64_t generation, ChangeSet &out) const {
+    out.generation = snapshot.generation;
+    out.changes.clear();
+    out.full = generation == 0 || generation + 1 < firstLoggedGeneration;
+    if (out.full) {
+        return;
+    }
+
+    size_t logged = std::min(changeLogHead, changeLogCapacity);
+    for (size_t i = changeLogHead - logged; i < changeLogHead; ++i) {
+        const ChangeRecord &record = changeLog[i % changeLogCapacity];
+        if (record.generation <= generation) {
+            continue;
+        }
+        bool merged = false;
+        for (Change &change : out.changes) {
+            if (change.section == record.change.section &&
+                change.index == record.change.index) {
+                change.mask |= record.change.mask;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            out.changes.push_back(record.change);
+        }
+    }
 }
 
 void PC::UpdateData() {
-    CollectUptime();
+    scheduler.RunAll();
+    Diagnostics::GetInstance().SampleProcessUsage();
+}
 
-    CollectDynamicCPUData();
+bool PC::StartReplay(double speed, std::string &error) {
+    InputTrace &trace = InputTrace::GetInstance();
+    if (!trace.IsReplaying()) {
+        error = "no input trace is open for replay";
+        return false;
+    }
+    if (!trace.PeekRun(replayFirstNs)) {
+        error = "input trace has no samples";
+        return false;
+    }
+    ResetRates();
+    replayStartNs = Scheduler::Now();
+    replayOffsetNs = replayStartNs - replayFirstNs;
+    replaySpeed = speed;
+    if (speed > 0) {
+        // Замеры трассы выполняются по мере наступления их времени;
+        // 10 мс - шаг, с которым темп воспроизведения держится ровным
+        scheduler.AddTask("Replay", 10000000ull, 10,
+                          [this](uint64_t nowNs) { ReplayDue(nowNs); });
+    }
+    return true;
+}
 
-    CollectDynamicRAMData();
+bool PC::IsReplaying() const { return InputTrace::GetInstance().IsReplaying(); }
 
-    CollectCommonNIsData();
+void PC::ResetRates() {
+    currentCPUUseIdle = 0;
+    currentCPUUseTotal = 0;
+    for (CPUTimes &times : coreTimes) {
+        times = CPUTimes{0, 0};
+    }
+    // Без времени прошлого замера скорости сети не считаются, а счётчики
+    // интерфейсов перезаписываются первым замером
+    lastRxBytes = 0;
+    lastTxBytes = 0;
+    lastTrafficTimeNs = 0;
+    power.ResetRate();
+}
+
+void PC::ReplayDue(uint64_t nowNs) {
+    InputTrace &trace = InputTrace::GetInstance();
+    double elapsedNs = static_cast<double>(nowNs - replayStartNs) * replaySpeed;
+    uint64_t timeNs;
+    while (trace.PeekRun(timeNs) && static_cast<double>(timeNs - replayFirstNs) <= elapsedNs) {
+        ReplayNext();
+    }
 }
 
-std::string PC::GetHostname() const { return this->hostname; }
-struct Uptime PC::GetUptime() const { return this->uptime; }
-std::vector<CPU> &PC::GetCPU() { return this->mainProcessors; }
-double PC::GetCPUUse() const { return this->totalCPUUse; }
-std::vector<RAM> &PC::GetRam() { return this->RAMDevices; }
-int PC::GetRAMVolume() const { return this->summaryRAMVolume; }
-int PC::GetUsedRAMVolume() const { return this->usedRAMVolume; }
-std::vector<NetworkInterface> &PC::GetNIs() { return this->NIs; }
-std::vector<std::string> &PC::GetDNS() { return this->DNS; }
+bool PC::ReplayNext() {
+    InputTrace &trace = InputTrace::GetInstance();
+    uint32_t collector;
+    uint64_t timeNs;
+    if (!trace.NextRun(collector, timeNs)) {
+        return false;
+    }
+    if (collector < collectors.size()) {
+        trace.BeginReplayRun();
+        RunCollector(collectors[collector], timeNs + replayOffsetNs);
+        trace.EndRun();
+    }
+    return true;
+}
+
+size_t PC::ReplayAll() {
+    // До готовности пробы CPU CollectDynamicCPUData пропускает замеры
+    WaitReady(Probe::CPU);
+    size_t count = 0;
+    while (ReplayNext()) {
+        ++count;
+    }
+    return count;
+}
+
+Scheduler &PC::GetScheduler() { return this->scheduler; }
+void PC::SetViewed(Collector collector, bool viewed) {
+    scheduler.SetViewed(tasks[static_cast<size_t>(collector)], viewed);
+}
+void PC::SetInterval(Collector collector, uint64_t intervalNs) {
+    scheduler.SetInterval(tasks[static_cast<size_t>(collector)], intervalNs);
+}
+uint64_t PC::GetSampleTime(Collector collector) const {
+    return scheduler.GetLastRun(tasks[static_cast<size_t>(collector)]);
+}
+uint64_t PC::GetSampleInterval(Collector collector) const {
+    return scheduler.GetLastElapsed(tasks[static_cast<size_t>(collector)]);
+}
+
+const Snapshot &PC::GetSnapshot() const { return this->snapshot; }
+std::string_view PC::GetHostname() const { return snapshot.hostname.View(); }
+struct Uptime PC::GetUptime() const { return snapshot.uptime; }
+View<CPU> PC::GetCPU() const { return snapshot.mainProcessors; }
+double PC::GetCPUUse() const { return snapshot.cpuUse; }
+View<RAM> PC::GetRam() const { return snapshot.RAMDevices; }
+uint64_t PC::GetRAMVolume() const { return snapshot.RAMVolume; }
+uint64_t PC::GetUsedRAMVolume() const { return snapshot.usedRAMVolume; }
+uint64_t PC::GetAvailableRAMVolume() const {
+    return snapshot.availableRAMVolume;
+}
+View<NetworkInterface> PC::GetNIs() const { return snapshot.NIs; }
+View<InternedString> PC::GetDNS() const { return snapshot.DNS; }
+View<InternedString> PC::GetGPU() const { return snapshot.GPU; }
+const History &PC::GetHistory(Series series) const {
+    return history[static_cast<size_t>(series)];
+}
+View<History> PC::GetCoreHistory() const { return coreHistory; }
+View<LogicalCPU> PC::GetLogicalCPUs() const { return logicalCPUs; }
+View<CacheLevel> PC::GetCaches() const { return topology.GetCaches(); }
+View<CoreCounters> PC::GetCoreCounters() const { return perfCounters.GetCounters(); }
+bool PC::HasHardwareCounters() const { return perfCounters.HasHardware(); }
+View<PowerDomain> PC::GetPowerDomains() const { return power.GetDomains(); }
+std::string_view PC::GetPerfError() const { return perfError; }
+uint64_t PC::GetTopologyVersion() const { return topologyVersion; }
+AlertEngine &PC::GetAlerts() { return alerts; }
+const SlidingQuantiles &PC::GetQuantiles(Series series) const {
+    return quantiles[static_cast<size_t>(series)];
+}
+View<SlidingQuantiles> PC::GetCoreQuantiles() const { return coreQuantiles; }
+View<InterfaceTraffic> PC::GetInterfaceTraffic() const { return interfaceTraffic; }
+View<InternedString> PC::GetNIControllers() const {
+    return snapshot.NIControllers;
+}
 } // namespace Devices
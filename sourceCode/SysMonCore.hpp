@@ -1,6 +1,22 @@
+#pragma once
+
+#include "AlertEngine.hpp"
+#include "CpuTemperatures.hpp"
+#include "CpuTopology.hpp"
+#include "PerfCounters.hpp"
+#include "RaplPower.hpp"
+#include "History.hpp"
+#include "QuantileSketch.hpp"
+#include "Scheduler.hpp"
+#include "StringPool.hpp"
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <future>
+#include <netinet/in.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Devices {
@@ -10,114 +26,357 @@ struct Uptime {
   int minutes = 0;
 };
 
+// Константное представление непрерывного массива записей без копирования
+// (аналог std::span для C++17). Действительно до следующего замера.
+template <typename T> class View {
+private:
+  const T *first = nullptr;
+  size_t count = 0;
+
+public:
+  View() = default;
+  View(const std::vector<T> &items) : first(items.data()), count(items.size()) {}
+
+  const T *begin() const { return first; }
+  const T *end() const { return first + count; }
+  const T &operator[](size_t index) const { return first[index]; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+};
+
 class PC;
+// Бит в масках изменений: запись добавлена/удалена или список
+// перестроен целиком - потребителю нужно перечитать весь раздел.
+constexpr uint32_t structureChanged = 1u << 31;
+
 class Device {
 protected:
-  std::string name;
+  InternedString name;
+  uint32_t dirty = 0;
 
 public:
-  Device();
-  Device(std::string name);
-  Device(const Device &other);
-  Device &operator=(const Device &other);
-  std::string GetName() const;
+  std::string_view GetName() const;
+  // Поля, изменившиеся при последнем обновлении этой записи.
+  uint32_t GetDirty() const;
   friend class PC;
 };
 
+// Записи устройств тривиально копируемы: числа в канонических единицах
+// (байты, МГц, миллиградусы), строки - интернированные индексы.
 class CPU : public Device {
+public:
+  enum Field : uint32_t {
+    Name = 1 << 0,
+    Socket = 1 << 1,
+    Cores = 1 << 2,
+    Threads = 1 << 3,
+    MaxSpeed = 1 << 4,
+    Temperature = 1 << 5,
+    Caches = 1 << 6,
+    Power = 1 << 7,
+  };
+
+  uint32_t Compare(const CPU &other) const;
+
 private:
-  size_t cores;
-  size_t threats;
-  std::string maxSpeed;
-  std::string socket;
-  std::string l1Cache;
-  std::string l2Cache;
-  std::string l3Cache;
-  int temperature;
+  InternedString socket;
+  uint32_t cores = 0;
+  uint32_t threads = 0;
+  uint32_t maxSpeedMHz = 0;
+  int32_t temperature = 0;
+  uint32_t powerMilliwatts = 0; // RAPL, домен пакета
+  uint64_t l1Cache = 0;
+  uint64_t l2Cache = 0;
+  uint64_t l3Cache = 0;
 
 public:
-  CPU();
-  CPU(const CPU &other);
-
-  size_t GetCores() const;
-  size_t GetThreats() const;
-  std::string GetMaxSpeed() const;
-  std::string GetSocket() const;
-  std::string GetL1Cache() const;
-  std::string GetL2Cache() const;
-  std::string GetL3Cache() const;
-  int GetTemperature() const;
+  uint32_t GetCores() const;
+  uint32_t GetThreads() const;
+  uint32_t GetMaxSpeedMHz() const;
+  std::string_view GetSocket() const;
+  // Размер одного экземпляра: L1 данных и L2 - на ядро, L3 - на группу
+  // ядер (CCX); сколько их всего - PC::GetCaches.
+  uint64_t GetL1Cache() const;
+  uint64_t GetL2Cache() const;
+  uint64_t GetL3Cache() const;
+  int32_t GetTemperature() const; // миллиградусы Цельсия
+  uint32_t GetPowerMilliwatts() const; // 0 - RAPL недоступен
   friend class PC;
 };
 
 class RAM : public Device {
+public:
+  enum Field : uint32_t {
+    Name = 1 << 0,
+    Size = 1 << 1,
+    FormFactor = 1 << 2,
+    Type = 1 << 3,
+    Manufacturer = 1 << 4,
+    Speed = 1 << 5,
+    Channel = 1 << 6,
+    Rank = 1 << 7,
+  };
+
+  uint32_t Compare(const RAM &other) const;
+
 private:
-  std::string size;
-  std::string formFactor;
-  std::string type;
-  std::string manufacturer;
-  std::string speed;
-  std::string channel;
-  int rank;
+  InternedString formFactor;
+  InternedString type;
+  InternedString manufacturer;
+  InternedString channel;
+  uint64_t size = 0;
+  uint32_t speed = 0;
+  uint32_t rank = 0;
 
 public:
-  RAM();
-  RAM(const RAM &other);
-
-  std::string GetSize() const;
-  std::string GetFormFactor() const;
-  std::string GetType() const;
-  std::string GetManufacturer() const;
-  std::string GetSpeed() const;
-  std::string GetChannel() const;
-  int GetRank() const;
+  uint64_t GetSize() const;  // байты
+  std::string_view GetFormFactor() const;
+  std::string_view GetType() const;
+  std::string_view GetManufacturer() const;
+  uint32_t GetSpeed() const; // MT/s
+  std::string_view GetChannel() const;
+  uint32_t GetRank() const;
 
   friend class PC;
 };
 
 class NetworkInterface : public Device {
+public:
+  enum Flags : uint8_t {
+    HasIpv4 = 1 << 0,
+    HasIpv6 = 1 << 1,
+    HasMac = 1 << 2,
+    HasGateway = 1 << 3,
+  };
+
+  enum Field : uint32_t {
+    Name = 1 << 0,
+    Ipv4 = 1 << 1,
+    Ipv6 = 1 << 2,
+    Ipv4Netmask = 1 << 3,
+    Ipv6Netmask = 1 << 4,
+    Mac = 1 << 5,
+    Gateway = 1 << 6,
+  };
+
+  uint32_t Compare(const NetworkInterface &other) const;
+
 private:
-  std::string ipv4;
-  std::string ipv6;
-  std::string ipv4Netmask;
-  std::string ipv6Netmask;
-  std::string mac;
-  std::string gateway;
+  in_addr ipv4{};
+  in_addr ipv4Netmask{};
+  in_addr gateway{};
+  in6_addr ipv6{};
+  in6_addr ipv6Netmask{};
+  std::array<uint8_t, 6> mac{};
+  uint8_t flags = 0;
+  bool seen = false;
 
 public:
-  NetworkInterface();
-  NetworkInterface(const NetworkInterface &other);
-
-  std::string GetIpv4() const;
-  std::string GetIpv6() const;
-  std::string GetIpv4Netmask() const;
-  std::string GetIpv6Netmask() const;
-  std::string GetMac() const;
-  std::string GatGateway() const;
+  uint8_t GetFlags() const;
+  const in_addr &GetIpv4() const;
+  const in6_addr &GetIpv6() const;
+  const in_addr &GetIpv4Netmask() const;
+  const in6_addr &GetIpv6Netmask() const;
+  const std::array<uint8_t, 6> &GetMac() const;
+  const in_addr &GetGateway() const;
   friend class PC;
 };
 
+// Логический процессор (cpuN): место в топологии и текущие показатели.
+// Обновляется каждым замером, поэтому живёт вне снимка и журнала
+// изменений - иначе 512 потоков заполняли бы журнал за несколько тиков.
+struct LogicalCPU {
+  uint32_t id = 0;
+  int32_t package = -1;
+  int32_t die = -1;
+  int32_t node = -1; // NUMA
+  int32_t core = -1;
+  int32_t llc = -1; // первый процессор группы с общим последним кэшем
+  bool online = false;
+  float use = 0; // проценты
+  uint32_t frequencyMHz = 0;
+  uint32_t minFrequencyMHz = 0;
+  uint32_t maxFrequencyMHz = 0;
+  InternedString governor;
+  int32_t temperature = 0; // миллиградусы Цельсия
+  float ipc = 0; // 0 - нет аппаратных счётчиков
+  // Доля интервала, когда аппаратные счётчики стояли на PMU (худшая из
+  // групп); меньше 1 - мультиплексирование, 0 - не измерены.
+  float pmuRunning = 0;
+};
+
+// Трафик одного интерфейса по /proc/net/dev: счётчики и скорости
+// последнего замера, квантили скоростей за скользящие окна.
+struct InterfaceTraffic {
+  InternedString name;
+  uint64_t rxBytes = 0;
+  uint64_t txBytes = 0;
+  float rxRate = 0; // байты/с
+  float txRate = 0;
+  bool seen = false;
+  SlidingQuantiles rxQuantiles;
+  SlidingQuantiles txQuantiles;
+};
+
+struct Snapshot {
+  enum class Section : uint8_t { System, CPU, RAM, NetworkInterfaces, DNS, PCI, Count };
+  // Поля раздела System (одна запись с индексом 0).
+  enum Field : uint32_t {
+    HostnameField = 1 << 0,
+    UptimeField = 1 << 1,
+    CPUUseField = 1 << 2,
+    RAMVolumeField = 1 << 3,
+    UsedRAMVolumeField = 1 << 4,
+    AvailableRAMVolumeField = 1 << 5,
+  };
+
+  // Растёт при каждой публикации изменений, никогда не сбрасывается.
+  uint64_t generation = 0;
+  InternedString hostname;
+  Uptime uptime;
+  double cpuUse = 0; // проценты
+  uint64_t RAMVolume = 0;
+  uint64_t usedRAMVolume = 0;
+  uint64_t availableRAMVolume = 0; // MemAvailable - с учётом кэшей
+
+  std::vector<CPU> mainProcessors;
+  std::vector<RAM> RAMDevices;
+  std::vector<NetworkInterface> NIs;
+  std::vector<InternedString> DNS;
+  std::vector<InternedString> GPU;
+  std::vector<InternedString> NIControllers;
+};
+
+struct Change {
+  Snapshot::Section section;
+  uint32_t index; // UINT32_MAX вместе с structureChanged - весь раздел
+  uint32_t mask;
+};
+
+// Изменения с заданного поколения, объединённые по записям. full - журнал
+// уже не покрывает запрошенное поколение, перечитать нужно всё.
+struct ChangeSet {
+  uint64_t generation = 0;
+  bool full = false;
+  std::vector<Change> changes;
+
+  bool Has(Snapshot::Section section) const;
+  uint32_t GetMask(Snapshot::Section section, uint32_t index) const;
+  bool IsStructureChanged(Snapshot::Section section) const;
+};
+
+// Форматирование для вывода; вызывается потребителями только при показе.
+std::string FormatBytes(uint64_t bytes);
+std::string FormatIpv4(const in_addr &address);
+std::string FormatIpv6(const in6_addr &address);
+std::string FormatMac(const std::array<uint8_t, 6> &mac);
+
 class PC {
+public:
+  enum class Collector {
+    Uptime,
+    CPU,
+    RAM,
+    NetworkAddresses,
+    NetworkLinks,
+    DNS,
+    PCI,
+    NetworkTraffic,
+    CoreFrequency,
+    PerfCounters,
+    Count
+  };
+
+  // Ряды истории для графиков и метрики правил оповещений: проценты,
+  // байты/с, градусы Цельсия, ватты.
+  enum class Series {
+    CPU,
+    Memory,
+    NetworkRx,
+    NetworkTx,
+    Temperature,
+    MemoryAvailable,
+    PackagePower,
+    Count
+  };
+  // Имя ряда как метрики правил и ключа в кадрах агента: cpu, memory,
+  // net_rx, net_tx, temperature, mem_available, power.
+  static const char *GetSeriesName(Series series);
+  // Самое длинное окно графиков (6 ч) при самой частой выборке (10 Гц).
+  static constexpr size_t seriesCapacity = 6 * 3600 * 10;
+  // Ряды ядер ограничены общим объёмом на машину: на 512 процессорах
+  // у ядра меньше точек истории и корзин квантилей, чем на восьми.
+  static constexpr size_t coreHistoryCapacity = 1 << 15;
+  static constexpr size_t coreHistoryBudget = 1 << 21;     // точек, 16 МиБ
+
+  // Статические пробы инвентаря, выполняемые параллельно при старте.
+  enum class Probe { Hostname, CPU, RAM, PCI, Count };
+
 private:
   PC();
+  ~PC();
 
-  std::string hostname;
-  Uptime uptime;
+  std::array<std::shared_future<void>, static_cast<size_t>(Probe::Count)>
+      probes;
+  int probeFd;
+  void StartProbe(Probe probe, const char *name, void (PC::*collect)());
 
-  std::vector<CPU> mainProcessors;
+  Scheduler scheduler;
+  std::array<Scheduler::TaskId, static_cast<size_t>(Collector::Count)> tasks;
+
+  Snapshot snapshot;
+  Snapshot previous;
+  struct ChangeRecord {
+    uint64_t generation;
+    Change change;
+  };
+  static constexpr size_t changeLogCapacity = 4096;
+  std::vector<ChangeRecord> changeLog;
+  size_t changeLogHead;
+  uint64_t firstLoggedGeneration;
+  std::array<bool, static_cast<size_t>(Probe::Count)> probePublished;
   static long long currentCPUUseIdle;
   static long long currentCPUUseTotal;
-  double totalCPUUse;
 
-  std::vector<RAM> RAMDevices;
-  int summaryRAMVolume;
-  int usedRAMVolume;
-
-  std::vector<NetworkInterface> NIs;
-  std::vector<std::string> DNS;
-
-  std::vector<std::string> GPU;
-  std::vector<std::string> NIControllers;
+  // Монотонное время замера, который сейчас выполняет RunCollector.
+  uint64_t sampleTimeNs;
+  std::array<History, static_cast<size_t>(Series::Count)> history;
+  struct CPUTimes {
+    long long idle;
+    long long total;
+  };
+  std::vector<CPUTimes> coreTimes;
+  std::vector<History> coreHistory;
+  // Квантили за 1 мин / 1 ч / 24 ч по каждому ряду и ядру.
+  std::array<SlidingQuantiles, static_cast<size_t>(Series::Count)> quantiles;
+  std::vector<SlidingQuantiles> coreQuantiles;
+  std::vector<InterfaceTraffic> interfaceTraffic;
+  // Буфер под /proc/stat и /proc/net/dev: строки на каждое ядро и
+  // интерфейс не помещаются в стек на больших машинах.
+  std::vector<char> procBuffer;
+  uint64_t lastRxBytes;
+  uint64_t lastTxBytes;
+  uint64_t lastTrafficTimeNs;
+  std::vector<LogicalCPU> logicalCPUs;
+  CpuTopology topology;
+  CpuTemperatures temperatures;
+  uint64_t topologyVersion;
+  RaplPower power;
+  PerfCounters perfCounters;
+  uint64_t perfTopologyVersion; // топология, под которую открыты группы
+  std::string perfError;
+  AlertEngine alerts;
+  void LoadAlertRules();
+  // Воспроизведение трассы входов: время замера трассы + offset -
+  // время замера здесь, так что интервалы и скорости - записанные.
+  uint64_t replayStartNs;
+  uint64_t replayFirstNs;
+  uint64_t replayOffsetNs;
+  double replaySpeed;
+  void ReplayDue(uint64_t nowNs);
+  // Забывает счётчики прошлых замеров: первая разность трассы не должна
+  // смешиваться с состоянием другого источника.
+  void ResetRates();
 
   void CollectHostname();
   void CollectStaticCPUData();
@@ -127,7 +386,28 @@ private:
   void CollectUptime();
   void CollectDynamicCPUData();
   void CollectDynamicRAMData();
-  void CollectCommonNIsData();
+  void CollectNIAddresses();
+  void CollectNILinks();
+  void CollectDNS();
+  void CollectNITraffic();
+  void CollectCoreFrequencies();
+  void CollectPerfCounters();
+  // Пакет, ядро, NUMA-узел, кэши, пределы частоты и датчик температуры
+  // каждого cpuN из sysfs; вызывается, когда /proc/stat показал новый процессор или
+  // изменился список включённых.
+  void LoadTopology();
+
+  // Сборщики по номеру Collector: им адресуются замеры трассы входов.
+  using Collect = void (PC::*)();
+  static const std::array<Collect, static_cast<size_t>(Collector::Count)> collectors;
+  // Запускает сборщик и публикует отличия от предыдущего состояния
+  // как новое поколение снимка.
+  void RunCollector(Collect collect, uint64_t nowNs);
+  void PushHistory(Series series, float value);
+  void LogChange(Snapshot::Section section, uint32_t index, uint32_t mask);
+  template <typename T>
+  void DiffRecords(Snapshot::Section section, std::vector<T> &current,
+                   const std::vector<T> &old);
 
 public:
   PC(const PC &) = delete;
@@ -137,18 +417,88 @@ public:
     return currentPC;
   }
 
+  // Немедленно опрашивает все сборщики; в штатном режиме их вызывает
+  // планировщик по своим интервалам.
   void UpdateData();
 
-  std::string GetHostname() const;
+  // Готовность статических данных; до неё соответствующие геттеры
+  // возвращают пустые значения.
+  bool IsReady(Probe probe) const;
+  void WaitReady(Probe probe) const;
+  // eventfd, срабатывающий по завершении каждой пробы.
+  int GetProbeFd() const;
+
+  Scheduler &GetScheduler();
+  void SetViewed(Collector collector, bool viewed);
+  // Базовый интервал сборщика; для графиков - до 100 мс (10 Гц).
+  void SetInterval(Collector collector, uint64_t intervalNs);
+  // Монотонное время последнего замера и фактический интервал до
+  // предыдущего - для пересчёта скоростей без учёта джиттера таймера.
+  uint64_t GetSampleTime(Collector collector) const;
+  uint64_t GetSampleInterval(Collector collector) const;
+
+  // Публикует как изменения завершившиеся статические пробы; вызывается
+  // сборщиками автоматически и потребителем по сигналу GetProbeFd().
+  void PollProbes();
+  uint64_t GetGeneration() const;
+  // Заполняет out изменениями после поколения generation (capacity
+  // вектора переиспользуется между вызовами).
+  void ChangedSince(uint64_t generation, ChangeSet &out) const;
+
+  const Snapshot &GetSnapshot() const;
+  std::string_view GetHostname() const;
   struct Uptime GetUptime() const;
-  std::vector<CPU> &GetCPU();
+  View<CPU> GetCPU() const;
   double GetCPUUse() const;
-  std::vector<RAM> &GetRam();
-  int GetRAMVolume() const;
-  int GetUsedRAMVolume() const;
-  std::vector<NetworkInterface> &GetNIs();
-  std::vector<std::string> &GetDNS();
-  std::vector<std::string> &GetGPU();
-  std::vector<std::string> &GetNIControllers();
+  View<RAM> GetRam() const;
+  uint64_t GetRAMVolume() const;     // байты
+  uint64_t GetUsedRAMVolume() const; // байты
+  uint64_t GetAvailableRAMVolume() const; // байты
+  View<NetworkInterface> GetNIs() const;
+  View<InternedString> GetDNS() const;
+  View<InternedString> GetGPU() const;
+  View<InternedString> GetNIControllers() const;
+
+  // История обновляется сборщиками в потоке планировщика и читается
+  // оттуда же, синхронизация не нужна.
+  const History &GetHistory(Series series) const;
+  // Загрузка каждого логического процессора (cpuN из /proc/stat).
+  View<History> GetCoreHistory() const;
+  // Индекс совпадает с N в cpuN; выключенные процессоры остаются в
+  // списке с online == false.
+  View<LogicalCPU> GetLogicalCPUs() const;
+  // Меняется при изменении состава или топологии процессоров.
+  uint64_t GetTopologyVersion() const;
+  // Иерархия кэшей по sysfs: размер одного экземпляра и их число.
+  View<CacheLevel> GetCaches() const;
+  // Счётчики perf по каждому cpuN; пусто, если perf_event_open
+  // недоступен - причина в GetPerfError.
+  View<CoreCounters> GetCoreCounters() const;
+  bool HasHardwareCounters() const;
+  // Домены RAPL с мощностью последнего замера CPU; пусто без RAPL.
+  View<PowerDomain> GetPowerDomains() const;
+  std::string_view GetPerfError() const;
+
+  // Каждый ряд истории - метрика правил под именем GetSeriesName.
+  AlertEngine &GetAlerts();
+
+  // Воспроизведение трассы сырых входов (InputTrace) вместо живых
+  // замеров: разбор, скорости, история и оповещения те же, что на
+  // исходной машине. Трасса открывается InputTrace::OpenReplay до
+  // создания PC, так что живые замеры не выполняются ни разу. speed -
+  // множитель темпа (1 - как записано), при 0 замеры выполняет только
+  // ReplayAll.
+  bool StartReplay(double speed, std::string &error);
+  bool IsReplaying() const;
+  // Выполняет следующий замер трассы; false - трасса кончилась.
+  bool ReplayNext();
+  // Все оставшиеся замеры подряд без пауз; возвращает их число.
+  size_t ReplayAll();
+
+  // Скетчи сливаются (SlidingQuantiles::MergeInto), поэтому процентили
+  // по всем ядрам или интерфейсам считаются без сырых замеров.
+  const SlidingQuantiles &GetQuantiles(Series series) const;
+  View<SlidingQuantiles> GetCoreQuantiles() const;
+  View<InterfaceTraffic> GetInterfaceTraffic() const;
 };
 } // namespace Devices
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Diagnostics.hpp"
+#include "History.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Devices {
+// Задержка пробуждения по образцу cyclictest: на каждом выбранном CPU
+// закреплённый поток спит до абсолютного срока (clock_nanosleep с
+// TIMER_ABSTIME) и пишет в гистограмму, насколько позже срока он
+// проснулся. С priority > 0 потоки работают в SCHED_FIFO и меряют
+// задержку планировщика для realtime-задач; без прав на это остаётся
+// обычный планировщик, что видно по IsRealtime.
+class WakeupLatencyProbe {
+public:
+  struct Options {
+    // Пусто - все процессоры, доступные процессу.
+    std::vector<unsigned> cpus;
+    uint64_t intervalNs = 1000000;
+    int priority = 0; // приоритет SCHED_FIFO, 0 - SCHED_OTHER
+  };
+
+  static constexpr size_t historyCapacity = 1 << 15;
+
+  WakeupLatencyProbe() = default;
+  ~WakeupLatencyProbe();
+  WakeupLatencyProbe(const WakeupLatencyProbe &) = delete;
+  WakeupLatencyProbe &operator=(const WakeupLatencyProbe &) = delete;
+
+  bool Start(const Options &options, std::string &error);
+  void Stop();
+  bool IsRunning() const;
+  // false, если хотя бы одному потоку не удалось получить SCHED_FIFO.
+  bool IsRealtime() const;
+
+  // Потоки последнего запуска; гистограммы и кривые остаются после Stop.
+  size_t GetCpuCount() const;
+  unsigned GetCpu(size_t index) const;
+  // 0 или код ошибки pthread_setaffinity_np: поток не закреплён, и его
+  // задержка не относится к GetCpu.
+  int GetAffinityError(size_t index) const;
+  // 0 или код ошибки clock_nanosleep, на которой поток остановился.
+  int GetSleepError(size_t index) const;
+  const LatencyHistogram &GetHistogram(size_t index) const;
+  // Максимальная задержка между соседними Sample, микросекунды.
+  const History &GetHistory(size_t index) const;
+
+  // Вызывается владельцем на каждом замере: переносит максимум
+  // задержки за прошедший интервал в кривую каждого CPU, чтобы всплески
+  // сопоставлялись по времени с нагрузкой и температурой.
+  void Sample(uint64_t nowNs);
+
+private:
+  struct Worker {
+    unsigned cpu = 0;
+    std::thread thread;
+    LatencyHistogram histogram;
+    std::atomic<uint64_t> intervalMax{0};
+    std::atomic<int> affinityError{0};
+    std::atomic<int> sleepError{0};
+    History history{historyCapacity};
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> running{false};
+  std::atomic<unsigned> realtimeFailures{0};
+  bool realtimeRequested = false;
+
+  static void Run(Worker &worker, uint64_t intervalNs, int priority,
+                  const std::atomic<bool> &stop, std::atomic<unsigned> &realtimeFailures);
+};
+} // namespace Devices
@@ -0,0 +1,200 @@
+#include "chartwidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int leftMargin = 56;
+const int topMargin = 18;
+const int bottomMargin = 4;
+const int rightMargin = 4;
+
+// Верхняя граница шкалы: ближайшее сверху 1, 2 или 5 * 10^n.
+double niceCeiling(double value)
+{
+    if (value <= 0) {
+        return 1;
+    }
+    double magnitude = std::pow(10.0, std::floor(std::log10(value)));
+    for (double step : {1.0, 2.0, 5.0, 10.0}) {
+        if (value <= step * magnitude) {
+            return step * magnitude;
+        }
+    }
+    return 10 * magnitude;
+}
+}
+
+ChartWidget::ChartWidget(const QString& title, QWidget* parent)
+    : QWidget(parent)
+    , title(title)
+    , formatter([](double value) { return QString::number(value, 'f', 0); })
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(100);
+}
+
+void ChartWidget::addSeries(const Devices::History* history, const QColor& color)
+{
+    series.append({history, color, 0});
+    cacheValid = false;
+}
+
+void ChartWidget::clearSeries()
+{
+    series.clear();
+    cacheValid = false;
+}
+
+int ChartWidget::seriesCount() const
+{
+    return series.size();
+}
+
+void ChartWidget::setRange(double minimum, double maximum)
+{
+    this->minimum = minimum;
+    this->maximum = maximum;
+    cacheValid = false;
+}
+
+void ChartWidget::setFormatter(Formatter formatter)
+{
+    this->formatter = std::move(formatter);
+    cacheValid = false;
+}
+
+void ChartWidget::setWindow(uint64_t windowNs)
+{
+    if (this->windowNs != windowNs) {
+        this->windowNs = windowNs;
+        cacheValid = false;
+    }
+}
+
+void ChartWidget::refresh(uint64_t nowNs)
+{
+    bool changed = !cacheValid;
+    for (const Series& line : series) {
+        changed = changed || line.history->GetPushCount() != line.drawnPushes;
+    }
+    if (changed && isVisible()) {
+        render(nowNs);
+        update();
+    }
+}
+
+void ChartWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    cacheValid = false;
+}
+
+void ChartWidget::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    if (cache.isNull()) {
+        painter.fillRect(event->rect(), palette().base());
+        return;
+    }
+    painter.drawPixmap(0, 0, cache);
+}
+
+void ChartWidget::render(uint64_t nowNs)
+{
+    const qreal ratio = devicePixelRatioF();
+    const QSize pixels = size() * ratio;
+    if (cache.size() != pixels) {
+        cache = QPixmap(pixels);
+        cache.setDevicePixelRatio(ratio);
+    }
+    cache.fill(palette().base().color());
+
+    QRect plot = rect().adjusted(leftMargin, topMargin, -rightMargin, -bottomMargin);
+    const int columns = std::max(1, plot.width());
+    const uint64_t toNs = nowNs + 1;
+    const uint64_t fromNs = toNs > windowNs ? toNs - windowNs : 0;
+
+    // Сначала прореживание всех рядов: по нему же подбирается автошкала
+    if (buckets.size() < static_cast<size_t>(series.size())) {
+        buckets.resize(series.size());
+    }
+    double top = maximum;
+    double latest = 0;
+    for (int i = 0; i < series.size(); ++i) {
+        std::vector<Devices::History::Bucket>& columnsOut = buckets[i];
+        columnsOut.resize(columns);
+        series[i].history->Decimate(fromNs, toNs, columnsOut);
+        series[i].drawnPushes = series[i].history->GetPushCount();
+        if (maximum <= 0) {
+            for (const Devices::History::Bucket& bucket : columnsOut) {
+                if (bucket.valid) {
+                    top = std::max(top, static_cast<double>(bucket.max));
+                }
+            }
+        }
+        if (i == 0) {
+            latest = series[i].history->GetLatest();
+        }
+    }
+    if (maximum <= 0) {
+        top = niceCeiling(top);
+    }
+    const double span = std::max(1e-9, top - minimum);
+    auto toY = [&](float value) {
+        double clamped = std::min(std::max(static_cast<double>(value), minimum), top);
+        return plot.bottom() - (clamped - minimum) / span * plot.height();
+    };
+
+    QPainter painter(&cache);
+    painter.setPen(palette().mid().color());
+    painter.drawRect(plot);
+    for (int step = 1; step < 4; ++step) {
+        int y = plot.top() + plot.height() * step / 4;
+        painter.drawLine(plot.left(), y, plot.right(), y);
+    }
+
+    painter.setPen(palette().text().color());
+    QRect labels(0, plot.top() - 6, leftMargin - 4, plot.height() + 12);
+    painter.drawText(labels, Qt::AlignRight | Qt::AlignTop, formatter(top));
+    painter.drawText(labels, Qt::AlignRight | Qt::AlignBottom, formatter(minimum));
+    QString caption = title;
+    if (!series.isEmpty() && !series.first().history->IsEmpty()) {
+        caption += "   " + formatter(latest);
+    }
+    painter.drawText(QRect(leftMargin, 0, width() - leftMargin, topMargin),
+                     Qt::AlignLeft | Qt::AlignVCenter, caption);
+
+    // На столбец - вертикаль min..max и отрезок от предыдущего столбца,
+    // всё одним вызовом drawLines на ряд
+    painter.setClipRect(plot);
+    for (int i = 0; i < series.size(); ++i) {
+        const std::vector<Devices::History::Bucket>& columnsOut = buckets[i];
+        segments.clear();
+        bool hasPrevious = false;
+        QPointF previous;
+        for (int x = 0; x < columns; ++x) {
+            const Devices::History::Bucket& bucket = columnsOut[x];
+            if (!bucket.valid) {
+                continue;
+            }
+            qreal px = plot.left() + x + 0.5;
+            qreal yMin = toY(bucket.min);
+            qreal yMax = toY(bucket.max);
+            QPointF middle(px, (yMin + yMax) / 2);
+            if (hasPrevious) {
+                segments.append(QLineF(previous, middle));
+            }
+            if (yMin != yMax) {
+                segments.append(QLineF(px, yMin, px, yMax));
+            }
+            previous = middle;
+            hasPrevious = true;
+        }
+        painter.setPen(QPen(series[i].color, 1));
+        painter.drawLines(segments);
+    }
+    cacheValid = true;
+}
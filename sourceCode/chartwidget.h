@@ -0,0 +1,65 @@
+#ifndef CHARTWIDGET_H
+#define CHARTWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QVector>
+#include <QLineF>
+#include <functional>
+#include <vector>
+#include "History.hpp"
+
+// Прокручиваемый график одного или нескольких рядов истории ядра.
+// Каждый ряд прореживается до min/max на столбец пикселей, поэтому
+// стоимость кадра не зависит от длины истории сверх одного линейного
+// прохода. Картинка кэшируется в QPixmap и перестраивается только при
+// новых замерах, смене окна или размера; paintEvent лишь копирует её.
+class ChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    using Formatter = std::function<QString(double)>;
+
+    explicit ChartWidget(const QString& title, QWidget* parent = nullptr);
+
+    void addSeries(const Devices::History* history, const QColor& color);
+    void clearSeries();
+    int seriesCount() const;
+
+    // Фиксированная шкала (например 0..100%); при maximum <= 0 верхняя
+    // граница подбирается по видимым данным.
+    void setRange(double minimum, double maximum);
+    void setFormatter(Formatter formatter);
+    void setWindow(uint64_t windowNs);
+
+    // Перестраивает кэш, если с прошлого кадра что-то изменилось.
+    void refresh(uint64_t nowNs);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    struct Series {
+        const Devices::History* history;
+        QColor color;
+        uint64_t drawnPushes;
+    };
+
+    QString title;
+    QVector<Series> series;
+    double minimum = 0;
+    double maximum = 0;
+    Formatter formatter;
+    uint64_t windowNs = 60ull * 1000000000ull;
+
+    QPixmap cache;
+    bool cacheValid = false;
+    std::vector<std::vector<Devices::History::Bucket>> buckets;
+    QVector<QLineF> segments;
+
+    void render(uint64_t nowNs);
+};
+
+#endif // CHARTWIDGET_H
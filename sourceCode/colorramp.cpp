@@ -0,0 +1,25 @@
+#include "colorramp.h"
+#include <QColor>
+#include <algorithm>
+#include <array>
+
+const QRgb* colorRamp()
+{
+    static const std::array<QRgb, 256> colors = [] {
+        const QColor stops[] = {QColor(0x20, 0x30, 0x90), QColor(0x20, 0xa0, 0x50),
+                                QColor(0xf0, 0xd0, 0x20), QColor(0xd0, 0x20, 0x20)};
+        std::array<QRgb, 256> ramp;
+        for (int i = 0; i < 256; ++i) {
+            double position = i / 255.0 * 3;
+            int stop = std::min(2, static_cast<int>(position));
+            double t = position - stop;
+            const QColor& from = stops[stop];
+            const QColor& to = stops[stop + 1];
+            ramp[i] = qRgb(static_cast<int>(from.red() + (to.red() - from.red()) * t),
+                           static_cast<int>(from.green() + (to.green() - from.green()) * t),
+                           static_cast<int>(from.blue() + (to.blue() - from.blue()) * t));
+        }
+        return ramp;
+    }();
+    return colors.data();
+}
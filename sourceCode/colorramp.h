@@ -0,0 +1,11 @@
+#ifndef COLORRAMP_H
+#define COLORRAMP_H
+
+#include <QRgb>
+
+// Шкала синий - зелёный - жёлтый - красный из 256 цветов для тепловой
+// карты и матрицы задержек: индекс 0 - минимум, 255 - максимум.
+// Считается один раз на процесс.
+const QRgb* colorRamp();
+
+#endif // COLORRAMP_H
@@ -0,0 +1,211 @@
+#include "devicemodels.h"
+
+namespace {
+QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+QString bytesOrDash(uint64_t bytes)
+{
+    return bytes == 0 ? QString("-") : QString::fromStdString(Devices::FormatBytes(bytes));
+}
+}
+
+RecordTableModel::RecordTableModel(Devices::PC& systemMonitor,
+                                   Devices::Snapshot::Section section, QObject* parent)
+    : QAbstractTableModel(parent)
+    , systemMonitor(systemMonitor)
+    , section(section)
+{
+}
+
+int RecordTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int RecordTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(columns.size());
+}
+
+QVariant RecordTableModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= rows) {
+        return QVariant();
+    }
+    return cell(index.row(), index.column());
+}
+
+QVariant RecordTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return section < static_cast<int>(columns.size()) ? QVariant(columns[section].title) : QVariant();
+    }
+    return section + 1;
+}
+
+void RecordTableModel::refresh(const Devices::ChangeSet& changes)
+{
+    if (!changes.Has(section)) {
+        return;
+    }
+
+    // Появилось или пропало оборудование - меняем только число строк
+    int records = recordCount();
+    if (records > rows) {
+        beginInsertRows(QModelIndex(), rows, records - 1);
+        rows = records;
+        endInsertRows();
+    } else if (records < rows) {
+        beginRemoveRows(QModelIndex(), records, rows - 1);
+        rows = records;
+        endRemoveRows();
+    }
+    if (rows == 0) {
+        return;
+    }
+
+    if (changes.full || changes.IsStructureChanged(section)) {
+        emit dataChanged(index(0, 0), index(rows - 1, static_cast<int>(columns.size()) - 1));
+        return;
+    }
+
+    // Остальное - точечно, по маскам изменившихся полей
+    for (const Devices::Change& change : changes.changes) {
+        if (change.section != section || change.index >= static_cast<uint32_t>(rows)) {
+            continue;
+        }
+        int row = static_cast<int>(change.index);
+        for (int column = 0; column < static_cast<int>(columns.size()); ++column) {
+            if (change.mask & columns[column].mask) {
+                emit dataChanged(index(row, column), index(row, column));
+            }
+        }
+    }
+}
+
+CpuTableModel::CpuTableModel(Devices::PC& systemMonitor, QObject* parent)
+    : RecordTableModel(systemMonitor, Devices::Snapshot::Section::CPU, parent)
+{
+    using Field = Devices::CPU::Field;
+    columns = {{"Name", Field::Name},
+               {"Socket", Field::Socket},
+               {"Cores", Field::Cores},
+               {"Threads", Field::Threads},
+               {"Max Speed", Field::MaxSpeed},
+               {"L1 Cache", Field::Caches},
+               {"L2 Cache", Field::Caches},
+               {"L3 Cache", Field::Caches},
+               {"Temperature", Field::Temperature},
+               {"Power", Field::Power}};
+}
+
+int CpuTableModel::recordCount() const
+{
+    if (!systemMonitor.IsReady(Devices::PC::Probe::CPU)) {
+        return 0;
+    }
+    return static_cast<int>(systemMonitor.GetCPU().size());
+}
+
+QString CpuTableModel::cell(int row, int column) const
+{
+    const Devices::CPU& cpu = systemMonitor.GetCPU()[row];
+    switch (column) {
+    case 0: return toQString(cpu.GetName());
+    case 1: return toQString(cpu.GetSocket());
+    case 2: return QString::number(cpu.GetCores());
+    case 3: return QString::number(cpu.GetThreads());
+    case 4: return cpu.GetMaxSpeedMHz() == 0 ? QString("-") : QString("%1 MHz").arg(cpu.GetMaxSpeedMHz());
+    case 5: return bytesOrDash(cpu.GetL1Cache());
+    case 6: return bytesOrDash(cpu.GetL2Cache());
+    case 7: return bytesOrDash(cpu.GetL3Cache());
+    case 8: return QString("%1°C").arg(cpu.GetTemperature() / 1000.0, 0, 'f', 1);
+    case 9: return cpu.GetPowerMilliwatts() == 0 ? QString("-")
+                                                 : QString("%1 W").arg(cpu.GetPowerMilliwatts() / 1000.0, 0, 'f', 1);
+    }
+    return QString();
+}
+
+RamTableModel::RamTableModel(Devices::PC& systemMonitor, QObject* parent)
+    : RecordTableModel(systemMonitor, Devices::Snapshot::Section::RAM, parent)
+{
+    using Field = Devices::RAM::Field;
+    columns = {{"Name", Field::Name},
+               {"Size", Field::Size},
+               {"Type", Field::Type},
+               {"Speed", Field::Speed},
+               {"Manufacturer", Field::Manufacturer},
+               {"Form Factor", Field::FormFactor},
+               {"Channel", Field::Channel},
+               {"Rank", Field::Rank}};
+}
+
+int RamTableModel::recordCount() const
+{
+    if (!systemMonitor.IsReady(Devices::PC::Probe::RAM)) {
+        return 0;
+    }
+    return static_cast<int>(systemMonitor.GetRam().size());
+}
+
+QString RamTableModel::cell(int row, int column) const
+{
+    const Devices::RAM& ram = systemMonitor.GetRam()[row];
+    switch (column) {
+    case 0: return toQString(ram.GetName());
+    case 1: return bytesOrDash(ram.GetSize());
+    case 2: return toQString(ram.GetType());
+    case 3: return ram.GetSpeed() == 0 ? QString("-") : QString("%1 MT/s").arg(ram.GetSpeed());
+    case 4: return toQString(ram.GetManufacturer());
+    case 5: return toQString(ram.GetFormFactor());
+    case 6: return toQString(ram.GetChannel());
+    case 7: return QString::number(ram.GetRank());
+    }
+    return QString();
+}
+
+NetworkTableModel::NetworkTableModel(Devices::PC& systemMonitor, QObject* parent)
+    : RecordTableModel(systemMonitor, Devices::Snapshot::Section::NetworkInterfaces, parent)
+{
+    using Field = Devices::NetworkInterface::Field;
+    columns = {{"Interface Name", Field::Name},
+               {"IPv4", Field::Ipv4},
+               {"IPv4 Netmask", Field::Ipv4Netmask},
+               {"IPv6", Field::Ipv6},
+               {"IPv6 Netmask", Field::Ipv6Netmask},
+               {"MAC Address", Field::Mac},
+               {"Gateway", Field::Gateway}};
+}
+
+int NetworkTableModel::recordCount() const
+{
+    return static_cast<int>(systemMonitor.GetNIs().size());
+}
+
+QString NetworkTableModel::cell(int row, int column) const
+{
+    using Flags = Devices::NetworkInterface::Flags;
+    const Devices::NetworkInterface& net = systemMonitor.GetNIs()[row];
+    bool hasIpv4 = net.GetFlags() & Flags::HasIpv4;
+    bool hasIpv6 = net.GetFlags() & Flags::HasIpv6;
+    switch (column) {
+    case 0: return toQString(net.GetName());
+    case 1: return hasIpv4 ? QString::fromStdString(Devices::FormatIpv4(net.GetIpv4())) : "-";
+    case 2: return hasIpv4 ? QString::fromStdString(Devices::FormatIpv4(net.GetIpv4Netmask())) : "-";
+    case 3: return hasIpv6 ? QString::fromStdString(Devices::FormatIpv6(net.GetIpv6())) : "-";
+    case 4: return hasIpv6 ? QString::fromStdString(Devices::FormatIpv6(net.GetIpv6Netmask())) : "-";
+    case 5:
+        return (net.GetFlags() & Flags::HasMac)
+                   ? QString::fromStdString(Devices::FormatMac(net.GetMac())) : "-";
+    case 6:
+        return (net.GetFlags() & Flags::HasGateway)
+                   ? QString::fromStdString(Devices::FormatIpv4(net.GetGateway())) : "-";
+    }
+    return QString();
+}
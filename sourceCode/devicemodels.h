@@ -0,0 +1,81 @@
+#ifndef DEVICEMODELS_H
+#define DEVICEMODELS_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include "SysMonCore.hpp"
+
+// Таблица записей одного раздела снимка: строка - устройство, столбец -
+// поле. Данные берутся из ядра по запросу представления, а refresh()
+// сообщает только об изменившихся ячейках и добавленных/удалённых строках.
+class RecordTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    RecordTableModel(Devices::PC& systemMonitor, Devices::Snapshot::Section section,
+                     QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void refresh(const Devices::ChangeSet& changes);
+
+protected:
+    struct Column {
+        QString title;
+        uint32_t mask;
+    };
+
+    Devices::PC& systemMonitor;
+    Devices::Snapshot::Section section;
+    QVector<Column> columns;
+
+    virtual int recordCount() const = 0;
+    virtual QString cell(int row, int column) const = 0;
+
+private:
+    int rows = 0;
+};
+
+class CpuTableModel : public RecordTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit CpuTableModel(Devices::PC& systemMonitor, QObject* parent = nullptr);
+
+protected:
+    int recordCount() const override;
+    QString cell(int row, int column) const override;
+};
+
+class RamTableModel : public RecordTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit RamTableModel(Devices::PC& systemMonitor, QObject* parent = nullptr);
+
+protected:
+    int recordCount() const override;
+    QString cell(int row, int column) const override;
+};
+
+class NetworkTableModel : public RecordTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkTableModel(Devices::PC& systemMonitor, QObject* parent = nullptr);
+
+protected:
+    int recordCount() const override;
+    QString cell(int row, int column) const override;
+};
+
+#endif // DEVICEMODELS_H
@@ -0,0 +1,232 @@
+#include "heatmapwidget.h"
+#include "colorramp.h"
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const int groupHeaderHeight = 16;
+const int minimumCell = 4;
+const int maximumCell = 28;
+const QRgb offlineColor = qRgb(0x60, 0x60, 0x60);
+}
+
+HeatmapWidget::HeatmapWidget(Devices::PC& systemMonitor, QWidget* parent)
+    : QWidget(parent)
+    , systemMonitor(systemMonitor)
+    , colors(colorRamp())
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(120);
+}
+
+void HeatmapWidget::setMetric(Metric metric)
+{
+    this->metric = metric;
+    refresh();
+}
+
+void HeatmapWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    layoutValid = false;
+    refresh();
+}
+
+void HeatmapWidget::relayout()
+{
+    Devices::View<Devices::LogicalCPU> cpus = systemMonitor.GetLogicalCPUs();
+    layoutVersion = systemMonitor.GetTopologyVersion();
+    layoutValid = true;
+    cells.clear();
+
+    image = QImage(size(), QImage::Format_RGB32);
+    image.fill(palette().window().color());
+    if (cpus.empty() || width() <= 0) {
+        return;
+    }
+
+    QVector<uint32_t> order(static_cast<int>(cpus.size()));
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&cpus](uint32_t left, uint32_t right) {
+        const Devices::LogicalCPU& a = cpus[left];
+        const Devices::LogicalCPU& b = cpus[right];
+        if (a.package != b.package) return a.package < b.package;
+        if (a.node != b.node) return a.node < b.node;
+        if (a.core != b.core) return a.core < b.core;
+        return a.id < b.id;
+    });
+
+    int groups = 1;
+    for (int i = 1; i < order.size(); ++i) {
+        const Devices::LogicalCPU& a = cpus[order[i - 1]];
+        const Devices::LogicalCPU& b = cpus[order[i]];
+        groups += a.package != b.package || a.node != b.node;
+    }
+
+    // Самая крупная клетка, при которой все группы помещаются по высоте
+    int cell = maximumCell;
+    for (; cell > minimumCell; --cell) {
+        int perRow = std::max(1, width() / cell);
+        int rows = groups + order.size() / perRow;
+        if (groups * groupHeaderHeight + rows * cell <= height()) {
+            break;
+        }
+    }
+    int perRow = std::max(1, width() / cell);
+
+    QPainter painter(&image);
+    painter.setPen(palette().windowText().color());
+    int y = 0;
+    int column = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        const Devices::LogicalCPU& cpu = cpus[order[i]];
+        bool newGroup = i == 0 || cpu.package != cpus[order[i - 1]].package ||
+                        cpu.node != cpus[order[i - 1]].node;
+        if (newGroup) {
+            if (i != 0) {
+                y += cell;
+            }
+            painter.drawText(QRect(0, y, width(), groupHeaderHeight),
+                             Qt::AlignLeft | Qt::AlignVCenter,
+                             QString("Socket %1 / NUMA node %2").arg(cpu.package).arg(cpu.node));
+            y += groupHeaderHeight;
+            column = 0;
+        } else if (column == perRow) {
+            y += cell;
+            column = 0;
+        }
+        // Промежуток в пиксель между клетками оставляет видимой сетку
+        cells.append({order[i], QRect(column * cell, y, cell - 1, cell - 1)});
+        ++column;
+    }
+}
+
+void HeatmapWidget::refresh()
+{
+    if (!layoutValid || layoutVersion != systemMonitor.GetTopologyVersion() ||
+        image.size() != size()) {
+        relayout();
+    }
+    if (cells.isEmpty()) {
+        update();
+        return;
+    }
+
+    Devices::View<Devices::LogicalCPU> cpus = systemMonitor.GetLogicalCPUs();
+    uint32_t maximumFrequency = 1;
+    for (const Devices::LogicalCPU& cpu : cpus) {
+        maximumFrequency = std::max(maximumFrequency, cpu.frequencyMHz);
+    }
+
+    for (const Cell& cell : cells) {
+        if (cell.cpu >= cpus.size()) {
+            continue;
+        }
+        const Devices::LogicalCPU& cpu = cpus[cell.cpu];
+        double level = 0;
+        switch (metric) {
+        case Metric::Utilisation:
+            level = cpu.use / 100.0;
+            break;
+        case Metric::Frequency:
+            level = static_cast<double>(cpu.frequencyMHz) / maximumFrequency;
+            break;
+        case Metric::Temperature:
+            // 20..100 градусов на всю шкалу
+            level = (cpu.temperature / 1000.0 - 20) / 80;
+            break;
+        case Metric::Ipc:
+            // 0..4 инструкций за такт на всю шкалу
+            level = cpu.ipc / 4.0;
+            break;
+        }
+        int index = static_cast<int>(std::min(1.0, std::max(0.0, level)) * 255);
+        QRgb color = cpu.online ? colors[index] : offlineColor;
+
+        const QRect& rect = cell.rect;
+        for (int y = rect.top(); y <= rect.bottom() && y < image.height(); ++y) {
+            QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+            std::fill(line + rect.left(), line + std::min(rect.right() + 1, image.width()), color);
+        }
+    }
+    update();
+}
+
+void HeatmapWidget::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    if (image.isNull()) {
+        painter.fillRect(rect(), palette().window());
+        return;
+    }
+    painter.drawImage(0, 0, image);
+}
+
+int HeatmapWidget::cellAt(const QPoint& position) const
+{
+    for (int i = 0; i < cells.size(); ++i) {
+        if (cells[i].rect.contains(position)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool HeatmapWidget::event(QEvent* event)
+{
+    if (event->type() != QEvent::ToolTip) {
+        return QWidget::event(event);
+    }
+
+    QHelpEvent* help = static_cast<QHelpEvent*>(event);
+    int index = cellAt(help->pos());
+    Devices::View<Devices::LogicalCPU> cpus = systemMonitor.GetLogicalCPUs();
+    if (index < 0 || cells[index].cpu >= cpus.size()) {
+        QToolTip::hideText();
+        event->ignore();
+        return true;
+    }
+    const Devices::LogicalCPU& cpu = cpus[cells[index].cpu];
+    QString text = QString("CPU %1: socket %2, node %3, core %4\n")
+                       .arg(cpu.id).arg(cpu.package).arg(cpu.node).arg(cpu.core);
+    if (!cpu.online) {
+        text += "offline";
+    } else {
+        std::string_view governor = cpu.governor.View();
+        text += QString("Load %1%   %2 MHz (%3-%4, %5)   %6°C")
+                    .arg(cpu.use, 0, 'f', 0)
+                    .arg(cpu.frequencyMHz)
+                    .arg(cpu.minFrequencyMHz)
+                    .arg(cpu.maxFrequencyMHz)
+                    .arg(QString::fromUtf8(governor.data(), static_cast<int>(governor.size())))
+                    .arg(cpu.temperature / 1000.0, 0, 'f', 1);
+        Devices::View<Devices::CoreCounters> counters = systemMonitor.GetCoreCounters();
+        if (cpu.id < counters.size()) {
+            const Devices::CoreCounters& counter = counters[cpu.id];
+            if (counter.hardware && counter.running == 0) {
+                // Группа не поместилась на PMU: нули здесь не измерены
+                text += "\nHardware counters not scheduled on the PMU";
+            } else if (counter.hardware) {
+                double missRate = counter.cacheReferences > 0
+                                      ? counter.cacheMisses / counter.cacheReferences * 100 : 0;
+                double stalled = counter.cycles > 0 ? counter.stalledCycles / counter.cycles * 100 : 0;
+                text += QString("\nIPC %1   cache misses %2%   backend stalls %3%   "
+                                "branch misses %4/s   on PMU %5%")
+                            .arg(counter.ipc, 0, 'f', 2)
+                            .arg(missRate, 0, 'f', 1)
+                            .arg(stalled, 0, 'f', 1)
+                            .arg(counter.branchMisses, 0, 'f', 0)
+                            .arg(counter.running * 100, 0, 'f', 0);
+            }
+            text += QString("\nContext switches %1/s   migrations %2/s   page faults %3/s")
+                        .arg(counter.contextSwitches, 0, 'f', 0)
+                        .arg(counter.migrations, 0, 'f', 0)
+                        .arg(counter.pageFaults, 0, 'f', 0);
+        }
+    }
+    QToolTip::showText(help->globalPos(), text, this);
+    return true;
+}
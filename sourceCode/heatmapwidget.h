@@ -0,0 +1,49 @@
+#ifndef HEATMAPWIDGET_H
+#define HEATMAPWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QVector>
+#include "SysMonCore.hpp"
+
+// Тепловая карта логических процессоров: по клетке на поток, клетки
+// сгруппированы по сокету и NUMA-узлу и упорядочены по ядрам, так что
+// потоки одного ядра стоят рядом. Вся карта - одна QImage: раскладка
+// считается только при смене топологии или размера, а замер лишь
+// перекрашивает пиксели клеток на месте.
+class HeatmapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum class Metric { Utilisation, Frequency, Temperature, Ipc };
+
+    explicit HeatmapWidget(Devices::PC& systemMonitor, QWidget* parent = nullptr);
+
+    void setMetric(Metric metric);
+    void refresh();
+
+protected:
+    bool event(QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    struct Cell {
+        uint32_t cpu;
+        QRect rect;
+    };
+
+    Devices::PC& systemMonitor;
+    Metric metric = Metric::Utilisation;
+    QVector<Cell> cells;
+    QImage image;
+    uint64_t layoutVersion = 0;
+    bool layoutValid = false;
+    const QRgb* colors;
+
+    void relayout();
+    int cellAt(const QPoint& position) const;
+};
+
+#endif // HEATMAPWIDGET_H
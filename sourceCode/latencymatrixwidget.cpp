@@ -0,0 +1,142 @@
+#include "latencymatrixwidget.h"
+#include "colorramp.h"
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const int legendHeight = 16;
+const QRgb missingColor = qRgb(0x60, 0x60, 0x60);
+}
+
+LatencyMatrixWidget::LatencyMatrixWidget(Devices::PC& systemMonitor, QWidget* parent)
+    : QWidget(parent)
+    , systemMonitor(systemMonitor)
+    , colors(colorRamp())
+{
+    setMinimumSize(120, 120);
+}
+
+void LatencyMatrixWidget::setMatrix(const std::vector<unsigned>& cpus, const std::vector<float>& matrix)
+{
+    this->cpus = cpus;
+    this->matrix = matrix;
+    rebuild();
+    update();
+}
+
+void LatencyMatrixWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    update();
+}
+
+void LatencyMatrixWidget::rebuild()
+{
+    const int count = static_cast<int>(cpus.size());
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+    boundaries.clear();
+    if (count == 0) {
+        image = QImage();
+        return;
+    }
+
+    // Порядок тот же, что у тепловой карты, плюс группы L3
+    Devices::View<Devices::LogicalCPU> topology = systemMonitor.GetLogicalCPUs();
+    auto place = [&topology](unsigned cpu) {
+        return cpu < topology.size() ? topology[cpu] : Devices::LogicalCPU{cpu};
+    };
+    std::sort(order.begin(), order.end(), [&](int left, int right) {
+        Devices::LogicalCPU a = place(cpus[left]);
+        Devices::LogicalCPU b = place(cpus[right]);
+        if (a.package != b.package) return a.package < b.package;
+        if (a.node != b.node) return a.node < b.node;
+        if (a.llc != b.llc) return a.llc < b.llc;
+        if (a.core != b.core) return a.core < b.core;
+        return a.id < b.id;
+    });
+    // Границы и по группам общего L3: у AMD латентность растёт за CCX
+    for (int i = 1; i < count; ++i) {
+        Devices::LogicalCPU a = place(cpus[order[i - 1]]);
+        Devices::LogicalCPU b = place(cpus[order[i]]);
+        if (a.package != b.package || a.node != b.node || a.llc != b.llc) {
+            boundaries.append(i);
+        }
+    }
+
+    minimum = 0;
+    maximum = 0;
+    for (float value : matrix) {
+        if (value >= 0) {
+            minimum = maximum == 0 ? value : std::min(minimum, value);
+            maximum = std::max(maximum, value);
+        }
+    }
+    float span = std::max(maximum - minimum, 1e-3f);
+
+    // Пиксель на пару, масштабирование при отрисовке без сглаживания
+    image = QImage(count, count, QImage::Format_RGB32);
+    for (int row = 0; row < count; ++row) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(row));
+        for (int column = 0; column < count; ++column) {
+            float value = matrix[static_cast<size_t>(order[row]) * count + order[column]];
+            line[column] = value < 0 ? missingColor
+                                     : colors[static_cast<int>((value - minimum) / span * 255)];
+        }
+    }
+}
+
+QRect LatencyMatrixWidget::matrixRect() const
+{
+    int side = std::max(0, std::min(width(), height() - legendHeight));
+    return QRect(0, 0, side, side);
+}
+
+void LatencyMatrixWidget::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if (image.isNull()) {
+        painter.drawText(rect(), Qt::AlignCenter, "Core-to-core latency not measured");
+        return;
+    }
+
+    QRect area = matrixRect();
+    painter.drawImage(area, image);
+    painter.setPen(palette().windowText().color());
+    double cell = static_cast<double>(area.width()) / image.width();
+    for (int boundary : boundaries) {
+        int position = static_cast<int>(boundary * cell);
+        painter.drawLine(position, 0, position, area.bottom());
+        painter.drawLine(0, position, area.right(), position);
+    }
+    painter.drawText(QRect(0, area.bottom() + 1, width(), legendHeight),
+                     Qt::AlignLeft | Qt::AlignVCenter,
+                     QString("%1 - %2 ns one way").arg(minimum, 0, 'f', 1).arg(maximum, 0, 'f', 1));
+}
+
+bool LatencyMatrixWidget::event(QEvent* event)
+{
+    if (event->type() != QEvent::ToolTip) {
+        return QWidget::event(event);
+    }
+
+    QHelpEvent* help = static_cast<QHelpEvent*>(event);
+    QRect area = matrixRect();
+    if (image.isNull() || !area.contains(help->pos()) || area.width() == 0) {
+        QToolTip::hideText();
+        event->ignore();
+        return true;
+    }
+    int count = image.width();
+    int row = std::min(count - 1, help->pos().y() * count / area.height());
+    int column = std::min(count - 1, help->pos().x() * count / area.width());
+    float value = matrix[static_cast<size_t>(order[row]) * count + order[column]];
+    QString text = QString("CPU %1 - CPU %2: ").arg(cpus[order[row]]).arg(cpus[order[column]]);
+    text += value < 0 ? QString("not measured") : QString("%1 ns").arg(value, 0, 'f', 1);
+    QToolTip::showText(help->globalPos(), text, this);
+    return true;
+}
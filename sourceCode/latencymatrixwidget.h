@@ -0,0 +1,44 @@
+#ifndef LATENCYMATRIXWIDGET_H
+#define LATENCYMATRIXWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QVector>
+#include <vector>
+#include "SysMonCore.hpp"
+
+// Матрица задержек между логическими процессорами. Строки и столбцы
+// упорядочены как в тепловой карте (сокет, NUMA-узел, ядро), границы
+// групп прочерчены линиями - переходы между сокетами и узлами видны как
+// блоки другого цвета. Шкала от минимальной до максимальной задержки.
+class LatencyMatrixWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyMatrixWidget(Devices::PC& systemMonitor, QWidget* parent = nullptr);
+
+    // cpus и matrix - результат CoreLatencyTest::GetMatrix.
+    void setMatrix(const std::vector<unsigned>& cpus, const std::vector<float>& matrix);
+
+protected:
+    bool event(QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    Devices::PC& systemMonitor;
+    std::vector<unsigned> cpus;
+    std::vector<float> matrix;
+    QVector<int> order;      // индексы cpus в порядке топологии
+    QVector<int> boundaries; // позиции в order, с которых начинается группа
+    QImage image;
+    const QRgb* colors; // синий - быстрая пара (общий кэш), красный - другой сокет
+    float minimum = 0;
+    float maximum = 0;
+
+    void rebuild();
+    QRect matrixRect() const;
+};
+
+#endif // LATENCYMATRIXWIDGET_H
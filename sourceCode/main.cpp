@@ -1,32 +1,227 @@
 #include "mainwindow.h"
-#include <iostream>
+#include "FleetAgent.hpp"
+#include "InputTrace.hpp"
+#include "PrivilegedHelper.hpp"
+#include "SnapshotExport.hpp"
+#include "SysMonCore.hpp"
+#include <cerrno>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
 #include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
 #include <QApplication>
 
-using namespace std;
-int main(int argc, char *argv[])
+namespace {
+// --agent: без окна, только сводка для агрегаторов раз в секунду
+int runAgent(std::string_view address)
 {
-    string password;
+    Devices::PC& pc = Devices::PC::GetInstance();
+    Devices::FleetAgent agent;
+    std::string error;
+    if (!agent.Listen(address, error)) {
+        std::cerr << "Agent: " << error << std::endl;
+        return 1;
+    }
+    // Окна нет, но сводку смотрят агрегаторы: её сборщики не замедляются
+    using Collector = Devices::PC::Collector;
+    for (Collector collector : {Collector::CPU, Collector::RAM, Collector::NetworkTraffic}) {
+        pc.SetViewed(collector, true);
+    }
+    Devices::Scheduler& scheduler = pc.GetScheduler();
+    // Приоритет 0 - после сборщиков с тем же дедлайном
+    scheduler.AddTask("FleetAgent", 1000000000ull, 0,
+                      [&agent, &pc](uint64_t) { agent.Publish(pc); });
+
+    if (scheduler.GetError() != 0) {
+        std::cerr << "Agent: timerfd: " << strerror(scheduler.GetError())
+                  << ", waking up by poll timeout" << std::endl;
+    }
 
-    cout << "Введите ваш пароль для sudo: ";
-    getline(cin, password);
+    pollfd descriptors[2] = {{scheduler.GetFd(), POLLIN, 0}, {agent.GetFd(), POLLIN, 0}};
+    for (;;) {
+        // Без timerfd дедлайны ждёт сам poll; дескриптор -1 он пропускает
+        int timeoutMs = scheduler.GetError() != 0 ? scheduler.GetTimeoutMs() : -1;
+        if (poll(descriptors, 2, timeoutMs) < 0 && errno != EINTR) {
+            std::cerr << "Agent: poll failed" << std::endl;
+            return 1;
+        }
+        if (descriptors[1].revents & POLLIN) {
+            agent.Accept();
+        }
+        scheduler.RunDue();
+    }
+}
 
-    // Формируем команду для выполнения с sudo
-    string command = "echo '" + password + "' | sudo -S whoami 2>/dev/null";
+// --record / --replay: трасса входов сборщиков пишется или подменяет
+// живые замеры. Трасса открывается до создания PC: его конструктор
+// делает первые замеры всех сборщиков
+bool startTrace(const char *recordPath, const char *replayPath, double speed)
+{
+    Devices::InputTrace& trace = Devices::InputTrace::GetInstance();
+    std::string error;
+    if (replayPath && !trace.OpenReplay(replayPath, error)) {
+        std::cerr << "Replay: " << error << std::endl;
+        return false;
+    }
+    if (recordPath && !trace.StartRecording(recordPath, error)) {
+        std::cerr << "Record: " << error << std::endl;
+        return false;
+    }
+    if (replayPath && !Devices::PC::GetInstance().StartReplay(speed, error)) {
+        std::cerr << "Replay: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    // Выполняем команду и проверяем результат
-    int result = system(command.c_str());
+// Дописывает трассу при выходе; ошибка записи делает выход неуспешным
+bool stopRecording()
+{
+    Devices::InputTrace& trace = Devices::InputTrace::GetInstance();
+    if (!trace.StopRecording()) {
+        std::cerr << "Record: " << trace.GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    if (result == 0) {
-        cout << "Успешный вход в sudo!" << endl;
-        // Здесь можно выполнять команды, требующие sudo
-    } else {
-        cout << "Неверный пароль или ошибка sudo!" << endl;
+// --replay без темпа: трасса целиком без пауз, итог - в stderr
+void replayAll()
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t samples = Devices::PC::GetInstance().ReplayAll();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Replayed " << samples << " samples in " << seconds << " s ("
+              << (seconds > 0 ? samples / seconds : 0) << " samples/s)" << std::endl;
+}
+
+// "a:port,b:port" или "@файл" (адрес на строку, # - комментарий)
+std::vector<std::string> parseAgents(std::string_view list)
+{
+    std::vector<std::string> addresses;
+    if (!list.empty() && list.front() == '@') {
+        std::ifstream file{std::string(list.substr(1))};
+        std::string line;
+        while (std::getline(file, line)) {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line.front() != '#') {
+                addresses.push_back(line);
+            }
+        }
+        return addresses;
+    }
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (comma != 0) {
+            addresses.emplace_back(list.substr(0, comma));
+        }
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+    return addresses;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // --once [--format=json|cbor]: снимок в stdout без GUI, для сбора
+    // инвентаря с парка машин.
+    // --agent[=[адрес:]порт]: сводка хоста для агрегаторов, без GUI.
+    // Без адреса слушается только loopback: аутентификации у агента нет.
+    // --aggregate=список: вкладка Fleet с лучшими хостами парка.
+    // --record=файл: запись сырых входов сборщиков.
+    // --replay=файл [--speed=N|max]: замеры из записи вместо живых; max
+    // (и --once) - без окна и пауз, для проверки и замеров скорости.
+    // Остальные аргументы достаются Qt.
+    bool once = false;
+    bool agent = false;
+    std::string_view agentAddress;
+    std::vector<std::string> fleetAgents;
+    Devices::ExportFormat format = Devices::ExportFormat::Json;
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+    double speed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument(argv[i]);
+        if (argument == "--once") {
+            once = true;
+        } else if (argument.substr(0, 9) == "--format=" &&
+                   !Devices::ParseExportFormat(argument.substr(9), format)) {
+            std::cerr << "Unknown format: " << argument.substr(9) << " (json, cbor)" << std::endl;
+            return 2;
+        } else if (argument == "--agent" || argument.substr(0, 8) == "--agent=") {
+            agent = true;
+            if (argument.size() > 8) {
+                agentAddress = argument.substr(8);
+            }
+        } else if (argument.substr(0, 12) == "--aggregate=") {
+            fleetAgents = parseAgents(argument.substr(12));
+        } else if (argument.substr(0, 9) == "--record=") {
+            recordPath = argv[i] + 9;
+        } else if (argument.substr(0, 9) == "--replay=") {
+            replayPath = argv[i] + 9;
+        } else if (argument.substr(0, 8) == "--speed=") {
+            speed = argument == "--speed=max" ? 0 : strtod(argv[i] + 8, nullptr);
+            if (argument != "--speed=max" && speed <= 0) {
+                std::cerr << "Invalid speed: " << argument.substr(8) << " (N > 0, max)" << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // Агент работает без sudo: в сводке нет данных SMBIOS
+    if (agent) {
+        return startTrace(recordPath, replayPath, speed) ? runAgent(agentAddress) : 1;
+    }
+
+    // Данные только для root (SMBIOS) собирает помощник, запущенный
+    // один раз через sudo; без него инвентарь строится по sysfs
+    std::string error;
+    if (!Devices::PrivilegedHelper::GetInstance().Start(error)) {
+        std::cerr << "Privileged helper: " << error << std::endl;
+    }
+    if (!startTrace(recordPath, replayPath, speed)) {
+        Devices::PrivilegedHelper::GetInstance().Stop();
         return 1;
     }
+
+    if (once || (replayPath && speed == 0)) {
+        Devices::PC &pc = Devices::PC::GetInstance();
+        for (size_t probe = 0; probe < static_cast<size_t>(Devices::PC::Probe::Count); ++probe) {
+            pc.WaitReady(static_cast<Devices::PC::Probe>(probe));
+        }
+        bool written = true;
+        if (replayPath) {
+            replayAll();
+        } else {
+            pc.UpdateData();
+        }
+        if (once) {
+            written = Devices::ExportSnapshot(pc, format, STDOUT_FILENO);
+        }
+        bool recorded = stopRecording();
+        Devices::PrivilegedHelper::GetInstance().Stop();
+        return written && recorded ? 0 : 1;
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
+    for (const std::string& address : fleetAgents) {
+        if (!w.addFleetAgent(address, error)) {
+            std::cerr << "Fleet agent " << error << std::endl;
+        }
+    }
     w.show();
-    return a.exec();
+    int result = a.exec();
+    if (!stopRecording() && result == 0) {
+        result = 1;
+    }
+    Devices::PrivilegedHelper::GetInstance().Stop();
+    return result;
 }
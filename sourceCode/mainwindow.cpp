@@ -2,11 +2,38 @@
 #include "ui_mainwindow.h"
 #include <QLabel>
 #include <QProgressBar>
-#include <QLineEdit>
-#include <QFormLayout>
 #include <QListWidget>
+#include <QListView>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QDir>
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <set>
-#include <unordered_set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+QString toQString(const std::string& text)
+{
+    return QString::fromStdString(text);
+}
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -21,54 +48,831 @@ MainWindow::MainWindow(QWidget *parent)
     ui->formLayoutWidget_4->hide();
 
     setupInnerTabs();
+    setupChartsTab();
+    setupStatisticsTab();
+    setupDiagnosticsTab();
+    setupStressTab();
+    setupMemoryBenchmarkTab();
+    setupWakeupTab();
+    setupStorageTab();
+
+    // Сборщики запускает планировщик ядра по timerfd, окно лишь
+    // перерисовывается после очередного замера.
+    if (systemMonitor.GetScheduler().GetFd() >= 0) {
+        schedulerNotifier = new QSocketNotifier(systemMonitor.GetScheduler().GetFd(),
+                                                QSocketNotifier::Read, this);
+        connect(schedulerNotifier, &QSocketNotifier::activated, this, &MainWindow::onSchedulerTimer);
+    }
+
+    // Статические пробы завершаются в фоне, раздел заполняется сразу по готовности
+    probeNotifier = new QSocketNotifier(systemMonitor.GetProbeFd(), QSocketNotifier::Read, this);
+    connect(probeNotifier, &QSocketNotifier::activated, this, &MainWindow::onProbeFinished);
+
+    // Оповещения приходят синхронно из сборщиков, в этом же потоке
+    alertSubscription = systemMonitor.GetAlerts().Subscribe(
+        [this](const Devices::AlertEngine::Event& event) { showAlert(event); });
 
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &MainWindow::updateSystemData);
-    updateTimer->start(1000);
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, [this]() {
+        updateVisibility();
+        updateSystemData();
+    });
 
     firstUpdate = true;
+    updateVisibility();
     updateSystemData();
 }
 
 void MainWindow::setupInnerTabs()
 {
-    cpuInnerTabWidget = new QTabWidget(ui->tab_3);
-    cpuInnerTabWidget->setGeometry(10, 20, 701, 481);
-    cpuInnerTabWidget->setTabPosition(QTabWidget::West);
+    // Представления создаются один раз, дальше обновляются только модели
+    auto makeTable = [](QWidget* parent, QAbstractItemModel* model) {
+        QTableView* view = new QTableView(parent);
+        view->setModel(model);
+        view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        view->setFocusPolicy(Qt::NoFocus);
+        view->setSelectionMode(QAbstractItemView::NoSelection);
+        view->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        return view;
+    };
+
+    QWidget* cpuContainer = new QWidget(ui->tab_3);
+    cpuContainer->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* cpuLayout = new QVBoxLayout(cpuContainer);
+    cpuLayout->setContentsMargins(0, 0, 0, 0);
+
+    cpuModel = new CpuTableModel(systemMonitor, this);
+    cpuView = makeTable(cpuContainer, cpuModel);
+    cpuLayout->addWidget(cpuView, 1);
+
+    // Потоки всех процессоров одной картинкой вместо виджета на каждый
+    QHBoxLayout* heatmapControls = new QHBoxLayout();
+    QComboBox* metricBox = new QComboBox(cpuContainer);
+    metricBox->addItem("Utilisation", static_cast<int>(HeatmapWidget::Metric::Utilisation));
+    metricBox->addItem("Frequency", static_cast<int>(HeatmapWidget::Metric::Frequency));
+    metricBox->addItem("Temperature", static_cast<int>(HeatmapWidget::Metric::Temperature));
+    metricBox->addItem("IPC", static_cast<int>(HeatmapWidget::Metric::Ipc));
+    heatmapControls->addWidget(new QLabel("Logical CPUs:", cpuContainer));
+    heatmapControls->addWidget(metricBox);
+    heatmapControls->addStretch();
+    cpuLayout->addLayout(heatmapControls);
+
+    coreLatencyButton = new QPushButton("Measure core-to-core latency", cpuContainer);
+    coreLatencyLabel = new QLabel(cpuContainer);
+    heatmapControls->addWidget(coreLatencyButton);
+    heatmapControls->addWidget(coreLatencyLabel);
+    connect(coreLatencyButton, &QPushButton::clicked, this, &MainWindow::toggleCoreLatencyTest);
+
+    QHBoxLayout* maps = new QHBoxLayout();
+    cpuHeatmap = new HeatmapWidget(systemMonitor, cpuContainer);
+    maps->addWidget(cpuHeatmap, 1);
+    latencyMatrix = new LatencyMatrixWidget(systemMonitor, cpuContainer);
+    maps->addWidget(latencyMatrix, 1);
+    cpuLayout->addLayout(maps, 2);
+    connect(metricBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this, metricBox](int index) {
+                auto metric = static_cast<HeatmapWidget::Metric>(metricBox->itemData(index).toInt());
+                cpuHeatmap->setMetric(metric);
+                // Без PMU (виртуальная машина) или прав IPC остаётся нулевым
+                std::string_view error = systemMonitor.GetPerfError();
+                if (metric == HeatmapWidget::Metric::Ipc && !error.empty()) {
+                    ui->statusbar->showMessage(toQString(error));
+                } else if (metric == HeatmapWidget::Metric::Ipc &&
+                           !systemMonitor.GetCoreCounters().empty() &&
+                           !systemMonitor.HasHardwareCounters()) {
+                    ui->statusbar->showMessage("No hardware performance counters, software events only");
+                }
+            });
+
+    ramModel = new RamTableModel(systemMonitor, this);
+    ramView = makeTable(ui->tab_4, ramModel);
+    ramView->setGeometry(10, 20, 701, 481);
+
+    QWidget* networkContainer = new QWidget(ui->tab_5);
+    networkContainer->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* networkLayout = new QVBoxLayout(networkContainer);
+    networkLayout->setContentsMargins(0, 0, 0, 0);
 
-    ramInnerTabWidget = new QTabWidget(ui->tab_4);
-    ramInnerTabWidget->setGeometry(10, 20, 701, 481);
-    ramInnerTabWidget->setTabPosition(QTabWidget::West);
+    networkModel = new NetworkTableModel(systemMonitor, this);
+    networkView = makeTable(networkContainer, networkModel);
+    networkLayout->addWidget(networkView, 3);
 
-    networkInnerTabWidget = new QTabWidget(ui->tab_5);
-    networkInnerTabWidget->setGeometry(10, 20, 701, 481);
-    networkInnerTabWidget->setTabPosition(QTabWidget::West);
+    networkLayout->addWidget(new QLabel("DNS Servers:", networkContainer));
+    dnsModel = new QStringListModel(this);
+    QListView* dnsView = new QListView(networkContainer);
+    dnsView->setModel(dnsModel);
+    dnsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    dnsView->setFocusPolicy(Qt::NoFocus);
+    networkLayout->addWidget(dnsView, 1);
 }
 
-void MainWindow::updateSystemData()
+void MainWindow::setupChartsTab()
+{
+    using Series = Devices::PC::Series;
+    chartsTab = new QWidget();
+    QWidget* container = new QWidget(chartsTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    QComboBox* windowBox = new QComboBox(container);
+    const uint64_t second = 1000000000ull;
+    windowBox->addItem("1 min", QVariant::fromValue<qulonglong>(60 * second));
+    windowBox->addItem("10 min", QVariant::fromValue<qulonglong>(600 * second));
+    windowBox->addItem("1 hour", QVariant::fromValue<qulonglong>(3600 * second));
+    windowBox->addItem("6 hours", QVariant::fromValue<qulonglong>(6 * 3600 * second));
+    QComboBox* rateBox = new QComboBox(container);
+    for (int hz : {1, 2, 5, 10}) {
+        rateBox->addItem(QString("%1 Hz").arg(hz), hz);
+    }
+    controls->addWidget(new QLabel("Window:", container));
+    controls->addWidget(windowBox);
+    controls->addWidget(new QLabel("Sample rate:", container));
+    controls->addWidget(rateBox);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    auto percent = [](double value) { return QString("%1%").arg(value, 0, 'f', 0); };
+    auto rate = [](double value) {
+        return QString::fromStdString(Devices::FormatBytes(static_cast<uint64_t>(value))) + "/s";
+    };
+
+    cpuChart = new ChartWidget("CPU", container);
+    cpuChart->setRange(0, 100);
+    cpuChart->setFormatter(percent);
+    cpuChart->addSeries(&systemMonitor.GetHistory(Series::CPU), QColor(0x1f, 0x77, 0xb4));
+
+    coreChart = new ChartWidget("CPU per core", container);
+    coreChart->setRange(0, 100);
+    coreChart->setFormatter(percent);
+
+    memoryChart = new ChartWidget("Memory", container);
+    memoryChart->setRange(0, 100);
+    memoryChart->setFormatter(percent);
+    memoryChart->addSeries(&systemMonitor.GetHistory(Series::Memory), QColor(0x2c, 0xa0, 0x2c));
+
+    networkChart = new ChartWidget("Network rx / tx", container);
+    networkChart->setFormatter(rate);
+    networkChart->addSeries(&systemMonitor.GetHistory(Series::NetworkRx), QColor(0x94, 0x67, 0xbd));
+    networkChart->addSeries(&systemMonitor.GetHistory(Series::NetworkTx), QColor(0xff, 0x7f, 0x0e));
+
+    temperatureChart = new ChartWidget("Temperature", container);
+    temperatureChart->setFormatter([](double value) { return QString("%1°C").arg(value, 0, 'f', 0); });
+    temperatureChart->addSeries(&systemMonitor.GetHistory(Series::Temperature), QColor(0xd6, 0x27, 0x28));
+
+    powerChart = new ChartWidget("Package power", container);
+    powerChart->setFormatter([](double value) { return QString("%1 W").arg(value, 0, 'f', 1); });
+    powerChart->addSeries(&systemMonitor.GetHistory(Series::PackagePower), QColor(0xff, 0x7f, 0x0e));
+
+    QGridLayout* grid = new QGridLayout();
+    grid->addWidget(cpuChart, 0, 0);
+    grid->addWidget(coreChart, 0, 1);
+    grid->addWidget(memoryChart, 1, 0);
+    grid->addWidget(networkChart, 1, 1);
+    grid->addWidget(temperatureChart, 2, 0);
+    grid->addWidget(powerChart, 2, 1);
+    layout->addLayout(grid);
+
+    connect(windowBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this, windowBox](int index) {
+                uint64_t windowNs = windowBox->itemData(index).toULongLong();
+                for (ChartWidget* chart : {cpuChart, coreChart, memoryChart, networkChart, temperatureChart,
+                                           powerChart}) {
+                    chart->setWindow(windowNs);
+                }
+                updateCharts();
+            });
+    // Частота замеров нужна только графикам: остальные вкладки
+    // показывают последнее значение и обходятся базовым интервалом
+    connect(rateBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this, rateBox](int index) {
+                using Collector = Devices::PC::Collector;
+                uint64_t intervalNs = 1000000000ull / rateBox->itemData(index).toUInt();
+                for (Collector collector : {Collector::CPU, Collector::RAM, Collector::NetworkTraffic}) {
+                    systemMonitor.SetInterval(collector, intervalNs);
+                }
+                armSchedulerFallback();
+            });
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), chartsTab, "Charts");
+}
+
+void MainWindow::setupStatisticsTab()
+{
+    statisticsTab = new QWidget();
+    QWidget* container = new QWidget(statisticsTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    statisticsWindowBox = new QComboBox(container);
+    statisticsWindowBox->addItem("1 minute", static_cast<int>(Devices::SlidingQuantiles::Window::Minute));
+    statisticsWindowBox->addItem("1 hour", static_cast<int>(Devices::SlidingQuantiles::Window::Hour));
+    statisticsWindowBox->addItem("24 hours", static_cast<int>(Devices::SlidingQuantiles::Window::Day));
+    controls->addWidget(new QLabel("Percentiles over:", container));
+    controls->addWidget(statisticsWindowBox);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    statisticsTable = new QTableWidget(0, 6, container);
+    statisticsTable->setHorizontalHeaderLabels({"Metric", "p50", "p95", "p99", "Max", "Samples"});
+    statisticsTable->verticalHeader()->hide();
+    statisticsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    statisticsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statisticsTable->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(statisticsTable);
+
+    connect(statisticsWindowBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &MainWindow::updateStatisticsTab);
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), statisticsTab, "Statistics");
+}
+
+void MainWindow::setupDiagnosticsTab()
+{
+    diagnosticsTab = new QWidget();
+    QWidget* container = new QWidget(diagnosticsTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+
+    diagnosticsSummaryLabel = new QLabel(container);
+    layout->addWidget(diagnosticsSummaryLabel);
+
+    diagnosticsTable = new QTableWidget(0, 6, container);
+    diagnosticsTable->setHorizontalHeaderLabels(
+        {"Probe", "Count", "Mean", "p50", "p99", "Max"});
+    diagnosticsTable->verticalHeader()->hide();
+    diagnosticsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    diagnosticsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    diagnosticsTable->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(diagnosticsTable);
+
+    // Вкладка диагностики идёт перед "About"
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), diagnosticsTab, "Diagnostics");
+}
+
+void MainWindow::setupStressTab()
 {
-    systemMonitor.UpdateData();
+    using StressTest = Devices::StressTest;
+    stressTab = new QWidget();
+    QWidget* container = new QWidget(stressTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
 
-    // Сохраняем текущие индексы вкладок
-    int cpuTabIndex = cpuInnerTabWidget->currentIndex();
-    int ramTabIndex = ramInnerTabWidget->currentIndex();
-    int networkTabIndex = networkInnerTabWidget->currentIndex();
+    // В списке только ядра, которые этот процессор умеет выполнять
+    QHBoxLayout* controls = new QHBoxLayout();
+    stressKernelBox = new QComboBox(container);
+    stressKernelBox->addItem(QString("Auto (%1)").arg(
+                                 StressTest::GetKernelName(StressTest::GetBestKernel())),
+                             static_cast<int>(StressTest::Kernel::Auto));
+    for (StressTest::Kernel kernel : {StressTest::Kernel::Scalar, StressTest::Kernel::SSE,
+                                      StressTest::Kernel::AVX2, StressTest::Kernel::AVX512}) {
+        if (StressTest::IsSupported(kernel)) {
+            stressKernelBox->addItem(StressTest::GetKernelName(kernel), static_cast<int>(kernel));
+        }
+    }
+    stressWorkloadBox = new QComboBox(container);
+    stressWorkloadBox->addItem("Float (FMA)", static_cast<int>(StressTest::Workload::Float));
+    stressWorkloadBox->addItem("Integer", static_cast<int>(StressTest::Workload::Integer));
+    stressLoadBox = new QSpinBox(container);
+    stressLoadBox->setRange(1, 100);
+    stressLoadBox->setValue(100);
+    stressLoadBox->setSuffix("%");
+    stressDurationBox = new QSpinBox(container);
+    stressDurationBox->setRange(5, 3600);
+    stressDurationBox->setValue(60);
+    stressDurationBox->setSuffix(" s");
+    stressButton = new QPushButton("Start", container);
+    controls->addWidget(new QLabel("Kernel:", container));
+    controls->addWidget(stressKernelBox);
+    controls->addWidget(stressWorkloadBox);
+    controls->addWidget(new QLabel("Load:", container));
+    controls->addWidget(stressLoadBox);
+    controls->addWidget(new QLabel("Duration:", container));
+    controls->addWidget(stressDurationBox);
+    controls->addWidget(stressButton);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    stressStatusLabel = new QLabel(container);
+    layout->addWidget(stressStatusLabel);
+
+    QHBoxLayout* body = new QHBoxLayout();
+    stressTable = new QTableWidget(0, 2, container);
+    stressTable->setHorizontalHeaderLabels({"CPU", "GOPS"});
+    stressTable->verticalHeader()->hide();
+    stressTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    stressTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    stressTable->setFocusPolicy(Qt::NoFocus);
+    body->addWidget(stressTable, 1);
+
+    QVBoxLayout* charts = new QVBoxLayout();
+    stressThroughputChart = new ChartWidget("Throughput", container);
+    stressThroughputChart->setFormatter([](double value) { return QString("%1 G").arg(value, 0, 'f', 1); });
+    stressThroughputChart->addSeries(&stressTest.GetThroughputHistory(), QColor(0x1f, 0x77, 0xb4));
+    stressFrequencyChart = new ChartWidget("Average frequency", container);
+    stressFrequencyChart->setFormatter([](double value) { return QString("%1 MHz").arg(value, 0, 'f', 0); });
+    stressFrequencyChart->addSeries(&stressTest.GetFrequencyHistory(), QColor(0x2c, 0xa0, 0x2c));
+    stressTemperatureChart = new ChartWidget("Temperature", container);
+    stressTemperatureChart->setFormatter([](double value) { return QString("%1°C").arg(value, 0, 'f', 0); });
+    stressTemperatureChart->addSeries(&stressTest.GetTemperatureHistory(), QColor(0xd6, 0x27, 0x28));
+    charts->addWidget(stressThroughputChart);
+    charts->addWidget(stressFrequencyChart);
+    stressPowerChart = new ChartWidget("Package power", container);
+    stressPowerChart->setFormatter([](double value) { return QString("%1 W").arg(value, 0, 'f', 1); });
+    stressPowerChart->addSeries(&stressTest.GetPowerHistory(), QColor(0xff, 0x7f, 0x0e));
+    charts->addWidget(stressTemperatureChart);
+    charts->addWidget(stressPowerChart);
+    body->addLayout(charts, 2);
+    layout->addLayout(body);
 
-    // Обновляем все вкладки
-    updateSystemTab();
-    updateCpuTabs();
-    updateRamTabs();
-    updateNetworkTabs();
+    connect(stressButton, &QPushButton::clicked, this, &MainWindow::toggleStressTest);
 
-    // Восстанавливаем индексы вкладок
-    if (cpuTabIndex >= 0 && cpuTabIndex < cpuInnerTabWidget->count()) {
-        cpuInnerTabWidget->setCurrentIndex(cpuTabIndex);
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), stressTab, "Stress test");
+}
+
+void MainWindow::setupMemoryBenchmarkTab()
+{
+    memoryBenchmarkTab = new QWidget();
+    QWidget* container = new QWidget(memoryBenchmarkTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    memoryThreadsBox = new QSpinBox(container);
+    memoryThreadsBox->setRange(1, std::max(1, static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN))));
+    // Узлы NUMA добавляет updateMemoryNodes по топологии
+    memoryCpuNodeBox = new QComboBox(container);
+    memoryCpuNodeBox->addItem("All CPUs", -1);
+    memoryNodeBox = new QComboBox(container);
+    memoryNodeBox->addItem("First touch", -1);
+    memoryWorkingSetBox = new QComboBox(container);
+    for (int mebibytes : {64, 256, 1024}) {
+        memoryWorkingSetBox->addItem(QString("up to %1 MiB").arg(mebibytes), mebibytes);
     }
-    if (ramTabIndex >= 0 && ramTabIndex < ramInnerTabWidget->count()) {
-        ramInnerTabWidget->setCurrentIndex(ramTabIndex);
+    memoryWorkingSetBox->setCurrentIndex(1);
+    memoryBenchmarkButton = new QPushButton("Start", container);
+    controls->addWidget(new QLabel("Threads:", container));
+    controls->addWidget(memoryThreadsBox);
+    controls->addWidget(new QLabel("CPUs:", container));
+    controls->addWidget(memoryCpuNodeBox);
+    controls->addWidget(new QLabel("Memory:", container));
+    controls->addWidget(memoryNodeBox);
+    controls->addWidget(memoryWorkingSetBox);
+    controls->addWidget(memoryBenchmarkButton);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    memoryBenchmarkProgress = new QProgressBar(container);
+    memoryBenchmarkProgress->setRange(0, 100);
+    layout->addWidget(memoryBenchmarkProgress);
+    memoryBenchmarkLabel = new QLabel(container);
+    memoryBenchmarkLabel->setWordWrap(true);
+    layout->addWidget(memoryBenchmarkLabel);
+
+    auto makeTable = [container](const QStringList& headers) {
+        QTableWidget* table = new QTableWidget(0, headers.size(), container);
+        table->setHorizontalHeaderLabels(headers);
+        table->verticalHeader()->hide();
+        table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        table->setFocusPolicy(Qt::NoFocus);
+        return table;
+    };
+    QHBoxLayout* tables = new QHBoxLayout();
+    latencyTable = makeTable({"Working set", "Latency", "Reported cache"});
+    bandwidthTable = makeTable({"Kernel", "Regular", "Non-temporal"});
+    tables->addWidget(latencyTable, 3);
+    tables->addWidget(bandwidthTable, 2);
+    layout->addLayout(tables);
+
+    connect(memoryBenchmarkButton, &QPushButton::clicked, this, &MainWindow::toggleMemoryBenchmark);
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), memoryBenchmarkTab, "Memory benchmark");
+    updateMemoryNodes();
+}
+
+void MainWindow::updateMemoryNodes()
+{
+    // Топология читается первым замером частот и перечитывается при
+    // hotplug; списки дополняются, выбор сохраняется
+    if (memoryNodesVersion == systemMonitor.GetTopologyVersion()) {
+        return;
+    }
+    memoryNodesVersion = systemMonitor.GetTopologyVersion();
+    std::set<int> nodes;
+    for (const Devices::LogicalCPU& cpu : systemMonitor.GetLogicalCPUs()) {
+        if (cpu.online && cpu.node >= 0) {
+            nodes.insert(cpu.node);
+        }
+    }
+    for (QComboBox* box : {memoryCpuNodeBox, memoryNodeBox}) {
+        for (int node : nodes) {
+            if (box->findData(node) < 0) {
+                box->addItem(QString("Node %1").arg(node), node);
+            }
+        }
+    }
+}
+
+void MainWindow::setupWakeupTab()
+{
+    using Series = Devices::PC::Series;
+    wakeupTab = new QWidget();
+    QWidget* container = new QWidget(wakeupTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    wakeupIntervalBox = new QComboBox(container);
+    for (int microseconds : {100, 250, 1000, 10000}) {
+        wakeupIntervalBox->addItem(microseconds < 1000 ? QString("%1 us").arg(microseconds)
+                                                       : QString("%1 ms").arg(microseconds / 1000),
+                                   microseconds);
+    }
+    wakeupIntervalBox->setCurrentIndex(2);
+    wakeupRealtimeBox = new QCheckBox("SCHED_FIFO", container);
+    wakeupRealtimeBox->setChecked(true);
+    wakeupButton = new QPushButton("Start", container);
+    wakeupStatusLabel = new QLabel(container);
+    controls->addWidget(new QLabel("Interval:", container));
+    controls->addWidget(wakeupIntervalBox);
+    controls->addWidget(wakeupRealtimeBox);
+    controls->addWidget(wakeupButton);
+    controls->addWidget(wakeupStatusLabel);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    QHBoxLayout* body = new QHBoxLayout();
+    wakeupTable = new QTableWidget(0, 6, container);
+    wakeupTable->setHorizontalHeaderLabels({"CPU", "Samples", "Min", "Avg", "p99", "Max"});
+    wakeupTable->verticalHeader()->hide();
+    wakeupTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    wakeupTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    wakeupTable->setFocusPolicy(Qt::NoFocus);
+    body->addWidget(wakeupTable, 1);
+
+    // Всплески задержки рядом с загрузкой и температурой за то же окно
+    QVBoxLayout* charts = new QVBoxLayout();
+    wakeupChart = new ChartWidget("Max wake-up latency", container);
+    wakeupChart->setFormatter([](double value) { return QString("%1 us").arg(value, 0, 'f', 0); });
+    wakeupCpuChart = new ChartWidget("CPU", container);
+    wakeupCpuChart->setRange(0, 100);
+    wakeupCpuChart->setFormatter([](double value) { return QString("%1%").arg(value, 0, 'f', 0); });
+    wakeupCpuChart->addSeries(&systemMonitor.GetHistory(Series::CPU), QColor(0x1f, 0x77, 0xb4));
+    wakeupTemperatureChart = new ChartWidget("Temperature", container);
+    wakeupTemperatureChart->setFormatter([](double value) { return QString("%1°C").arg(value, 0, 'f', 0); });
+    wakeupTemperatureChart->addSeries(&systemMonitor.GetHistory(Series::Temperature), QColor(0xd6, 0x27, 0x28));
+    for (ChartWidget* chart : {wakeupChart, wakeupCpuChart, wakeupTemperatureChart}) {
+        chart->setWindow(60 * 1000000000ull);
+        charts->addWidget(chart);
     }
-    if (networkTabIndex >= 0 && networkTabIndex < networkInnerTabWidget->count()) {
-        networkInnerTabWidget->setCurrentIndex(networkTabIndex);
+    body->addLayout(charts, 2);
+    layout->addLayout(body);
+
+    connect(wakeupButton, &QPushButton::clicked, this, &MainWindow::toggleWakeupProbe);
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), wakeupTab, "Wake-up latency");
+}
+
+void MainWindow::setupStorageTab()
+{
+    using StorageBenchmark = Devices::StorageBenchmark;
+    storageTab = new QWidget();
+    QWidget* container = new QWidget(storageTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* target = new QHBoxLayout();
+    // В каталоге тест создаёт и удаляет собственный файл
+    storagePathEdit = new QLineEdit(QDir::tempPath(), container);
+    storageButton = new QPushButton("Start", container);
+    target->addWidget(new QLabel("Directory, file or device:", container));
+    target->addWidget(storagePathEdit, 1);
+    target->addWidget(storageButton);
+    layout->addLayout(target);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    storagePatternBox = new QComboBox(container);
+    for (StorageBenchmark::Pattern pattern :
+         {StorageBenchmark::Pattern::RandomRead, StorageBenchmark::Pattern::RandomWrite,
+          StorageBenchmark::Pattern::SequentialRead, StorageBenchmark::Pattern::SequentialWrite}) {
+        storagePatternBox->addItem(StorageBenchmark::GetPatternName(pattern), static_cast<int>(pattern));
+    }
+    storageBlockBox = new QComboBox(container);
+    for (int kibibytes : {4, 16, 64, 128, 1024}) {
+        storageBlockBox->addItem(kibibytes < 1024 ? QString("%1 KiB").arg(kibibytes) : QString("1 MiB"),
+                                 kibibytes * 1024);
+    }
+    storageDepthBox = new QComboBox(container);
+    for (int depth : {1, 4, 16, 32, 64, 128}) {
+        storageDepthBox->addItem(QString("QD %1").arg(depth), depth);
+    }
+    storageDepthBox->setCurrentIndex(3);
+    storageEngineBox = new QComboBox(container);
+    for (StorageBenchmark::Engine engine :
+         {StorageBenchmark::Engine::Auto, StorageBenchmark::Engine::IoUring,
+          StorageBenchmark::Engine::Aio, StorageBenchmark::Engine::Sync}) {
+        storageEngineBox->addItem(StorageBenchmark::GetEngineName(engine), static_cast<int>(engine));
+    }
+    storageDurationBox = new QSpinBox(container);
+    storageDurationBox->setRange(1, 3600);
+    storageDurationBox->setValue(30);
+    storageDurationBox->setSuffix(" s");
+    for (QWidget* control : std::initializer_list<QWidget*>{
+             storagePatternBox, storageBlockBox, storageDepthBox, storageEngineBox, storageDurationBox}) {
+        controls->addWidget(control);
+    }
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    storageStatusLabel = new QLabel(container);
+    layout->addWidget(storageStatusLabel);
+    storageDiskLabel = new QLabel(container);
+    layout->addWidget(storageDiskLabel);
+
+    QHBoxLayout* body = new QHBoxLayout();
+    storageLatencyTable = new QTableWidget(0, 3, container);
+    storageLatencyTable->setHorizontalHeaderLabels({"Latency up to", "Requests", "Share"});
+    storageLatencyTable->verticalHeader()->hide();
+    storageLatencyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    storageLatencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    storageLatencyTable->setFocusPolicy(Qt::NoFocus);
+    body->addWidget(storageLatencyTable, 1);
+
+    QVBoxLayout* charts = new QVBoxLayout();
+    storageIopsChart = new ChartWidget("IOPS", container);
+    storageIopsChart->setFormatter([](double value) { return QString::number(value, 'f', 0); });
+    storageIopsChart->addSeries(&storageBenchmark.GetIopsHistory(), QColor(0x1f, 0x77, 0xb4));
+    storageBandwidthChart = new ChartWidget("Bandwidth", container);
+    storageBandwidthChart->setFormatter([](double value) {
+        return QString::fromStdString(Devices::FormatBytes(static_cast<uint64_t>(value))) + "/s";
+    });
+    storageBandwidthChart->addSeries(&storageBenchmark.GetBandwidthHistory(), QColor(0x2c, 0xa0, 0x2c));
+    charts->addWidget(storageIopsChart);
+    charts->addWidget(storageBandwidthChart);
+    body->addLayout(charts, 1);
+    layout->addLayout(body);
+
+    connect(storageButton, &QPushButton::clicked, this, &MainWindow::toggleStorageBenchmark);
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), storageTab, "Storage benchmark");
+}
+
+bool MainWindow::addFleetAgent(const std::string& address, std::string& error)
+{
+    if (!fleet.AddAgent(address, error)) {
+        return false;
+    }
+    if (!fleetTab) {
+        setupFleetTab();
+    }
+    return true;
+}
+
+void MainWindow::setupFleetTab()
+{
+    using Series = Devices::PC::Series;
+    fleetTab = new QWidget();
+    QWidget* container = new QWidget(fleetTab);
+    container->setGeometry(10, 20, 701, 481);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    fleetMetricBox = new QComboBox(container);
+    fleetMetricBox->addItem("CPU", static_cast<int>(Series::CPU));
+    fleetMetricBox->addItem("Memory", static_cast<int>(Series::Memory));
+    fleetMetricBox->addItem("Temperature", static_cast<int>(Series::Temperature));
+    fleetMetricBox->addItem("Package power", static_cast<int>(Series::PackagePower));
+    fleetMetricBox->addItem("Network rx", static_cast<int>(Series::NetworkRx));
+    fleetMetricBox->addItem("Network tx", static_cast<int>(Series::NetworkTx));
+    controls->addWidget(new QLabel("Top hosts by:", container));
+    controls->addWidget(fleetMetricBox);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    fleetSummaryLabel = new QLabel(container);
+    layout->addWidget(fleetSummaryLabel);
+
+    fleetTable = new QTableWidget(0, 9, container);
+    fleetTable->setHorizontalHeaderLabels(
+        {"Host", "Agent", "CPU", "Memory", "Temperature", "Power", "Net rx", "Net tx", "Alerts"});
+    fleetTable->verticalHeader()->hide();
+    fleetTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    fleetTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    fleetTable->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(fleetTable);
+
+    connect(fleetMetricBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this]() { updateFleetTab(); });
+
+    // Кадры агентов разбираются по мере прихода, таблица - раз в секунду
+    fleetNotifier = new QSocketNotifier(fleet.GetFd(), QSocketNotifier::Read, this);
+    connect(fleetNotifier, &QSocketNotifier::activated, this, &MainWindow::onFleetEvents);
+    if (fleet.GetError() != 0) {
+        // Таймера переподключения нет: его заменяет QTimer окна
+        QTimer* reconnectTimer = new QTimer(fleetTab);
+        connect(reconnectTimer, &QTimer::timeout, this, &MainWindow::onFleetEvents);
+        reconnectTimer->start(1000);
+        ui->statusbar->showMessage(QString("Fleet reconnect timer: %1, falling back to QTimer")
+                                       .arg(strerror(fleet.GetError())));
+    }
+
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(ui->tab_2), fleetTab, "Fleet");
+}
+
+void MainWindow::onFleetEvents()
+{
+    uint64_t nowNs = Devices::Scheduler::Now();
+    fleet.ProcessEvents(nowNs);
+    if (!isMinimized() && ui->tabWidget->currentWidget() == fleetTab &&
+        nowNs - fleetRefreshNs >= 1000000000ull) {
+        updateFleetTab();
+    }
+}
+
+void MainWindow::updateFleetTab()
+{
+    using Series = Devices::PC::Series;
+    const Devices::FleetStore& store = fleet.GetStore();
+    uint64_t nowNs = Devices::Scheduler::Now();
+    fleetRefreshNs = nowNs;
+    auto series = static_cast<Series>(fleetMetricBox->currentData().toInt());
+
+    auto format = [](Series series, float value) {
+        switch (series) {
+        case Series::CPU:
+        case Series::Memory:
+            return QString("%1%").arg(value, 0, 'f', 1);
+        case Series::Temperature:
+            return QString("%1°C").arg(value, 0, 'f', 0);
+        case Series::PackagePower:
+            return QString("%1 W").arg(value, 0, 'f', 1);
+        default:
+            return QString::fromStdString(Devices::FormatBytes(static_cast<uint64_t>(value))) + "/s";
+        }
+    };
+
+    // Распределение по парку: кадры всех хостов уже слиты в один скетч ряда
+    fleetSketch.Clear();
+    store.GetQuantiles(series).MergeInto(Devices::SlidingQuantiles::Window::Minute, nowNs, fleetSketch);
+    fleetSummaryLabel->setText(
+        QString("Agents: %1 of %2 connected   Frames: %3   Fleet over 1 min: p50 %4, p99 %5")
+            .arg(fleet.GetConnectedCount())
+            .arg(store.GetHostCount())
+            .arg(fleet.GetFrameCount())
+            .arg(format(series, static_cast<float>(fleetSketch.GetQuantile(0.5))))
+            .arg(format(series, static_cast<float>(fleetSketch.GetQuantile(0.99)))));
+
+    store.GetTop(series, 20, nowNs, fleetTop);
+    if (fleetTable->rowCount() != static_cast<int>(fleetTop.size())) {
+        fleetTable->setRowCount(static_cast<int>(fleetTop.size()));
+    }
+    for (size_t row = 0; row < fleetTop.size(); ++row) {
+        uint32_t host = fleetTop[row];
+        QStringList values = {
+            toQString(store.GetName(host)),
+            toQString(store.GetAddress(host)),
+            format(Series::CPU, store.GetValue(host, Series::CPU)),
+            format(Series::Memory, store.GetValue(host, Series::Memory)),
+            format(Series::Temperature, store.GetValue(host, Series::Temperature)),
+            format(Series::PackagePower, store.GetValue(host, Series::PackagePower)),
+            format(Series::NetworkRx, store.GetValue(host, Series::NetworkRx)),
+            format(Series::NetworkTx, store.GetValue(host, Series::NetworkTx)),
+            QString::number(store.GetAlerts(host))};
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem* item = fleetTable->item(static_cast<int>(row), column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                fleetTable->setItem(static_cast<int>(row), column, item);
+            }
+            if (item->text() != values[column]) {
+                item->setText(values[column]);
+            }
+        }
+    }
+}
+
+void MainWindow::onSchedulerTimer()
+{
+    if (systemMonitor.GetScheduler().RunDue() > 0) {
+        updateSystemData();
+    }
+    armSchedulerFallback();
+}
+
+void MainWindow::armSchedulerFallback()
+{
+    // Без timerfd (или после сбоя его взвода) до ближайшего дедлайна
+    // планировщика ждёт одноразовый QTimer
+    Devices::Scheduler& scheduler = systemMonitor.GetScheduler();
+    int timeoutMs = scheduler.GetTimeoutMs();
+    if (scheduler.GetError() == 0 || timeoutMs < 0) {
+        return;
+    }
+    if (!schedulerFallback) {
+        schedulerFallback = new QTimer(this);
+        schedulerFallback->setSingleShot(true);
+        connect(schedulerFallback, &QTimer::timeout, this, &MainWindow::onSchedulerTimer);
+        ui->statusbar->showMessage(QString("Scheduler timerfd: %1, falling back to QTimer")
+                                       .arg(strerror(scheduler.GetError())));
+    }
+    schedulerFallback->start(timeoutMs);
+}
+
+void MainWindow::onProbeFinished()
+{
+    uint64_t finished = 0;
+    if (read(systemMonitor.GetProbeFd(), &finished, sizeof(finished)) > 0) {
+        updateSystemData();
+    }
+}
+
+void MainWindow::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        updateVisibility();
+        if (!isMinimized()) {
+            updateSystemData();
+        }
+    }
+}
+
+void MainWindow::updateSystemData()
+{
+    Devices::Diagnostics& diagnostics = Devices::Diagnostics::GetInstance();
+    static Devices::LatencyHistogram& tickTime = diagnostics.GetHistogram("GUI tick");
+    static Devices::LatencyHistogram& systemTabTime = diagnostics.GetHistogram("GUI updateSystemTab");
+    static Devices::LatencyHistogram& cpuViewTime = diagnostics.GetHistogram("GUI updateCpuView");
+    static Devices::LatencyHistogram& heatmapTime = diagnostics.GetHistogram("GUI updateHeatmap");
+    static Devices::LatencyHistogram& ramViewTime = diagnostics.GetHistogram("GUI updateRamView");
+    static Devices::LatencyHistogram& networkViewTime = diagnostics.GetHistogram("GUI updateNetworkView");
+    Devices::ScopedTimer tickTimer(tickTime);
+    tickArena.release();
+
+    systemMonitor.PollProbes();
+    diagnostics.SampleProcessUsage();
+    // Кривые теста пишутся на каждом замере, даже при скрытой вкладке
+    sampleStressTest();
+    wakeupProbe.Sample(Devices::Scheduler::Now());
+    storageBenchmark.Sample(Devices::Scheduler::Now());
+    if (isMinimized()) {
+        return;
+    }
+
+    // Обновляется только открытая вкладка. У каждой своё поколение снимка,
+    // так что изменения, пропущенные пока она была скрыта, она получает
+    // разом при следующем показе.
+    using Section = Devices::Snapshot::Section;
+    QWidget* current = ui->tabWidget->currentWidget();
+    if (current == ui->tab) {
+        if (pollChanges(systemGeneration) &&
+            (changes.Has(Section::System) || changes.Has(Section::PCI))) {
+            Devices::ScopedTimer timer(systemTabTime);
+            updateSystemTab();
+        }
+    } else if (current == ui->tab_3) {
+        if (pollChanges(cpuGeneration) && changes.Has(Section::CPU)) {
+            Devices::ScopedTimer timer(cpuViewTime);
+            updateCpuView();
+        }
+        Devices::ScopedTimer timer(heatmapTime);
+        cpuHeatmap->refresh();
+        updateLatencyMatrix();
+    } else if (current == ui->tab_4) {
+        if (pollChanges(ramGeneration) && changes.Has(Section::RAM)) {
+            Devices::ScopedTimer timer(ramViewTime);
+            updateRamView();
+        }
+    } else if (current == ui->tab_5) {
+        if (pollChanges(networkGeneration) &&
+            (changes.Has(Section::NetworkInterfaces) || changes.Has(Section::DNS))) {
+            Devices::ScopedTimer timer(networkViewTime);
+            updateNetworkView();
+        }
+    } else if (current == chartsTab) {
+        updateCharts();
+    } else if (current == statisticsTab) {
+        updateStatisticsTab();
+    } else if (current == diagnosticsTab) {
+        updateDiagnosticsTab();
+    } else if (current == stressTab) {
+        updateStressTab();
+    } else if (current == memoryBenchmarkTab) {
+        updateMemoryBenchmarkTab();
+    } else if (current == wakeupTab) {
+        updateWakeupTab();
+    } else if (current == storageTab) {
+        updateStorageTab();
+    } else if (fleetTab && current == fleetTab) {
+        updateFleetTab();
     }
 
     if (firstUpdate) {
@@ -77,10 +881,58 @@ void MainWindow::updateSystemData()
     }
 }
 
+bool MainWindow::pollChanges(uint64_t& seenGeneration)
+{
+    if (seenGeneration != 0 && seenGeneration == systemMonitor.GetGeneration()) {
+        return false;
+    }
+    systemMonitor.ChangedSince(seenGeneration, changes);
+    seenGeneration = changes.generation;
+    return true;
+}
+
+void MainWindow::updateVisibility()
+{
+    // Сборщики, результат которых сейчас нигде не показан, планировщик
+    // переводит на редкий опрос; свёрнутое окно не смотрит никто
+    using Collector = Devices::PC::Collector;
+    bool shown = !isMinimized();
+    QWidget* current = ui->tabWidget->currentWidget();
+    bool system = shown && current == ui->tab;
+    bool cpu = shown && current == ui->tab_3;
+    bool network = shown && current == ui->tab_5;
+    bool charts = shown && current == chartsTab;
+    // Квантили статистики копятся из тех же рядов, что и графики
+    bool statistics = shown && current == statisticsTab;
+    // Частота и температура нужны кривым нагрузочного теста, пока он идёт,
+    // загрузка - для сопоставления со всплесками задержки пробуждения
+    bool stress = stressTest.IsRunning();
+    bool wakeup = wakeupProbe.IsRunning();
+
+    systemMonitor.SetViewed(Collector::Uptime, system);
+    systemMonitor.SetViewed(Collector::CPU, system || cpu || charts || statistics || stress || wakeup);
+    systemMonitor.SetViewed(Collector::RAM, system || charts || statistics);
+    systemMonitor.SetViewed(Collector::NetworkAddresses, network);
+    systemMonitor.SetViewed(Collector::NetworkLinks, network);
+    systemMonitor.SetViewed(Collector::DNS, network);
+    systemMonitor.SetViewed(Collector::PCI, system);
+    systemMonitor.SetViewed(Collector::NetworkTraffic, charts || statistics);
+    systemMonitor.SetViewed(Collector::CoreFrequency, cpu || stress);
+    systemMonitor.SetViewed(Collector::PerfCounters, cpu);
+    // Возврат к просмотру приближает дедлайны
+    armSchedulerFallback();
+}
+
 void MainWindow::updateSystemTab()
 {
+    using Probe = Devices::PC::Probe;
+
     // Hostname
-    ui->hostnameLabel->setText(QString::fromStdString(systemMonitor.GetHostname()));
+    if (systemMonitor.IsReady(Probe::Hostname)) {
+        ui->hostnameLabel->setText(toQString(systemMonitor.GetHostname()));
+    } else {
+        ui->hostnameLabel->setText("Detecting...");
+    }
 
     // Uptime
     Devices::Uptime uptime = systemMonitor.GetUptime();
@@ -96,215 +948,800 @@ void MainWindow::updateSystemTab()
     ui->cpuUsageBar->setFormat(QString::number(cpuUsage, 'f', 1) + "%");
 
     // RAM Usage
-    int totalRAM = systemMonitor.GetRAMVolume();
-    int usedRAM = systemMonitor.GetUsedRAMVolume();
+    uint64_t totalRAM = systemMonitor.GetRAMVolume();
+    uint64_t usedRAM = systemMonitor.GetUsedRAMVolume();
     double ramPercent = (totalRAM > 0) ? (usedRAM * 100.0) / totalRAM : 0.0;
     ui->ramUsageBar->setValue(static_cast<int>(ramPercent));
     ui->ramUsageBar->setFormat(QString::number(ramPercent, 'f', 1) + "%");
 
+    if (!systemMonitor.IsReady(Probe::PCI)) {
+        ui->gpuLabel->setText("Detecting...");
+        ui->nicLabel->clear();
+        ui->nicLabel->addItem("Detecting...");
+        return;
+    }
+
     // GPU
-    auto gpus = systemMonitor.GetGPU();
+    Devices::View<Devices::InternedString> gpus = systemMonitor.GetGPU();
     QString gpuText;
     if (gpus.empty()) {
         gpuText = "-";
     } else {
         for (const auto& gpu : gpus) {
             if (!gpuText.isEmpty()) gpuText += "\n";
-            gpuText += QString::fromStdString(gpu.empty() ? "-" : gpu);
+            gpuText += toQString(gpu.View());
         }
     }
     ui->gpuLabel->setText(gpuText);
 
     // Network Controllers
-    auto nics = systemMonitor.GetNIControllers();
+    Devices::View<Devices::InternedString> nics = systemMonitor.GetNIControllers();
     QString nicText;
     if (nics.empty()) {
         nicText = "-";
     } else {
-        std::set<std::string> uniqueNics;
+        std::pmr::set<std::string_view> uniqueNics(&tickArena);
         for (const auto& nic : nics) {
-            uniqueNics.insert(nic.empty() ? "-" : nic);
+            uniqueNics.insert(nic.View());
         }
         for (const auto& nic : uniqueNics) {
             if (!nicText.isEmpty()) nicText += "\n";
-            nicText += QString::fromStdString(nic);
+            nicText += toQString(nic);
         }
     }
     ui->nicLabel->clear();
     ui->nicLabel->addItem(nicText);
 }
 
-void MainWindow::updateCpuTabs()
+void MainWindow::updateCpuView()
 {
-    auto cpus = systemMonitor.GetCPU();
+    cpuModel->refresh(changes);
+}
 
-    // Очищаем старые вкладки
-    while (cpuInnerTabWidget->count() > 0) {
-        QWidget* widget = cpuInnerTabWidget->widget(0);
-        cpuInnerTabWidget->removeTab(0);
-        delete widget;
+void MainWindow::toggleCoreLatencyTest()
+{
+    if (coreLatencyTest.IsRunning()) {
+        coreLatencyTest.Stop();
+    } else {
+        // Только включённые процессоры: выключенный нельзя закрепить
+        std::vector<unsigned> cpus;
+        for (const Devices::LogicalCPU& cpu : systemMonitor.GetLogicalCPUs()) {
+            if (cpu.online) {
+                cpus.push_back(cpu.id);
+            }
+        }
+        std::string error;
+        if (!coreLatencyTest.Start(cpus, error)) {
+            ui->statusbar->showMessage(QString("Core-to-core latency: %1").arg(toQString(error)));
+            return;
+        }
     }
+    updateLatencyMatrix();
+}
 
-    if (cpus.empty()) {
-        QWidget* tab = new QWidget();
-        QFormLayout* layout = new QFormLayout(tab);
-        QLabel* noCpuLabel = new QLabel("No CPU information available", tab);
-        layout->addWidget(noCpuLabel);
-        cpuInnerTabWidget->addTab(tab, "No CPU");
+void MainWindow::updateLatencyMatrix()
+{
+    // Матрица копируется и перерисовывается только при продвижении замера
+    bool running = coreLatencyTest.IsRunning();
+    unsigned progress = coreLatencyTest.GetProgress();
+    if (running == coreLatencyWasRunning && progress == coreLatencyProgress) {
         return;
     }
+    coreLatencyWasRunning = running;
+    coreLatencyProgress = progress;
+    coreLatencyButton->setText(running ? "Stop" : "Measure core-to-core latency");
+    coreLatencyLabel->setText(running ? QString("%1%").arg(progress) : QString());
+    coreLatencyTest.GetMatrix(coreLatencyCpus, coreLatencyValues);
+    latencyMatrix->setMatrix(coreLatencyCpus, coreLatencyValues);
+}
 
-    // Создаём новые вкладки с актуальными данными
-    for (size_t i = 0; i < cpus.size(); ++i) {
-        const auto& cpu = cpus[i];
-        QWidget* tab = new QWidget();
-        QFormLayout* layout = new QFormLayout(tab);
+void MainWindow::updateRamView()
+{
+    ramModel->refresh(changes);
+}
 
-        // Создаём и настраиваем все поля
-        auto addReadOnlyField = [&](const QString& label, const QString& value) {
-            QLineEdit* field = new QLineEdit(tab);
-            field->setReadOnly(true);
-            field->setFocusPolicy(Qt::NoFocus);
-            field->setText(value);
-            layout->addRow(label + ":", field);
-            return field;
-        };
+void MainWindow::updateNetworkView()
+{
+    networkModel->refresh(changes);
 
-        addReadOnlyField("Name", QString::fromStdString(cpu.GetName()));
-        addReadOnlyField("Cores", QString::number(cpu.GetCores()));
-        addReadOnlyField("Threads", QString::number(cpu.GetThreats()));
-        addReadOnlyField("Max Speed", QString::fromStdString(cpu.GetMaxSpeed()));
-        addReadOnlyField("Socket", QString::fromStdString(cpu.GetSocket()));
-        addReadOnlyField("L1 Cache", QString::fromStdString(cpu.GetL1Cache()));
-        addReadOnlyField("L2 Cache", QString::fromStdString(cpu.GetL2Cache()));
-        addReadOnlyField("L3 Cache", QString::fromStdString(cpu.GetL3Cache()));
-        addReadOnlyField("Temperature", QString("%1°C").arg(cpu.GetTemperature()));
+    // Список DNS перестраивается только когда ядро сообщило об изменении
+    using Section = Devices::Snapshot::Section;
+    if (!changes.IsStructureChanged(Section::DNS)) {
+        return;
+    }
+    std::pmr::set<std::string_view> uniqueDns(&tickArena);
+    for (const auto& dns : systemMonitor.GetDNS()) {
+        uniqueDns.insert(dns.View());
+    }
+    QStringList dnsList;
+    for (const auto& dns : uniqueDns) {
+        dnsList << toQString(dns);
+    }
+    if (dnsList.isEmpty()) {
+        dnsList << "-";
+    }
+    dnsModel->setStringList(dnsList);
+}
+
+void MainWindow::updateCharts()
+{
+    static Devices::LatencyHistogram& chartsTime =
+        Devices::Diagnostics::GetInstance().GetHistogram("GUI updateCharts");
+    Devices::ScopedTimer timer(chartsTime);
 
-        cpuInnerTabWidget->addTab(tab, QString("CPU %1").arg(i+1));
+    // Ядра находятся первым замером (и при hotplug), вектор истории ядра
+    // при этом перевыделяется - указатели берутся заново
+    Devices::View<Devices::History> cores = systemMonitor.GetCoreHistory();
+    if (coreChart->seriesCount() != static_cast<int>(cores.size())) {
+        coreChart->clearSeries();
+        for (size_t core = 0; core < cores.size(); ++core) {
+            coreChart->addSeries(&cores[core], QColor::fromHsv(
+                static_cast<int>(core * 360 / cores.size()), 200, 200));
+        }
+    }
+
+    uint64_t nowNs = Devices::Scheduler::Now();
+    for (ChartWidget* chart : {cpuChart, coreChart, memoryChart, networkChart, temperatureChart, powerChart}) {
+        chart->refresh(nowNs);
     }
 }
 
-void MainWindow::updateRamTabs()
+void MainWindow::updateStatisticsTab()
 {
-    auto rams = systemMonitor.GetRam();
+    using Series = Devices::PC::Series;
+    using Window = Devices::SlidingQuantiles::Window;
+    Window window = static_cast<Window>(statisticsWindowBox->currentData().toInt());
+    uint64_t nowNs = Devices::Scheduler::Now();
+
+    auto percent = [](double value) { return QString("%1%").arg(value, 0, 'f', 1); };
+    auto rate = [](double value) {
+        return QString::fromStdString(Devices::FormatBytes(static_cast<uint64_t>(value))) + "/s";
+    };
+    auto degrees = [](double value) { return QString("%1°C").arg(value, 0, 'f', 1); };
+    auto watts = [](double value) { return QString("%1 W").arg(value, 0, 'f', 1); };
 
-    // Очищаем старые вкладки
-    while (ramInnerTabWidget->count() > 0) {
-        QWidget* widget = ramInnerTabWidget->widget(0);
-        ramInnerTabWidget->removeTab(0);
-        delete widget;
+    // Строки и ячейки переиспользуются, как в таблице диагностики
+    int row = 0;
+    auto addRow = [&](const QString& name, const Devices::QuantileSketch& sketch,
+                      const std::function<QString(double)>& format) {
+        QStringList values = {name,
+                              format(sketch.GetQuantile(0.50)),
+                              format(sketch.GetQuantile(0.95)),
+                              format(sketch.GetQuantile(0.99)),
+                              format(sketch.GetMax()),
+                              QString::number(sketch.GetCount())};
+        if (statisticsTable->rowCount() <= row) {
+            statisticsTable->setRowCount(row + 1);
+        }
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem* item = statisticsTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                statisticsTable->setItem(row, column, item);
+            }
+            if (item->text() != values[column]) {
+                item->setText(values[column]);
+            }
+        }
+        ++row;
+    };
+    auto addSeries = [&](const QString& name, Series series,
+                         const std::function<QString(double)>& format) {
+        statisticsSketch.Clear();
+        systemMonitor.GetQuantiles(series).MergeInto(window, nowNs, statisticsSketch);
+        addRow(name, statisticsSketch, format);
+    };
+
+    addSeries("CPU", Series::CPU, percent);
+    // Все ядра - слияние скетчей ядер, сырые замеры не нужны
+    Devices::View<Devices::SlidingQuantiles> cores = systemMonitor.GetCoreQuantiles();
+    statisticsSketch.Clear();
+    for (const Devices::SlidingQuantiles& core : cores) {
+        core.MergeInto(window, nowNs, statisticsSketch);
+    }
+    addRow("CPU, all cores", statisticsSketch, percent);
+    for (size_t core = 0; core < cores.size(); ++core) {
+        statisticsSketch.Clear();
+        cores[core].MergeInto(window, nowNs, statisticsSketch);
+        addRow(QString("CPU %1").arg(core), statisticsSketch, percent);
+    }
+    addSeries("Memory used", Series::Memory, percent);
+    addSeries("Memory available", Series::MemoryAvailable, percent);
+    addSeries("Temperature", Series::Temperature, degrees);
+    addSeries("Package power", Series::PackagePower, watts);
+    addSeries("Network rx", Series::NetworkRx, rate);
+    addSeries("Network tx", Series::NetworkTx, rate);
+    for (const Devices::InterfaceTraffic& traffic : systemMonitor.GetInterfaceTraffic()) {
+        QString name = toQString(traffic.name.View());
+        statisticsSketch.Clear();
+        traffic.rxQuantiles.MergeInto(window, nowNs, statisticsSketch);
+        addRow(name + " rx", statisticsSketch, rate);
+        statisticsSketch.Clear();
+        traffic.txQuantiles.MergeInto(window, nowNs, statisticsSketch);
+        addRow(name + " tx", statisticsSketch, rate);
+    }
+    if (statisticsTable->rowCount() != row) {
+        statisticsTable->setRowCount(row);
+    }
+}
+
+void MainWindow::updateDiagnosticsTab()
+{
+    Devices::Diagnostics& diagnostics = Devices::Diagnostics::GetInstance();
+    Devices::ProcessUsage usage = diagnostics.GetProcessUsage();
+
+    diagnosticsSummaryLabel->setText(
+        QString("CPU: %1% of a core (budget %2%)%3   RSS: %4 MiB   "
+                "operator new: %5 (%6 per tick, %7 in collectors)   "
+                "malloc heap: %8 MiB (%9 B per tick)")
+            .arg(usage.cpuPercent, 0, 'f', 2)
+            .arg(Devices::Diagnostics::cpuBudgetPercent, 0, 'f', 0)
+            .arg(diagnostics.IsWithinBudget() ? "" : " OVER BUDGET")
+            .arg(usage.rssBytes / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(usage.allocations)
+            .arg(usage.allocationsPerTick)
+            .arg(usage.samplingAllocationsPerTick)
+            .arg(usage.heapInUse / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(usage.heapGrowthPerTick));
+
+    auto formatNs = [](uint64_t ns) {
+        if (ns >= 1000000) {
+            return QString("%1 ms").arg(ns / 1e6, 0, 'f', 2);
+        }
+        if (ns >= 1000) {
+            return QString("%1 us").arg(ns / 1e3, 0, 'f', 1);
+        }
+        return QString("%1 ns").arg(ns);
+    };
+
+    // Строки таблицы переиспользуются, добавляются только новые зонды.
+    // Имена не копируются: записи гистограмм живут до конца процесса
+    std::pmr::vector<std::pair<std::string_view, const Devices::LatencyHistogram*>> histograms(
+        &tickArena);
+    diagnostics.ForEachHistogram(
+        [&histograms](const std::string& name, const Devices::LatencyHistogram& histogram) {
+            histograms.emplace_back(name, &histogram);
+        });
+    if (diagnosticsTable->rowCount() != static_cast<int>(histograms.size())) {
+        diagnosticsTable->setRowCount(static_cast<int>(histograms.size()));
+    }
+    for (size_t row = 0; row < histograms.size(); ++row) {
+        const Devices::LatencyHistogram& histogram = *histograms[row].second;
+        QStringList values = {
+            toQString(histograms[row].first),
+            QString::number(histogram.GetCount()),
+            formatNs(static_cast<uint64_t>(histogram.GetMean())),
+            formatNs(histogram.GetPercentile(50)),
+            formatNs(histogram.GetPercentile(99)),
+            formatNs(histogram.GetMax())};
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem* item = diagnosticsTable->item(static_cast<int>(row), column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                diagnosticsTable->setItem(static_cast<int>(row), column, item);
+            }
+            if (item->text() != values[column]) {
+                item->setText(values[column]);
+            }
+        }
+    }
+}
+
+void MainWindow::toggleStressTest()
+{
+    using StressTest = Devices::StressTest;
+    if (stressTest.IsRunning()) {
+        stressTest.Stop();
+    } else {
+        StressTest::Options options;
+        options.kernel = static_cast<StressTest::Kernel>(stressKernelBox->currentData().toInt());
+        options.workload = static_cast<StressTest::Workload>(stressWorkloadBox->currentData().toInt());
+        options.loadPercent = static_cast<unsigned>(stressLoadBox->value());
+        options.durationNs = static_cast<uint64_t>(stressDurationBox->value()) * 1000000000ull;
+        std::string error;
+        if (!stressTest.Start(options, error)) {
+            ui->statusbar->showMessage(QString("Stress test: %1").arg(toQString(error)));
+            return;
+        }
+        for (ChartWidget* chart : {stressThroughputChart, stressFrequencyChart, stressTemperatureChart,
+                               stressPowerChart}) {
+            chart->setWindow(options.durationNs);
+        }
+        stressTable->setHorizontalHeaderLabels(
+            {"CPU", options.workload == StressTest::Workload::Float ? "GFLOPS" : "GIOPS"});
     }
+    sampleStressTest();
+    updateStressTab();
+}
 
-    if (rams.empty()) {
-        QWidget* tab = new QWidget();
-        QFormLayout* layout = new QFormLayout(tab);
-        QLabel* noRamLabel = new QLabel("No RAM information available", tab);
-        layout->addWidget(noRamLabel);
-        ramInnerTabWidget->addTab(tab, "No RAM");
+void MainWindow::sampleStressTest()
+{
+    bool running = stressTest.IsRunning();
+    if (!running && !stressWasRunning) {
         return;
     }
 
-    // Создаём новые вкладки
-    for (size_t i = 0; i < rams.size(); ++i) {
-        const auto& ram = rams[i];
-        QWidget* tab = new QWidget();
-        QFormLayout* layout = new QFormLayout(tab);
+    double frequency = 0;
+    size_t online = 0;
+    int32_t hottest = 0;
+    for (const Devices::LogicalCPU& cpu : systemMonitor.GetLogicalCPUs()) {
+        if (cpu.online) {
+            frequency += cpu.frequencyMHz;
+            ++online;
+            hottest = std::max(hottest, cpu.temperature);
+        }
+    }
+    double watts = 0;
+    for (const Devices::PowerDomain& domain : systemMonitor.GetPowerDomains()) {
+        if (domain.kind == Devices::PowerDomain::Kind::Package) {
+            watts += domain.watts;
+        }
+    }
+    stressTest.Sample(Devices::Scheduler::Now(), online ? frequency / online : 0, hottest / 1000.0,
+                      watts);
+
+    // Смена состояния (запуск или окончание по времени) меняет набор
+    // сборщиков, которые нужно опрашивать часто
+    if (running != stressWasRunning) {
+        stressWasRunning = running;
+        stressButton->setText(running ? "Stop" : "Start");
+        for (QWidget* control : std::initializer_list<QWidget*>{
+                 stressKernelBox, stressWorkloadBox, stressLoadBox, stressDurationBox}) {
+            control->setEnabled(!running);
+        }
+        updateVisibility();
+    }
+}
+
+void MainWindow::updateStressTab()
+{
+    static Devices::LatencyHistogram& stressTime =
+        Devices::Diagnostics::GetInstance().GetHistogram("GUI updateStressTab");
+    Devices::ScopedTimer timer(stressTime);
+
+    stressTest.GetResults(stressResults);
+    int rows = static_cast<int>(stressResults.size()) + 1;
+    if (stressTable->rowCount() != rows) {
+        stressTable->setRowCount(rows);
+    }
+    // Последняя строка - сумма по всем потокам
+    double total = 0;
+    auto setCell = [this](int row, int column, const QString& text) {
+        QTableWidgetItem* item = stressTable->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem();
+            stressTable->setItem(row, column, item);
+        }
+        if (item->text() != text) {
+            item->setText(text);
+        }
+    };
+    for (size_t row = 0; row < stressResults.size(); ++row) {
+        double gops = stressResults[row].GetGigaOpsPerSecond();
+        total += gops;
+        // Поток, не закреплённый за своим процессором, мерил не его
+        const Devices::StressTest::WorkerResult& result = stressResults[row];
+        setCell(static_cast<int>(row), 0,
+                result.affinityError == 0
+                    ? QString::number(result.cpu)
+                    : QString("%1 (not pinned: %2)").arg(result.cpu).arg(strerror(result.affinityError)));
+        setCell(static_cast<int>(row), 1, QString::number(gops, 'f', 2));
+    }
+    setCell(rows - 1, 0, "Total");
+    setCell(rows - 1, 1, QString::number(total, 'f', 2));
+
+    if (stressResults.empty()) {
+        stressStatusLabel->setText("Not run yet");
+    } else {
+        // Эффективность - по энергии RAPL за прогон, без RAPL не показывается
+        double opsPerJoule = stressTest.GetOpsPerJoule();
+        stressStatusLabel->setText(
+            QString("%1 kernel, %2 threads%3%4")
+                .arg(Devices::StressTest::GetKernelName(stressTest.GetKernel()))
+                .arg(stressResults.size())
+                .arg(opsPerJoule > 0 ? QString(", %1 GOPS/W").arg(opsPerJoule / 1e9, 0, 'f', 2)
+                                     : QString())
+                .arg(stressTest.IsRunning() ? ", running" : ", finished"));
+    }
+
+    uint64_t nowNs = Devices::Scheduler::Now();
+    for (ChartWidget* chart : {stressThroughputChart, stressFrequencyChart, stressTemperatureChart,
+                               stressPowerChart}) {
+        chart->refresh(nowNs);
+    }
+}
 
-        auto addReadOnlyField = [&](const QString& label, const QString& value) {
-            QLineEdit* field = new QLineEdit(tab);
-            field->setReadOnly(true);
-            field->setFocusPolicy(Qt::NoFocus);
-            field->setText(value);
-            layout->addRow(label + ":", field);
-        };
+void MainWindow::toggleMemoryBenchmark()
+{
+    if (memoryBenchmark.IsRunning()) {
+        memoryBenchmark.Stop();
+        updateMemoryBenchmarkTab();
+        return;
+    }
 
-        addReadOnlyField("Name", QString::fromStdString(ram.GetName()));
-        addReadOnlyField("Size", QString::fromStdString(ram.GetSize()));
-        addReadOnlyField("Type", QString::fromStdString(ram.GetType()));
-        addReadOnlyField("Speed", QString::fromStdString(ram.GetSpeed()));
-        addReadOnlyField("Manufacturer", QString::fromStdString(ram.GetManufacturer()));
-        addReadOnlyField("Form Factor", QString::fromStdString(ram.GetFormFactor()));
-        addReadOnlyField("Channel", QString::fromStdString(ram.GetChannel()));
-        addReadOnlyField("Rank", QString::number(ram.GetRank()));
+    Devices::View<Devices::LogicalCPU> cpus = systemMonitor.GetLogicalCPUs();
+    Devices::MemoryBenchmark::Options options;
+    options.threads = static_cast<unsigned>(memoryThreadsBox->value());
+    options.memoryNode = memoryNodeBox->currentData().toInt();
+    options.maxWorkingSet = static_cast<size_t>(memoryWorkingSetBox->currentData().toInt()) << 20;
+    int cpuNode = memoryCpuNodeBox->currentData().toInt();
+    if (cpuNode >= 0) {
+        for (const Devices::LogicalCPU& cpu : cpus) {
+            if (cpu.online && cpu.node == cpuNode) {
+                options.cpus.push_back(cpu.id);
+            }
+        }
+    }
+    // Массивы STREAM - не меньше четырёх объёмов последнего кэша всех
+    // его экземпляров (CCX, сокеты)
+    uint64_t lastLevelCache = 0;
+    Devices::View<Devices::CacheLevel> caches = systemMonitor.GetCaches();
+    if (!caches.empty()) {
+        lastLevelCache = caches.back().size * caches.back().instances;
+    }
+    options.arrayBytes = std::max<size_t>(options.arrayBytes, 4 * lastLevelCache);
 
-        ramInnerTabWidget->addTab(tab, QString("RAM %1").arg(i+1));
+    std::string error;
+    if (!memoryBenchmark.Start(options, error)) {
+        ui->statusbar->showMessage(QString("Memory benchmark: %1").arg(toQString(error)));
+        return;
     }
+    updateMemoryBenchmarkTab();
 }
 
-void MainWindow::updateNetworkTabs()
+void MainWindow::updateMemoryBenchmarkTab()
 {
-    auto interfaces = systemMonitor.GetNIs();
+    using Test = Devices::MemoryBenchmark::Test;
+    updateMemoryNodes();
+    bool running = memoryBenchmark.IsRunning();
+    memoryBenchmarkButton->setText(running ? "Stop" : "Start");
+    for (QWidget* control : std::initializer_list<QWidget*>{
+             memoryThreadsBox, memoryCpuNodeBox, memoryNodeBox, memoryWorkingSetBox}) {
+        control->setEnabled(!running);
+    }
 
-    // Удаляем дубликаты интерфейсов
-    std::unordered_set<std::string> seenInterfaces;
-    std::vector<Devices::NetworkInterface> uniqueInterfaces;
+    memoryBenchmark.GetResults(memoryResults);
+    memoryBenchmarkProgress->setValue(static_cast<int>(memoryResults.progress));
 
-    for (const auto& net : interfaces) {
-        if (seenInterfaces.insert(net.GetName()).second) {
-            uniqueInterfaces.push_back(net);
+    auto setCell = [](QTableWidget* table, int row, int column, const QString& text) {
+        QTableWidgetItem* item = table->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem();
+            table->setItem(row, column, item);
         }
+        if (item->text() != text) {
+            item->setText(text);
+        }
+    };
+
+    // Уровень, в который набор помещается по данным sysfs: перегиб
+    // латентности должен приходиться на его границу
+    uint64_t caches[3] = {};
+    Devices::View<Devices::CPU> processors = systemMonitor.GetCPU();
+    if (!processors.empty()) {
+        caches[0] = processors[0].GetL1Cache();
+        caches[1] = processors[0].GetL2Cache();
+        caches[2] = processors[0].GetL3Cache();
+    }
+    latencyTable->setRowCount(static_cast<int>(memoryResults.latency.size()));
+    for (size_t row = 0; row < memoryResults.latency.size(); ++row) {
+        const Devices::MemoryBenchmark::LatencyPoint& point = memoryResults.latency[row];
+        QString level = "RAM";
+        for (int index = 0; index < 3; ++index) {
+            if (caches[index] != 0 && point.workingSet <= caches[index]) {
+                level = QString("L%1").arg(index + 1);
+                break;
+            }
+        }
+        int line = static_cast<int>(row);
+        setCell(latencyTable, line, 0, toQString(Devices::FormatBytes(point.workingSet)));
+        setCell(latencyTable, line, 1, QString("%1 ns").arg(point.nsPerLoad, 0, 'f', 2));
+        setCell(latencyTable, line, 2, level);
     }
 
-    // Очищаем старые вкладки
-    while (networkInnerTabWidget->count() > 0) {
-        QWidget* widget = networkInnerTabWidget->widget(0);
-        networkInnerTabWidget->removeTab(0);
-        delete widget;
+    const int tests = static_cast<int>(Test::Count);
+    bandwidthTable->setRowCount(tests);
+    double triad = 0;
+    for (int row = 0; row < tests; ++row) {
+        setCell(bandwidthTable, row, 0, Devices::MemoryBenchmark::GetTestName(static_cast<Test>(row)));
+        setCell(bandwidthTable, row, 1, "-");
+        setCell(bandwidthTable, row, 2, "-");
     }
+    for (const Devices::MemoryBenchmark::Bandwidth& result : memoryResults.bandwidth) {
+        setCell(bandwidthTable, static_cast<int>(result.test), result.nonTemporal ? 2 : 1,
+                QString("%1 GB/s").arg(result.bytesPerSecond / 1e9, 0, 'f', 1));
+        if (result.test == Test::Triad) {
+            triad = std::max(triad, result.bytesPerSecond);
+        }
+    }
+
+    // Пик по DMI: 8 байт за передачу на каждый занятый канал. Заметно
+    // меньшая доля пика при полном числе потоков - признак того, что
+    // модули стоят не во всех каналах или работают на пониженной частоте.
+    std::pmr::set<std::string_view> channels(&tickArena);
+    uint32_t speed = 0;
+    for (const Devices::RAM& module : systemMonitor.GetRam()) {
+        if (module.GetSize() != 0) {
+            channels.insert(module.GetChannel());
+            speed = speed == 0 ? module.GetSpeed() : std::min(speed, module.GetSpeed());
+        }
+    }
+    double peak = static_cast<double>(channels.size()) * speed * 1e6 * 8;
+    QString summary;
+    if (!memoryResults.error.empty()) {
+        summary = QString("Error: %1").arg(toQString(memoryResults.error));
+    } else if (triad > 0 && peak > 0) {
+        summary = QString("Triad %1 GB/s = %2% of %3 GB/s theoretical peak (%4 channel(s) x %5 MT/s)")
+                      .arg(triad / 1e9, 0, 'f', 1)
+                      .arg(100 * triad / peak, 0, 'f', 0)
+                      .arg(peak / 1e9, 0, 'f', 1)
+                      .arg(channels.size())
+                      .arg(speed);
+    } else if (running) {
+        summary = "Measuring...";
+    }
+    if (memoryBenchmarkLabel->text() != summary) {
+        memoryBenchmarkLabel->setText(summary);
+    }
+}
 
-    if (uniqueInterfaces.empty()) {
-        QWidget* tab = new QWidget();
-        QFormLayout* layout = new QFormLayout(tab);
-        QLabel* noInterfacesLabel = new QLabel("No network interfaces found", tab);
-        layout->addWidget(noInterfacesLabel);
-        networkInnerTabWidget->addTab(tab, "No Interfaces");
+void MainWindow::toggleWakeupProbe()
+{
+    if (wakeupProbe.IsRunning()) {
+        wakeupProbe.Stop();
     } else {
-        for (size_t i = 0; i < uniqueInterfaces.size(); ++i) {
-            const auto& net = uniqueInterfaces[i];
-            QWidget* tab = new QWidget();
-            QFormLayout* layout = new QFormLayout(tab);
-
-            auto addReadOnlyField = [&](const QString& label, const QString& value) {
-                QLineEdit* field = new QLineEdit(tab);
-                field->setReadOnly(true);
-                field->setFocusPolicy(Qt::NoFocus);
-                field->setText(value);
-                layout->addRow(label + ":", field);
-            };
+        Devices::WakeupLatencyProbe::Options options;
+        for (const Devices::LogicalCPU& cpu : systemMonitor.GetLogicalCPUs()) {
+            if (cpu.online) {
+                options.cpus.push_back(cpu.id);
+            }
+        }
+        options.intervalNs = static_cast<uint64_t>(wakeupIntervalBox->currentData().toInt()) * 1000;
+        // Приоритет как у cyclictest по умолчанию: выше прерываний в потоках
+        options.priority = wakeupRealtimeBox->isChecked() ? 80 : 0;
+        std::string error;
+        if (!wakeupProbe.Start(options, error)) {
+            ui->statusbar->showMessage(QString("Wake-up latency: %1").arg(toQString(error)));
+            return;
+        }
+        wakeupChart->clearSeries();
+        size_t count = wakeupProbe.GetCpuCount();
+        for (size_t index = 0; index < count; ++index) {
+            wakeupChart->addSeries(&wakeupProbe.GetHistory(index), QColor::fromHsv(
+                static_cast<int>(index * 360 / count), 200, 200));
+        }
+    }
+    bool running = wakeupProbe.IsRunning();
+    wakeupButton->setText(running ? "Stop" : "Start");
+    wakeupIntervalBox->setEnabled(!running);
+    wakeupRealtimeBox->setEnabled(!running);
+    updateVisibility();
+    updateWakeupTab();
+}
 
-            addReadOnlyField("Interface Name", QString::fromStdString(net.GetName()));
-            addReadOnlyField("IPv4", QString::fromStdString(net.GetIpv4()));
-            addReadOnlyField("IPv6", QString::fromStdString(net.GetIpv6()));
-            addReadOnlyField("IPv4 Netmask", QString::fromStdString(net.GetIpv4Netmask()));
-            addReadOnlyField("IPv6 Netmask", QString::fromStdString(net.GetIpv6Netmask()));
-            addReadOnlyField("MAC Address", QString::fromStdString(net.GetMac()));
-            addReadOnlyField("Gateway", QString::fromStdString(net.GatGateway()));
+void MainWindow::updateWakeupTab()
+{
+    static Devices::LatencyHistogram& wakeupTime =
+        Devices::Diagnostics::GetInstance().GetHistogram("GUI updateWakeupTab");
+    Devices::ScopedTimer timer(wakeupTime);
 
-            networkInnerTabWidget->addTab(tab, QString("Interface %1").arg(i+1));
+    auto formatUs = [](uint64_t ns) { return QString("%1 us").arg(ns / 1e3, 0, 'f', 1); };
+    size_t count = wakeupProbe.GetCpuCount();
+    if (wakeupTable->rowCount() != static_cast<int>(count)) {
+        wakeupTable->setRowCount(static_cast<int>(count));
+    }
+    QString failures;
+    for (size_t row = 0; row < count; ++row) {
+        const Devices::LatencyHistogram& histogram = wakeupProbe.GetHistogram(row);
+        unsigned cpu = wakeupProbe.GetCpu(row);
+        // Незакреплённый поток мерил не свой процессор
+        int affinityError = wakeupProbe.GetAffinityError(row);
+        if (int sleepError = wakeupProbe.GetSleepError(row)) {
+            failures += QString(", CPU %1 stopped: %2").arg(cpu).arg(strerror(sleepError));
+        }
+        QStringList values = {
+            affinityError == 0 ? QString::number(cpu)
+                               : QString("%1 (not pinned: %2)").arg(cpu).arg(strerror(affinityError)),
+            QString::number(histogram.GetCount()),
+            formatUs(histogram.GetMin()),
+            formatUs(static_cast<uint64_t>(histogram.GetMean())),
+            formatUs(histogram.GetPercentile(99)),
+            formatUs(histogram.GetMax())};
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem* item = wakeupTable->item(static_cast<int>(row), column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                wakeupTable->setItem(static_cast<int>(row), column, item);
+            }
+            if (item->text() != values[column]) {
+                item->setText(values[column]);
+            }
         }
     }
 
-    // Вкладка DNS
-    QWidget* dnsTab = new QWidget();
-    QFormLayout* dnsLayout = new QFormLayout(dnsTab);
-    QListWidget* dnsLabel = new QListWidget(dnsTab);
-    dnsLabel->setFocusPolicy(Qt::NoFocus);
-    dnsLayout->addRow("DNS Servers:", dnsLabel);
+    QString status;
+    if (wakeupProbe.IsRunning()) {
+        status = wakeupProbe.IsRealtime() || !wakeupRealtimeBox->isChecked()
+                     ? "Running"
+                     : "Running without SCHED_FIFO (no permission)";
+        status += failures;
+    }
+    if (wakeupStatusLabel->text() != status) {
+        wakeupStatusLabel->setText(status);
+    }
 
-    auto dnsList = systemMonitor.GetDNS();
-    if (dnsList.empty()) {
-        dnsLabel->addItem("-");
-    } else {
-        std::set<std::string> uniqueDns;
-        for (const auto& dns : dnsList) {
-            uniqueDns.insert(dns.empty() ? "-" : dns);
+    uint64_t nowNs = Devices::Scheduler::Now();
+    for (ChartWidget* chart : {wakeupChart, wakeupCpuChart, wakeupTemperatureChart}) {
+        chart->refresh(nowNs);
+    }
+}
+
+void MainWindow::toggleStorageBenchmark()
+{
+    using StorageBenchmark = Devices::StorageBenchmark;
+    if (storageBenchmark.IsRunning()) {
+        storageBenchmark.Stop();
+        updateStorageTab();
+        return;
+    }
+
+    StorageBenchmark::Options options;
+    options.path = storagePathEdit->text().toStdString();
+    options.pattern = static_cast<StorageBenchmark::Pattern>(storagePatternBox->currentData().toInt());
+    options.engine = static_cast<StorageBenchmark::Engine>(storageEngineBox->currentData().toInt());
+    options.blockSize = storageBlockBox->currentData().toUInt();
+    options.queueDepth = storageDepthBox->currentData().toUInt();
+    options.durationNs = static_cast<uint64_t>(storageDurationBox->value()) * 1000000000ull;
+
+    bool write = options.pattern == StorageBenchmark::Pattern::RandomWrite ||
+                 options.pattern == StorageBenchmark::Pattern::SequentialWrite;
+    struct stat info{};
+    if (write && stat(options.path.c_str(), &info) == 0 && S_ISBLK(info.st_mode)) {
+        QMessageBox::StandardButton answer = QMessageBox::warning(
+            this, "Storage benchmark",
+            QString("Writing to %1 destroys all data on the device. Continue?")
+                .arg(storagePathEdit->text()),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (answer != QMessageBox::Yes) {
+            return;
+        }
+        options.allowDeviceWrites = true;
+    }
+
+    std::string error;
+    if (!storageBenchmark.Start(options, error)) {
+        ui->statusbar->showMessage(QString("Storage benchmark: %1").arg(toQString(error)));
+        return;
+    }
+    storageDiskStatsNs = 0;
+    for (ChartWidget* chart : {storageIopsChart, storageBandwidthChart}) {
+        chart->setWindow(options.durationNs);
+    }
+    updateStorageTab();
+}
+
+void MainWindow::updateStorageTab()
+{
+    using StorageBenchmark = Devices::StorageBenchmark;
+    storageBenchmark.GetStatus(storageStatus);
+    bool running = storageStatus.running;
+    storageButton->setText(running ? "Stop" : "Start");
+    for (QWidget* control : std::initializer_list<QWidget*>{
+             storagePathEdit, storagePatternBox, storageBlockBox, storageDepthBox,
+             storageEngineBox, storageDurationBox}) {
+        control->setEnabled(!running);
+    }
+
+    QString status;
+    if (!storageStatus.error.empty()) {
+        status = QString("Error: %1").arg(toQString(storageStatus.error));
+    } else if (storageStatus.elapsedNs > 0) {
+        double seconds = storageStatus.elapsedNs / 1e9;
+        const Devices::LatencyHistogram& latency = storageBenchmark.GetHistogram();
+        status = QString("%1%2%3: %4 IOPS, %5/s, %6 errors; latency p50 %7 us, p99 %8 us, max %9 us")
+                     .arg(StorageBenchmark::GetEngineName(storageStatus.engine))
+                     .arg(storageStatus.registeredBuffers ? " (registered buffers)" : "")
+                     .arg(storageStatus.direct ? ", O_DIRECT" : ", buffered")
+                     .arg(storageStatus.operations / seconds, 0, 'f', 0)
+                     .arg(toQString(Devices::FormatBytes(
+                         static_cast<uint64_t>(storageStatus.bytes / seconds))))
+                     .arg(storageStatus.errors)
+                     .arg(latency.GetPercentile(50) / 1e3, 0, 'f', 0)
+                     .arg(latency.GetPercentile(99) / 1e3, 0, 'f', 0)
+                     .arg(latency.GetMax() / 1e3, 0, 'f', 0);
+    }
+    if (storageStatusLabel->text() != status) {
+        storageStatusLabel->setText(status);
+    }
+
+    // Счётчики устройства за интервал между обновлениями вкладки
+    Devices::DiskStats previous = storageDiskStats;
+    uint64_t previousNs = storageDiskStatsNs;
+    uint64_t nowNs = Devices::Scheduler::Now();
+    if (storageBenchmark.GetDiskStats(storageDiskStats)) {
+        storageDiskStatsNs = nowNs;
+        if (previousNs != 0 && nowNs > previousNs) {
+            double seconds = (nowNs - previousNs) / 1e9;
+            auto rate = [seconds](uint64_t now, uint64_t before) {
+                return now >= before ? (now - before) / seconds : 0.0;
+            };
+            storageDiskLabel->setText(
+                QString("%1: %2 r/s  %3 w/s  read %4/s  write %5/s  in flight %6  util %7%")
+                    .arg(storageDiskStats.name)
+                    .arg(rate(storageDiskStats.reads, previous.reads), 0, 'f', 0)
+                    .arg(rate(storageDiskStats.writes, previous.writes), 0, 'f', 0)
+                    .arg(toQString(Devices::FormatBytes(static_cast<uint64_t>(
+                        rate(storageDiskStats.readSectors, previous.readSectors) * 512))))
+                    .arg(toQString(Devices::FormatBytes(static_cast<uint64_t>(
+                        rate(storageDiskStats.writeSectors, previous.writeSectors) * 512))))
+                    .arg(storageDiskStats.inFlight)
+                    .arg(std::min(100.0, rate(storageDiskStats.ioTicksMs, previous.ioTicksMs) / 10),
+                         0, 'f', 0));
         }
-        for (const auto& dns : uniqueDns) {
-            dnsLabel->addItem(QString::fromStdString(dns));
+    } else if (storageStatus.elapsedNs > 0) {
+        storageDiskLabel->setText("Device statistics are not available for this file system");
+    }
+
+    // Полная гистограмма: строка на каждую непустую корзину
+    const Devices::LatencyHistogram& histogram = storageBenchmark.GetHistogram();
+    uint64_t total = histogram.GetCount();
+    int row = 0;
+    for (size_t bucket = 0; bucket < Devices::LatencyHistogram::bucketCount; ++bucket) {
+        uint64_t count = histogram.GetBucket(bucket);
+        if (count == 0) {
+            continue;
+        }
+        if (storageLatencyTable->rowCount() <= row) {
+            storageLatencyTable->setRowCount(row + 1);
         }
+        uint64_t upper = Devices::LatencyHistogram::BucketUpperBound(bucket);
+        QStringList values = {
+            upper >= 1000000 ? QString("%1 ms").arg(upper / 1e6, 0, 'f', 2)
+                             : QString("%1 us").arg(upper / 1e3, 0, 'f', 1),
+            QString::number(count),
+            QString("%1%").arg(100.0 * count / total, 0, 'f', 2)};
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem* item = storageLatencyTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                storageLatencyTable->setItem(row, column, item);
+            }
+            if (item->text() != values[column]) {
+                item->setText(values[column]);
+            }
+        }
+        ++row;
+    }
+    if (storageLatencyTable->rowCount() != row) {
+        storageLatencyTable->setRowCount(row);
     }
 
-    networkInnerTabWidget->addTab(dnsTab, "DNS");
+    for (ChartWidget* chart : {storageIopsChart, storageBandwidthChart}) {
+        chart->refresh(nowNs);
+    }
+}
+
+void MainWindow::showAlert(const Devices::AlertEngine::Event& event)
+{
+    Devices::AlertEngine& alerts = systemMonitor.GetAlerts();
+    auto describe = [&alerts](uint32_t rule) {
+        return QString("Alert: %1 (now %2)")
+            .arg(QString::fromStdString(alerts.GetRuleText(rule)))
+            .arg(alerts.GetValue(rule), 0, 'f', 1);
+    };
+
+    if (event.firing) {
+        ui->statusbar->showMessage(describe(event.rule));
+        return;
+    }
+    // Снятое оповещение уступает место любому ещё активному
+    for (uint32_t rule = 0; rule < alerts.GetRuleCount(); ++rule) {
+        if (alerts.IsFiring(rule)) {
+            ui->statusbar->showMessage(describe(rule));
+            return;
+        }
+    }
+    ui->statusbar->clearMessage();
 }
 
 void MainWindow::updateAboutTab()
@@ -315,5 +1752,6 @@ void MainWindow::updateAboutTab()
 
 MainWindow::~MainWindow()
 {
+    systemMonitor.GetAlerts().Unsubscribe(alertSubscription);
     delete ui;
 }
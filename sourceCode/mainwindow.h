@@ -2,9 +2,33 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QSocketNotifier>
 #include <QTimer>
 #include <QTabWidget>
+#include <QTableWidget>
+#include <QTableView>
+#include <QStringListModel>
+#include <QLabel>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
 #include "SysMonCore.hpp"
+#include "StressTest.hpp"
+#include "MemoryBenchmark.hpp"
+#include "CoreLatencyTest.hpp"
+#include "WakeupLatencyProbe.hpp"
+#include "StorageBenchmark.hpp"
+#include "FleetAggregator.hpp"
+#include "devicemodels.h"
+#include "chartwidget.h"
+#include "heatmapwidget.h"
+#include "latencymatrixwidget.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -18,26 +42,180 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Агент парка ("host:port"); первый добавленный открывает вкладку Fleet
+    bool addFleetAgent(const std::string& address, std::string& error);
+
+protected:
+    void changeEvent(QEvent* event) override;
+
 private slots:
+    void onSchedulerTimer();
+    void onProbeFinished();
+    void onFleetEvents();
     void updateSystemData();
 
 private:
     Ui::MainWindow *ui;
-    QTimer *updateTimer;
+    QSocketNotifier *schedulerNotifier = nullptr;
+    QTimer *schedulerFallback = nullptr;
+    QSocketNotifier *probeNotifier;
     Devices::PC& systemMonitor;
 
-    QTabWidget* cpuInnerTabWidget;
-    QTabWidget* ramInnerTabWidget;
-    QTabWidget* networkInnerTabWidget;
+    CpuTableModel* cpuModel;
+    RamTableModel* ramModel;
+    NetworkTableModel* networkModel;
+    QStringListModel* dnsModel;
+    QTableView* cpuView;
+    HeatmapWidget* cpuHeatmap;
+    LatencyMatrixWidget* latencyMatrix;
+    QPushButton* coreLatencyButton;
+    QLabel* coreLatencyLabel;
+    Devices::CoreLatencyTest coreLatencyTest;
+    std::vector<unsigned> coreLatencyCpus;
+    std::vector<float> coreLatencyValues;
+    unsigned coreLatencyProgress = 0;
+    bool coreLatencyWasRunning = false;
+    QTableView* ramView;
+    QTableView* networkView;
+
+    ChartWidget* cpuChart;
+    ChartWidget* coreChart;
+    ChartWidget* memoryChart;
+    ChartWidget* networkChart;
+    ChartWidget* temperatureChart;
+    ChartWidget* powerChart;
+
+    QTableWidget* diagnosticsTable;
+    QLabel* diagnosticsSummaryLabel;
+
+    QWidget* chartsTab;
+    QWidget* statisticsTab;
+    QComboBox* statisticsWindowBox;
+    QTableWidget* statisticsTable;
+    Devices::QuantileSketch statisticsSketch;
+    QWidget* diagnosticsTab;
+
+    QWidget* stressTab;
+    QComboBox* stressKernelBox;
+    QComboBox* stressWorkloadBox;
+    QSpinBox* stressLoadBox;
+    QSpinBox* stressDurationBox;
+    QPushButton* stressButton;
+    QLabel* stressStatusLabel;
+    QTableWidget* stressTable;
+    ChartWidget* stressThroughputChart;
+    ChartWidget* stressFrequencyChart;
+    ChartWidget* stressTemperatureChart;
+    ChartWidget* stressPowerChart;
+    Devices::StressTest stressTest;
+    std::vector<Devices::StressTest::WorkerResult> stressResults;
+    bool stressWasRunning = false;
+
+    QWidget* memoryBenchmarkTab;
+    QSpinBox* memoryThreadsBox;
+    QComboBox* memoryCpuNodeBox;
+    QComboBox* memoryNodeBox;
+    QComboBox* memoryWorkingSetBox;
+    QPushButton* memoryBenchmarkButton;
+    QProgressBar* memoryBenchmarkProgress;
+    QLabel* memoryBenchmarkLabel;
+    QTableWidget* latencyTable;
+    QTableWidget* bandwidthTable;
+    Devices::MemoryBenchmark memoryBenchmark;
+    Devices::MemoryBenchmark::Results memoryResults;
+    uint64_t memoryNodesVersion = 0;
+
+    QWidget* wakeupTab;
+    QComboBox* wakeupIntervalBox;
+    QCheckBox* wakeupRealtimeBox;
+    QPushButton* wakeupButton;
+    QLabel* wakeupStatusLabel;
+    QTableWidget* wakeupTable;
+    ChartWidget* wakeupChart;
+    ChartWidget* wakeupCpuChart;
+    ChartWidget* wakeupTemperatureChart;
+    Devices::WakeupLatencyProbe wakeupProbe;
+
+    QWidget* storageTab;
+    QLineEdit* storagePathEdit;
+    QComboBox* storagePatternBox;
+    QComboBox* storageBlockBox;
+    QComboBox* storageDepthBox;
+    QComboBox* storageEngineBox;
+    QSpinBox* storageDurationBox;
+    QPushButton* storageButton;
+    QLabel* storageStatusLabel;
+    QLabel* storageDiskLabel;
+    QTableWidget* storageLatencyTable;
+    ChartWidget* storageIopsChart;
+    ChartWidget* storageBandwidthChart;
+    Devices::StorageBenchmark storageBenchmark;
+    Devices::StorageBenchmark::Status storageStatus;
+    Devices::DiskStats storageDiskStats;
+    uint64_t storageDiskStatsNs = 0;
+
+    QWidget* fleetTab = nullptr;
+    QComboBox* fleetMetricBox;
+    QLabel* fleetSummaryLabel;
+    QTableWidget* fleetTable;
+    QSocketNotifier* fleetNotifier;
+    Devices::FleetAggregator fleet;
+    std::vector<uint32_t> fleetTop;
+    Devices::QuantileSketch fleetSketch;
+    uint64_t fleetRefreshNs = 0;
+
+    size_t alertSubscription = 0;
 
     bool firstUpdate = true;
+    // Поколение снимка, до которого обновлена каждая вкладка
+    uint64_t systemGeneration = 0;
+    uint64_t cpuGeneration = 0;
+    uint64_t ramGeneration = 0;
+    uint64_t networkGeneration = 0;
+    Devices::ChangeSet changes;
+    // Временные наборы одного такта (уникальные DNS и контроллеры, список
+    // зондов диагностики) живут в арене: она освобождается целиком в
+    // начале следующего такта, и пока хватает буфера, глобальный
+    // аллокатор для них не вызывается. Только для них: QString текста
+    // ячеек и подписей по-прежнему идут в кучу и видны в счётчике
+    // operator new на такт.
+    std::array<std::byte, 16 * 1024> tickBuffer;
+    std::pmr::monotonic_buffer_resource tickArena{tickBuffer.data(), tickBuffer.size()};
 
     void setupInnerTabs();
+    void setupChartsTab();
+    void setupStatisticsTab();
+    void setupDiagnosticsTab();
+    void setupStressTab();
+    void setupMemoryBenchmarkTab();
+    void setupWakeupTab();
+    void setupStorageTab();
+    void setupFleetTab();
+    bool pollChanges(uint64_t& seenGeneration);
+    void updateVisibility();
+    void armSchedulerFallback();
     void updateSystemTab();
-    void updateCpuTabs();
-    void updateRamTabs();
-    void updateNetworkTabs();
+    void updateCpuView();
+    void toggleCoreLatencyTest();
+    void updateLatencyMatrix();
+    void updateRamView();
+    void updateNetworkView();
+    void showAlert(const Devices::AlertEngine::Event& event);
     void updateAboutTab();
+    void updateCharts();
+    void updateStatisticsTab();
+    void updateDiagnosticsTab();
+    void toggleStressTest();
+    void sampleStressTest();
+    void updateStressTab();
+    void toggleMemoryBenchmark();
+    void updateMemoryBenchmarkTab();
+    void updateMemoryNodes();
+    void toggleWakeupProbe();
+    void updateWakeupTab();
+    void toggleStorageBenchmark();
+    void updateStorageTab();
+    void updateFleetTab();
 };
 
 #endif // MAINWINDOW_H